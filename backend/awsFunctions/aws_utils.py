@@ -75,6 +75,19 @@ def patch_status(fastapi_url: str, token: str, job_id: str, status: str):
     resp.raise_for_status()
     print(f"Updated job {job_id} status to: {status}")
 
+def post_results(fastapi_url: str, token: str, job_id: str, results: dict):
+    """
+    POST final result keys to FastAPI /jobs/{job_id}/results endpoint.
+    """
+    if fastapi_url == "http://dummy" or fastapi_url == "dummy":
+        print(f"[TEST MODE] Would store results for job {job_id}: {results}")
+        return
+
+    headers = {'Authorization': f'Bearer {token}'}
+    resp = requests.post(f"{fastapi_url}/jobs/{job_id}/results", json=results, headers=headers)
+    resp.raise_for_status()
+    print(f"Stored results for job {job_id}")
+
 def get_job_workspace(job_id: str) -> str:
     """
     Get the standard workspace directory for a job.
@@ -146,6 +159,9 @@ class JobPaths:
         self.masks = os.path.join(self.workspace, "masks")
         self.rgba = os.path.join(self.workspace, "rgba")
         self.colmap = os.path.join(self.workspace, "colmap")
+        self.colmap_masks = os.path.join(self.workspace, "colmap_masks")
+        self.undistorted = os.path.join(self.colmap, "undistorted")
+        self.dense_init = os.path.join(self.colmap, "dense_init.json")
         
         # Common files
         self.video = os.path.join(self.images, f"{job_id}_video.mp4")
@@ -1,12 +1,21 @@
 """
 cleanup_job.py
-if 3D model uploaded to S3, delete entire job directory.
+if 3D model uploaded to S3, render the turntable preview video and the point
+cloud preview, export a mesh when asked, report the result keys and delete
+entire job directory.
 """
 import argparse
 import os
 import shutil
 import subprocess
-from aws_utils import JobPaths
+from aws_utils import JobPaths, s3_upload_file, post_results
+from run_brush import brush_masks, brush_sources, latest_export
+
+try:
+    import torque_cpp
+    CPP_AVAILABLE = True
+except ImportError:
+    CPP_AVAILABLE = False
 
 
 def check_s3_model_exists(bucket: str, job_id: str) -> bool:
@@ -22,7 +31,105 @@ def check_s3_model_exists(bucket: str, job_id: str) -> bool:
         return False
 
 
-def cleanup_completed_job(job_id: str, bucket: str) -> bool:
+def render_preview_video(paths: JobPaths, ply_path: str, bucket: str, job_id: str):
+    """
+    Render a turntable of the final splat and upload it next to the thumbnail.
+    Returns the S3 key for the preview_video result, or None if skipped/failed.
+    """
+    if not CPP_AVAILABLE:
+        return None
+    _, sparse_source = brush_sources(paths)
+    video_path = os.path.join(paths.workspace, "preview.mp4")
+    video_key = f"jobs/{job_id}/results/preview.mp4"
+    try:
+        torque_cpp.render_splat_turntable(ply_path, video_path,
+                                          sparse_dir=sparse_source if os.path.isdir(sparse_source) else "")
+        s3_upload_file(video_path, f"s3://{bucket}/{video_key}")
+        return video_key
+    except Exception as e:
+        print(f"WARNING: Preview video failed, the job will have no turntable: {e}")
+        return None
+
+
+def make_point_cloud(paths: JobPaths, ply_path: str, bucket: str, job_id: str):
+    """
+    Downsample the final splat into a small coloured point cloud for the preview.
+    Returns the S3 key for the point_cloud result, or None if skipped/failed.
+    """
+    if not CPP_AVAILABLE:
+        return None
+    cloud_path = os.path.join(paths.workspace, "point_cloud.ply")
+    cloud_key = f"jobs/{job_id}/results/point_cloud.ply"
+    try:
+        torque_cpp.make_point_cloud_preview(ply_path, cloud_path)
+        s3_upload_file(cloud_path, f"s3://{bucket}/{cloud_key}")
+        return cloud_key
+    except Exception as e:
+        print(f"WARNING: Point cloud preview failed, the job will have no point cloud: {e}")
+        return None
+
+
+def export_mesh(paths: JobPaths, ply_path: str, bucket: str, job_id: str, mesh_format: str):
+    """
+    Mesh the final splat (marching cubes inside the mask hull, decimated,
+    vertex coloured) and upload it as mesh.glb / mesh.obj.
+    Returns the S3 key for the mesh result, or None if skipped/failed.
+    """
+    if not CPP_AVAILABLE or not mesh_format:
+        return None
+    _, sparse_source = brush_sources(paths)
+    has_model = os.path.isdir(sparse_source)
+    mesh_path = os.path.join(paths.workspace, f"mesh.{mesh_format}")
+    mesh_key = f"jobs/{job_id}/results/mesh.{mesh_format}"
+    try:
+        torque_cpp.export_splat_mesh(ply_path, mesh_path,
+                                     sparse_dir=sparse_source if has_model else "",
+                                     mask_dir=brush_masks(paths) if has_model else "")
+        s3_upload_file(mesh_path, f"s3://{bucket}/{mesh_key}")
+        return mesh_key
+    except Exception as e:
+        print(f"WARNING: Mesh export failed, the job will have no mesh: {e}")
+        return None
+
+
+def size_mb(path: str) -> float:
+    return round(os.path.getsize(path) / (1024 * 1024), 2)
+
+
+def report_results(paths: JobPaths, bucket: str, job_id: str, fastapi_url: str, fastapi_token: str,
+                   mesh_format: str = None):
+    """Render the previews (and the mesh) from the local model and store the result keys with FastAPI."""
+    ply_path = latest_export(os.path.join(paths.workspace, "gaussian_splat"))
+    if not ply_path:
+        return
+    # the preview shows what the web viewer gets: the cleaned export when floater removal ran
+    clean_path = os.path.splitext(ply_path)[0] + ".clean.ply"
+    preview_source = clean_path if os.path.exists(clean_path) else ply_path
+
+    results = {"splat_file": f"{job_id}/gaussian_splat/{os.path.basename(ply_path)}"}
+    file_sizes = {"splat_file_mb": size_mb(ply_path)}
+    video_key = render_preview_video(paths, preview_source, bucket, job_id)
+    if video_key:
+        results["preview_video"] = video_key
+        file_sizes["preview_video_mb"] = size_mb(os.path.join(paths.workspace, "preview.mp4"))
+    cloud_key = make_point_cloud(paths, preview_source, bucket, job_id)
+    if cloud_key:
+        results["point_cloud"] = cloud_key
+        file_sizes["point_cloud_mb"] = size_mb(os.path.join(paths.workspace, "point_cloud.ply"))
+    mesh_key = export_mesh(paths, preview_source, bucket, job_id, mesh_format)
+    if mesh_key:
+        results["mesh"] = mesh_key
+        file_sizes["mesh_mb"] = size_mb(os.path.join(paths.workspace, f"mesh.{mesh_format}"))
+    results["file_sizes"] = file_sizes
+    if fastapi_url:
+        try:
+            post_results(fastapi_url, fastapi_token, job_id, results)
+        except Exception as e:
+            print(f"WARNING: Could not store results for {job_id}: {e}")
+
+
+def cleanup_completed_job(job_id: str, bucket: str, fastapi_url: str = None, fastapi_token: str = None,
+                          mesh_format: str = None) -> bool:
     """Remove job directory if model uploaded to S3."""
     paths = JobPaths(job_id)
     
@@ -31,6 +138,8 @@ def cleanup_completed_job(job_id: str, bucket: str) -> bool:
         return False
     
     if check_s3_model_exists(bucket, job_id):
+        # last chance to read the local model before the workspace goes
+        report_results(paths, bucket, job_id, fastapi_url, fastapi_token, mesh_format)
         try:
             shutil.rmtree(paths.workspace)
             print(f"Cleaned up job {job_id} (model safe in S3)")
@@ -48,11 +157,14 @@ def main():
     parser.add_argument("--job_id", help="Specific job to clean")
     parser.add_argument("--bucket", required=True, help="S3 bucket name")
     parser.add_argument("--all", action="store_true", help="Clean all completed jobs")
+    parser.add_argument("--fastapi_url", help="FastAPI URL (stores the result keys when given)")
+    parser.add_argument("--fastapi_token", help="FastAPI auth token")
+    parser.add_argument("--mesh_format", choices=["glb", "obj"], help="Also export a mesh of the splat in this format")
     
     args = parser.parse_args()
     
     if args.job_id:
-        cleanup_completed_job(args.job_id, args.bucket)
+        cleanup_completed_job(args.job_id, args.bucket, args.fastapi_url, args.fastapi_token, args.mesh_format)
     elif args.all:
         jobs_dir = os.path.expanduser("~/torque/jobs")
         if os.path.exists(jobs_dir):
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * binary mask packed 64 pixels per word: 1/8 the memory of a u8 mask, so a
+ * whole sequence of masks fits in cache-friendly memory while carving
+ */
+struct BitMask {
+    int width = 0;
+    int height = 0;
+    int words_per_row = 0;
+    std::vector<uint64_t> bits;
+
+    bool empty() const { return bits.empty(); }
+
+    // out of bounds reads as background
+    bool test(int x, int y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return false;
+        }
+        return (bits[static_cast<size_t>(y) * words_per_row + (x >> 6)] >> (x & 63)) & 1u;
+    }
+
+    /**
+     * 8x8 any-pooling: a coarse pixel is set if any of its 64 fine pixels is.
+     * lets a whole projected region be rejected with a handful of word reads
+     */
+    BitMask any_pool8() const {
+        BitMask out;
+        out.width = (width + 7) / 8;
+        out.height = (height + 7) / 8;
+        out.words_per_row = (out.width + 63) / 64;
+        out.bits.assign(static_cast<size_t>(out.words_per_row) * out.height, 0);
+
+        for (int y = 0; y < height; ++y) {
+            const uint64_t* row = bits.data() + static_cast<size_t>(y) * words_per_row;
+            uint64_t* coarse = out.bits.data() + static_cast<size_t>(y / 8) * out.words_per_row;
+            for (int cx = 0; cx < out.width; ++cx) {
+                // 8 divides 64, so a coarse pixel's 8 fine bits never straddle words
+                const uint64_t group = (row[cx >> 3] >> ((cx & 7) * 8)) & 0xFFu;
+                coarse[cx >> 6] |= static_cast<uint64_t>(group != 0) << (cx & 63);
+            }
+        }
+        return out;
+    }
+
+    /**
+     * any set pixel in the inclusive rect [x0, x1] x [y0, y1] (clipped to the mask)
+     */
+    bool any_in_rect(int x0, int y0, int x1, int y1) const {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, width - 1);
+        y1 = std::min(y1, height - 1);
+        if (x0 > x1 || y0 > y1) {
+            return false;
+        }
+        const int w0 = x0 >> 6, w1 = x1 >> 6;
+        const uint64_t first = ~0ull << (x0 & 63);
+        const uint64_t last = ~0ull >> (63 - (x1 & 63));
+        for (int y = y0; y <= y1; ++y) {
+            const uint64_t* row = bits.data() + static_cast<size_t>(y) * words_per_row;
+            for (int w = w0; w <= w1; ++w) {
+                uint64_t word = row[w];
+                if (w == w0) {
+                    word &= first;
+                }
+                if (w == w1) {
+                    word &= last;
+                }
+                if (word) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * nonzero pixels of a CV_8UC1 mask are set
+     */
+    static BitMask from_mat(const cv::Mat& mask) {
+        if (mask.type() != CV_8UC1) {
+            throw std::invalid_argument("BitMask needs a single-channel 8-bit mask");
+        }
+        BitMask out;
+        out.width = mask.cols;
+        out.height = mask.rows;
+        out.words_per_row = (mask.cols + 63) / 64;
+        out.bits.assign(static_cast<size_t>(out.words_per_row) * mask.rows, 0);
+
+        for (int y = 0; y < mask.rows; ++y) {
+            const uint8_t* __restrict__ m = mask.ptr<uint8_t>(y);
+            uint64_t* __restrict__ row = out.bits.data() + static_cast<size_t>(y) * out.words_per_row;
+            for (int w = 0; w < out.words_per_row; ++w) {
+                const int x0 = w * 64;
+                const int n = std::min(64, mask.cols - x0);
+                uint64_t word = 0;
+                for (int b = 0; b < n; ++b) {
+                    word |= static_cast<uint64_t>(m[x0 + b] != 0) << b;
+                }
+                row[w] = word;
+            }
+        }
+        return out;
+    }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * xxh64 (bit-exact with xxhash's XXH64()): several GB/s per core, for
+ * content keys where speed matters and collisions don't have to be
+ * adversarially hard
+ */
+uint64_t xxh64(const void* data, size_t length, uint64_t seed = 0);
+
+/**
+ * crc32c (castagnoli, as s3's ChecksumCRC32C): the sse4.2 crc32
+ * instruction when built for it, slicing-by-8 tables otherwise. pass the
+ * previous result as crc to continue over more data
+ */
+uint32_t crc32c(const void* data, size_t length, uint32_t crc = 0);
+
+// whether crc32c() runs on the sse4.2 instruction
+bool crc32c_hardware();
+
+// sha-256 digest (fips 180-4), portable c++
+void sha256(const void* data, size_t length, uint8_t digest[32]);
+
+// standard base64 with padding, the encoding s3 takes its checksums in
+std::string base64_encode(const uint8_t* data, size_t length);
+
+// crc as s3 expects it: base64 of the 4 big-endian bytes
+std::string crc32c_base64(uint32_t crc);
@@ -0,0 +1,242 @@
+#include "colmap_features.h"
+
+#include <opencv2/features2d.hpp>
+#include <sqlite3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+// colmap camera model ids (colmap/sensor/models.h)
+static constexpr int COLMAP_SIMPLE_RADIAL = 2;
+
+// colmap's image_id check constraint and pair_id encoding both rely on this bound
+static constexpr int64_t COLMAP_MAX_IMAGE_ID = 2147483647;
+
+void extract_sift_features(const cv::Mat& gray, const cv::Mat& mask, int max_features, FrameFeatures& out) {
+    // one detector per thread, opencv's Feature2D objects aren't re-entrant
+    thread_local cv::Ptr<cv::SIFT> sift;
+    thread_local int sift_max_features = -1;
+    if (!sift || sift_max_features != max_features) {
+        sift = cv::SIFT::create(max_features);
+        sift_max_features = max_features;
+    }
+
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat descriptors;
+    sift->detectAndCompute(gray, mask, keypoints, descriptors);
+
+    const int n = static_cast<int>(keypoints.size());
+    out.width = gray.cols;
+    out.height = gray.rows;
+    out.keypoints.resize(static_cast<size_t>(n) * 4);
+    out.descriptors.resize(static_cast<size_t>(n) * 128);
+
+    for (int k = 0; k < n; ++k) {
+        const cv::KeyPoint& kp = keypoints[k];
+        float* dst = out.keypoints.data() + static_cast<size_t>(k) * 4;
+        // colmap puts pixel centres at +0.5, opencv at integers
+        dst[0] = kp.pt.x + 0.5f;
+        dst[1] = kp.pt.y + 0.5f;
+        // opencv size is the blob diameter, colmap scale is the sigma
+        dst[2] = kp.size * 0.5f;
+        dst[3] = kp.angle * static_cast<float>(M_PI / 180.0);
+
+        // L1-root normalisation then colmap's 512x uint8 quantisation
+        const float* __restrict__ d = descriptors.ptr<float>(k);
+        float l1 = 0.0f;
+        #pragma omp simd reduction(+:l1)
+        for (int j = 0; j < 128; ++j) {
+            l1 += std::fabs(d[j]);
+        }
+        const float inv_l1 = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+
+        uint8_t* __restrict__ q = out.descriptors.data() + static_cast<size_t>(k) * 128;
+        #pragma omp simd
+        for (int j = 0; j < 128; ++j) {
+            const float v = 512.0f * std::sqrt(std::fabs(d[j]) * inv_l1);
+            q[j] = static_cast<uint8_t>(std::min(255.0f, std::round(v)));
+        }
+    }
+    out.valid = true;
+}
+
+ColmapDatabase::ColmapDatabase(const std::string& path) {
+    if (sqlite3_open_v2(path.c_str(), &db_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        std::string msg = db_ ? sqlite3_errmsg(db_) : "out of memory";
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw std::runtime_error("Could not open COLMAP database " + path + ": " + msg);
+    }
+
+    // bulk load: nothing reads the file until we close it
+    exec("PRAGMA synchronous = OFF");
+    exec("PRAGMA journal_mode = MEMORY");
+
+    // images keeps the pre-3.9 prior columns so every colmap version can read it
+    exec("CREATE TABLE IF NOT EXISTS cameras ("
+         "camera_id INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL, "
+         "model INTEGER NOT NULL, width INTEGER NOT NULL, height INTEGER NOT NULL, "
+         "params BLOB, prior_focal_length INTEGER NOT NULL)");
+    exec("CREATE TABLE IF NOT EXISTS images ("
+         "image_id INTEGER PRIMARY KEY AUTOINCREMENT NOT NULL, "
+         "name TEXT NOT NULL UNIQUE, camera_id INTEGER NOT NULL, "
+         "prior_qw REAL, prior_qx REAL, prior_qy REAL, prior_qz REAL, "
+         "prior_tx REAL, prior_ty REAL, prior_tz REAL, "
+         "CONSTRAINT image_id_check CHECK(image_id >= 0 and image_id < 2147483647), "
+         "FOREIGN KEY(camera_id) REFERENCES cameras(camera_id))");
+    exec("CREATE UNIQUE INDEX IF NOT EXISTS index_name ON images(name)");
+    exec("CREATE TABLE IF NOT EXISTS keypoints ("
+         "image_id INTEGER PRIMARY KEY NOT NULL, rows INTEGER NOT NULL, cols INTEGER NOT NULL, data BLOB, "
+         "FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE)");
+    exec("CREATE TABLE IF NOT EXISTS descriptors ("
+         "image_id INTEGER PRIMARY KEY NOT NULL, rows INTEGER NOT NULL, cols INTEGER NOT NULL, data BLOB, "
+         "FOREIGN KEY(image_id) REFERENCES images(image_id) ON DELETE CASCADE)");
+}
+
+ColmapDatabase::~ColmapDatabase() {
+    if (db_) {
+        sqlite3_close(db_);
+    }
+}
+
+void ColmapDatabase::exec(const char* sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+        std::string msg = err ? err : "unknown error";
+        sqlite3_free(err);
+        throw std::runtime_error("COLMAP database error: " + msg);
+    }
+}
+
+void ColmapDatabase::begin() {
+    exec("BEGIN TRANSACTION");
+}
+
+void ColmapDatabase::commit() {
+    exec("COMMIT");
+}
+
+namespace {
+
+/**
+ * prepared statement that finalizes itself, so a throw mid-insert doesn't leak
+ */
+class Statement {
+public:
+    Statement(sqlite3* db, const char* sql) : db_(db) {
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt_, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("COLMAP database prepare failed: ") + sqlite3_errmsg(db));
+        }
+    }
+    ~Statement() { sqlite3_finalize(stmt_); }
+
+    sqlite3_stmt* get() { return stmt_; }
+
+    void step() {
+        if (sqlite3_step(stmt_) != SQLITE_DONE) {
+            throw std::runtime_error(std::string("COLMAP database insert failed: ") + sqlite3_errmsg(db_));
+        }
+    }
+
+private:
+    sqlite3* db_;
+    sqlite3_stmt* stmt_ = nullptr;
+};
+
+}  // namespace
+
+int64_t ColmapDatabase::add_camera(int width, int height) {
+    // SIMPLE_RADIAL: f, cx, cy, k
+    const double params[4] = {
+        1.2 * std::max(width, height),
+        width / 2.0,
+        height / 2.0,
+        0.0,
+    };
+
+    Statement stmt(db_, "INSERT INTO cameras(model, width, height, params, prior_focal_length) VALUES(?, ?, ?, ?, 0)");
+    sqlite3_bind_int(stmt.get(), 1, COLMAP_SIMPLE_RADIAL);
+    sqlite3_bind_int(stmt.get(), 2, width);
+    sqlite3_bind_int(stmt.get(), 3, height);
+    sqlite3_bind_blob(stmt.get(), 4, params, sizeof(params), SQLITE_STATIC);
+    stmt.step();
+    return sqlite3_last_insert_rowid(db_);
+}
+
+int64_t ColmapDatabase::add_image(const std::string& name, int64_t camera_id) {
+    Statement stmt(db_, "INSERT INTO images(name, camera_id) VALUES(?, ?)");
+    sqlite3_bind_text(stmt.get(), 1, name.c_str(), static_cast<int>(name.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt.get(), 2, camera_id);
+    stmt.step();
+
+    const int64_t image_id = sqlite3_last_insert_rowid(db_);
+    if (image_id >= COLMAP_MAX_IMAGE_ID) {
+        throw std::runtime_error("COLMAP image id out of range");
+    }
+    return image_id;
+}
+
+void ColmapDatabase::write_features(int64_t image_id, const FrameFeatures& features) {
+    const int n = features.num_features();
+
+    Statement kp(db_, "INSERT INTO keypoints(image_id, rows, cols, data) VALUES(?, ?, 4, ?)");
+    sqlite3_bind_int64(kp.get(), 1, image_id);
+    sqlite3_bind_int(kp.get(), 2, n);
+    sqlite3_bind_blob(kp.get(), 3, features.keypoints.data(),
+                      static_cast<int>(features.keypoints.size() * sizeof(float)), SQLITE_STATIC);
+    kp.step();
+
+    Statement desc(db_, "INSERT INTO descriptors(image_id, rows, cols, data) VALUES(?, ?, 128, ?)");
+    sqlite3_bind_int64(desc.get(), 1, image_id);
+    sqlite3_bind_int(desc.get(), 2, n);
+    sqlite3_bind_blob(desc.get(), 3, features.descriptors.data(),
+                      static_cast<int>(features.descriptors.size()), SQLITE_STATIC);
+    desc.step();
+}
+
+int write_features_database(
+    const std::string& db_path,
+    const std::vector<FrameFeatures>& frames,
+    bool single_camera,
+    int batch_size
+) {
+    // always start from a fresh file, stale matches would point at old keypoints
+    std::remove(db_path.c_str());
+    ColmapDatabase db(db_path);
+
+    std::map<std::pair<int, int>, int64_t> cameras_by_size;
+    int written = 0;
+    int in_batch = 0;
+
+    db.begin();
+    for (const auto& frame : frames) {
+        if (!frame.valid) {
+            continue;
+        }
+
+        int64_t camera_id;
+        const auto size = std::make_pair(frame.width, frame.height);
+        auto it = cameras_by_size.find(size);
+        if (single_camera && it != cameras_by_size.end()) {
+            camera_id = it->second;
+        } else {
+            camera_id = db.add_camera(frame.width, frame.height);
+            cameras_by_size[size] = camera_id;
+        }
+
+        const int64_t image_id = db.add_image(frame.name, camera_id);
+        db.write_features(image_id, frame);
+        ++written;
+
+        if (++in_batch == batch_size) {
+            db.commit();
+            db.begin();
+            in_batch = 0;
+        }
+    }
+    db.commit();
+    return written;
+}
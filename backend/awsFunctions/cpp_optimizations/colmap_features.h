@@ -0,0 +1,69 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+/**
+ * keypoints + descriptors for one frame, already in colmap's layout
+ * keypoints: n x 4 float32 (x, y, scale, orientation), pixel centres at +0.5
+ * descriptors: n x 128 uint8, L1-root normalised like colmap's sift
+ */
+struct FrameFeatures {
+    std::string name;  // image name relative to colmap's --image_path
+    int width = 0;
+    int height = 0;
+    std::vector<float> keypoints;
+    std::vector<uint8_t> descriptors;
+    bool valid = false;
+
+    int num_features() const { return static_cast<int>(keypoints.size() / 4); }
+};
+
+/**
+ * masked opencv sift on an 8-bit gray frame, converted to colmap conventions
+ * safe to call from many threads (one detector per thread)
+ */
+void extract_sift_features(const cv::Mat& gray, const cv::Mat& mask, int max_features, FrameFeatures& out);
+
+/**
+ * thin sqlite wrapper that speaks colmap's database.db schema
+ * only creates the tables we fill (cameras, images, keypoints, descriptors);
+ * colmap adds matches / two_view_geometries itself on open
+ */
+class ColmapDatabase {
+public:
+    explicit ColmapDatabase(const std::string& path);
+    ~ColmapDatabase();
+
+    ColmapDatabase(const ColmapDatabase&) = delete;
+    ColmapDatabase& operator=(const ColmapDatabase&) = delete;
+
+    void begin();
+    void commit();
+
+    // SIMPLE_RADIAL with colmap's default focal prior (1.2 * max(w, h))
+    int64_t add_camera(int width, int height);
+    int64_t add_image(const std::string& name, int64_t camera_id);
+    void write_features(int64_t image_id, const FrameFeatures& features);
+
+private:
+    void exec(const char* sql);
+
+    sqlite3* db_ = nullptr;
+};
+
+/**
+ * write all valid frames into a fresh database.db in batched transactions
+ * single_camera shares one camera per distinct frame size
+ * returns the number of images written
+ */
+int write_features_database(
+    const std::string& db_path,
+    const std::vector<FrameFeatures>& frames,
+    bool single_camera,
+    int batch_size = 64
+);
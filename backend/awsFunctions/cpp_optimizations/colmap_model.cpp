@@ -0,0 +1,699 @@
+#include "colmap_model.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+void BinaryCursor::require(size_t n) const {
+    if (n > size_ - offset_) {
+        throw std::runtime_error("Truncated COLMAP model file: " + path_);
+    }
+}
+
+template <typename T>
+T BinaryCursor::read() {
+    require(sizeof(T));
+    T value;
+    std::memcpy(&value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+}
+
+template uint8_t BinaryCursor::read<uint8_t>();
+template uint32_t BinaryCursor::read<uint32_t>();
+template int32_t BinaryCursor::read<int32_t>();
+template uint64_t BinaryCursor::read<uint64_t>();
+template double BinaryCursor::read<double>();
+
+void BinaryCursor::read_bytes(void* out, size_t n) {
+    require(n);
+    std::memcpy(out, data_ + offset_, n);
+    offset_ += n;
+}
+
+std::string BinaryCursor::read_cstring() {
+    const void* end = std::memchr(data_ + offset_, '\0', size_ - offset_);
+    if (!end) {
+        throw std::runtime_error("Truncated COLMAP model file: " + path_);
+    }
+    const size_t len = static_cast<const uint8_t*>(end) - (data_ + offset_);
+    std::string s(reinterpret_cast<const char*>(data_ + offset_), len);
+    offset_ += len + 1;
+    return s;
+}
+
+void BinaryCursor::skip(size_t n) {
+    require(n);
+    offset_ += n;
+}
+
+int camera_model_num_params(int model_id) {
+    switch (model_id) {
+        case COLMAP_MODEL_SIMPLE_PINHOLE: return 3;
+        case COLMAP_MODEL_PINHOLE: return 4;
+        case COLMAP_MODEL_SIMPLE_RADIAL: return 4;
+        case COLMAP_MODEL_RADIAL: return 5;
+        case COLMAP_MODEL_OPENCV: return 8;
+        case COLMAP_MODEL_OPENCV_FISHEYE: return 8;
+        case COLMAP_MODEL_FULL_OPENCV: return 12;
+    }
+    throw std::invalid_argument("Unsupported COLMAP camera model id: " + std::to_string(model_id));
+}
+
+const char* camera_model_name(int model_id) {
+    switch (model_id) {
+        case COLMAP_MODEL_SIMPLE_PINHOLE: return "SIMPLE_PINHOLE";
+        case COLMAP_MODEL_PINHOLE: return "PINHOLE";
+        case COLMAP_MODEL_SIMPLE_RADIAL: return "SIMPLE_RADIAL";
+        case COLMAP_MODEL_RADIAL: return "RADIAL";
+        case COLMAP_MODEL_OPENCV: return "OPENCV";
+        case COLMAP_MODEL_OPENCV_FISHEYE: return "OPENCV_FISHEYE";
+        case COLMAP_MODEL_FULL_OPENCV: return "FULL_OPENCV";
+    }
+    return "UNKNOWN";
+}
+
+template <typename T>
+static void write_value(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static std::ofstream open_for_write(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not write COLMAP model file: " + path);
+    }
+    return out;
+}
+
+// close and check: a failed final flush (disk full) must not pass as a written model
+static void close_written(std::ofstream& out, const std::string& path) {
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed writing COLMAP model file: " + path);
+    }
+}
+
+void read_cameras_bin(const std::string& path, ColmapModel& model) {
+    MappedFile file(path);
+    BinaryCursor cursor(file.data(), file.size(), path);
+
+    const uint64_t num_cameras = cursor.read<uint64_t>();
+    model.cameras.assign(num_cameras, ColmapCamera());
+    for (auto& camera : model.cameras) {
+        camera.camera_id = cursor.read<uint32_t>();
+        camera.model_id = cursor.read<int32_t>();
+        camera.width = cursor.read<uint64_t>();
+        camera.height = cursor.read<uint64_t>();
+        cursor.read_bytes(camera.params, camera_model_num_params(camera.model_id) * sizeof(double));
+    }
+}
+
+void read_images_bin(const std::string& path, ColmapModel& model) {
+    MappedFile file(path);
+    BinaryCursor cursor(file.data(), file.size(), path);
+
+    const uint64_t num_images = cursor.read<uint64_t>();
+    model.images.assign(num_images, ColmapImage());
+    model.image_names.assign(num_images, std::string());
+    model.points2D_offsets.assign(1, 0);
+    model.points2D_xy.clear();
+    model.points2D_point3D_ids.clear();
+
+    for (uint64_t i = 0; i < num_images; ++i) {
+        ColmapImage& image = model.images[i];
+        image.image_id = cursor.read<uint32_t>();
+        cursor.read_bytes(image.qvec, sizeof(image.qvec));
+        cursor.read_bytes(image.tvec, sizeof(image.tvec));
+        image.camera_id = cursor.read<uint32_t>();
+        model.image_names[i] = cursor.read_cstring();
+
+        // each observation is x, y (f64) + point3D_id (u64), copied straight out of the map
+        image.num_points2D = cursor.read<uint64_t>();
+        const size_t base = model.points2D_point3D_ids.size();
+        model.points2D_xy.resize((base + image.num_points2D) * 2);
+        model.points2D_point3D_ids.resize(base + image.num_points2D);
+        for (uint64_t p = 0; p < image.num_points2D; ++p) {
+            cursor.read_bytes(&model.points2D_xy[(base + p) * 2], 2 * sizeof(double));
+            const int64_t id = static_cast<int64_t>(cursor.read<uint64_t>());
+            model.points2D_point3D_ids[base + p] = id;
+            image.num_points3D += id != COLMAP_INVALID_POINT3D;
+        }
+        model.points2D_offsets.push_back(model.points2D_point3D_ids.size());
+    }
+}
+
+void read_points3D_bin(const std::string& path, ColmapModel& model) {
+    MappedFile file(path);
+    BinaryCursor cursor(file.data(), file.size(), path);
+
+    const uint64_t num_points = cursor.read<uint64_t>();
+    model.points.assign(num_points, ColmapPoint3D());
+    model.track_offsets.assign(1, 0);
+    model.track_image_ids.clear();
+    model.track_point2D_idx.clear();
+    // tracks average a handful of views, reserve to skip most regrowth
+    model.track_image_ids.reserve(num_points * 4);
+    model.track_point2D_idx.reserve(num_points * 4);
+
+    for (auto& point : model.points) {
+        point.point3D_id = static_cast<int64_t>(cursor.read<uint64_t>());
+        cursor.read_bytes(point.xyz, sizeof(point.xyz));
+        cursor.read_bytes(point.rgb, sizeof(point.rgb));
+        point.error = cursor.read<double>();
+        point.track_length = cursor.read<uint64_t>();
+        for (uint64_t t = 0; t < point.track_length; ++t) {
+            model.track_image_ids.push_back(cursor.read<uint32_t>());
+            model.track_point2D_idx.push_back(cursor.read<uint32_t>());
+        }
+        model.track_offsets.push_back(model.track_image_ids.size());
+    }
+}
+
+void write_cameras_bin(const std::string& path, const ColmapModel& model) {
+    std::ofstream out = open_for_write(path);
+    write_value<uint64_t>(out, model.cameras.size());
+    for (const auto& camera : model.cameras) {
+        write_value<uint32_t>(out, camera.camera_id);
+        write_value<int32_t>(out, camera.model_id);
+        write_value<uint64_t>(out, camera.width);
+        write_value<uint64_t>(out, camera.height);
+        out.write(reinterpret_cast<const char*>(camera.params), camera_model_num_params(camera.model_id) * sizeof(double));
+    }
+    close_written(out, path);
+}
+
+void write_images_bin(const std::string& path, const ColmapModel& model) {
+    std::ofstream out = open_for_write(path);
+    write_value<uint64_t>(out, model.images.size());
+    for (size_t i = 0; i < model.images.size(); ++i) {
+        const ColmapImage& image = model.images[i];
+        write_value<uint32_t>(out, image.image_id);
+        out.write(reinterpret_cast<const char*>(image.qvec), sizeof(image.qvec));
+        out.write(reinterpret_cast<const char*>(image.tvec), sizeof(image.tvec));
+        write_value<uint32_t>(out, image.camera_id);
+        out.write(model.image_names[i].c_str(), model.image_names[i].size() + 1);
+
+        const uint64_t begin = model.points2D_offsets[i];
+        const uint64_t end = model.points2D_offsets[i + 1];
+        write_value<uint64_t>(out, end - begin);
+        for (uint64_t p = begin; p < end; ++p) {
+            out.write(reinterpret_cast<const char*>(&model.points2D_xy[p * 2]), 2 * sizeof(double));
+            write_value<uint64_t>(out, static_cast<uint64_t>(model.points2D_point3D_ids[p]));
+        }
+    }
+    close_written(out, path);
+}
+
+void write_points3D_bin(const std::string& path, const ColmapModel& model) {
+    std::ofstream out = open_for_write(path);
+    write_value<uint64_t>(out, model.points.size());
+    for (size_t j = 0; j < model.points.size(); ++j) {
+        const ColmapPoint3D& point = model.points[j];
+        write_value<uint64_t>(out, static_cast<uint64_t>(point.point3D_id));
+        out.write(reinterpret_cast<const char*>(point.xyz), sizeof(point.xyz));
+        out.write(reinterpret_cast<const char*>(point.rgb), sizeof(point.rgb));
+        write_value<double>(out, point.error);
+
+        const uint64_t begin = model.track_offsets[j];
+        const uint64_t end = model.track_offsets[j + 1];
+        write_value<uint64_t>(out, end - begin);
+        for (uint64_t t = begin; t < end; ++t) {
+            write_value<uint32_t>(out, model.track_image_ids[t]);
+            write_value<uint32_t>(out, model.track_point2D_idx[t]);
+        }
+    }
+    close_written(out, path);
+}
+
+ColmapModel ColmapModel::read(const std::string& dir) {
+    ColmapModel model;
+    read_cameras_bin(dir + "/cameras.bin", model);
+    read_images_bin(dir + "/images.bin", model);
+    read_points3D_bin(dir + "/points3D.bin", model);
+    return model;
+}
+
+void ColmapModel::write(const std::string& dir) const {
+    // all three files are written next to dir first and only moved in once
+    // every one is complete, so a failed write leaves the old model intact
+    fs::path target(dir);
+    if (!target.has_filename()) {
+        target = target.parent_path();
+    }
+    const fs::path staging = target.string() + ".writing";
+    fs::remove_all(staging);
+    fs::create_directories(staging);
+    fs::create_directories(target);
+    static const char* const FILES[] = {"cameras.bin", "images.bin", "points3D.bin"};
+    try {
+        write_cameras_bin((staging / FILES[0]).string(), *this);
+        write_images_bin((staging / FILES[1]).string(), *this);
+        write_points3D_bin((staging / FILES[2]).string(), *this);
+        for (const char* name : FILES) {
+            fs::rename(staging / name, target / name);
+        }
+    } catch (...) {
+        std::error_code ignored;
+        fs::remove_all(staging, ignored);
+        throw;
+    }
+    fs::remove_all(staging);
+}
+
+const ColmapCamera* ColmapModel::find_camera(uint32_t camera_id) const {
+    for (const auto& camera : cameras) {
+        if (camera.camera_id == camera_id) {
+            return &camera;
+        }
+    }
+    return nullptr;
+}
+
+void camera_intrinsics(const ColmapCamera& camera, double& fx, double& fy, double& cx, double& cy) {
+    const double* p = camera.params;
+    switch (camera.model_id) {
+        case COLMAP_MODEL_SIMPLE_PINHOLE:
+        case COLMAP_MODEL_SIMPLE_RADIAL:
+        case COLMAP_MODEL_RADIAL:
+            fx = fy = p[0];
+            cx = p[1];
+            cy = p[2];
+            return;
+        case COLMAP_MODEL_PINHOLE:
+        case COLMAP_MODEL_OPENCV:
+        case COLMAP_MODEL_OPENCV_FISHEYE:
+        case COLMAP_MODEL_FULL_OPENCV:
+            fx = p[0];
+            fy = p[1];
+            cx = p[2];
+            cy = p[3];
+            return;
+    }
+    throw std::invalid_argument("Unsupported COLMAP camera model id: " + std::to_string(camera.model_id));
+}
+
+void camera_distortion(const ColmapCamera& camera, double u, double v, double& du, double& dv) {
+    const double* p = camera.params;
+    const double u2 = u * u;
+    const double v2 = v * v;
+    const double uv = u * v;
+    const double r2 = u2 + v2;
+
+    switch (camera.model_id) {
+        case COLMAP_MODEL_SIMPLE_PINHOLE:
+        case COLMAP_MODEL_PINHOLE:
+            du = dv = 0.0;
+            return;
+        case COLMAP_MODEL_SIMPLE_RADIAL: {
+            const double radial = p[3] * r2;
+            du = u * radial;
+            dv = v * radial;
+            return;
+        }
+        case COLMAP_MODEL_RADIAL: {
+            const double radial = p[3] * r2 + p[4] * r2 * r2;
+            du = u * radial;
+            dv = v * radial;
+            return;
+        }
+        case COLMAP_MODEL_OPENCV: {
+            const double k1 = p[4], k2 = p[5], p1 = p[6], p2 = p[7];
+            const double radial = k1 * r2 + k2 * r2 * r2;
+            du = u * radial + 2.0 * p1 * uv + p2 * (r2 + 2.0 * u2);
+            dv = v * radial + 2.0 * p2 * uv + p1 * (r2 + 2.0 * v2);
+            return;
+        }
+        case COLMAP_MODEL_FULL_OPENCV: {
+            const double k1 = p[4], k2 = p[5], p1 = p[6], p2 = p[7];
+            const double k3 = p[8], k4 = p[9], k5 = p[10], k6 = p[11];
+            const double r4 = r2 * r2;
+            const double r6 = r4 * r2;
+            const double radial = (1.0 + k1 * r2 + k2 * r4 + k3 * r6) / (1.0 + k4 * r2 + k5 * r4 + k6 * r6) - 1.0;
+            du = u * radial + 2.0 * p1 * uv + p2 * (r2 + 2.0 * u2);
+            dv = v * radial + 2.0 * p2 * uv + p1 * (r2 + 2.0 * v2);
+            return;
+        }
+        case COLMAP_MODEL_OPENCV_FISHEYE: {
+            const double k1 = p[4], k2 = p[5], k3 = p[6], k4 = p[7];
+            const double r = std::sqrt(r2);
+            if (r > std::numeric_limits<double>::epsilon()) {
+                const double theta = std::atan(r);
+                const double t2 = theta * theta;
+                const double t4 = t2 * t2;
+                const double t6 = t4 * t2;
+                const double t8 = t4 * t4;
+                const double theta_d = theta * (1.0 + k1 * t2 + k2 * t4 + k3 * t6 + k4 * t8);
+                du = u * theta_d / r - u;
+                dv = v * theta_d / r - v;
+            } else {
+                du = dv = 0.0;
+            }
+            return;
+        }
+    }
+    throw std::invalid_argument("Unsupported COLMAP camera model id: " + std::to_string(camera.model_id));
+}
+
+void camera_undistort_normalized(const ColmapCamera& camera, double& u, double& v) {
+    // newton on distorted(x) - target with a central-difference jacobian,
+    // same scheme and limits as colmap's IterativeUndistortion
+    constexpr int MAX_ITERATIONS = 100;
+    constexpr double MAX_STEP_NORM = 1e-10;
+    constexpr double REL_STEP_SIZE = 1e-6;
+
+    const double ud = u;
+    const double vd = v;
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        const double step_u = std::max(std::numeric_limits<double>::epsilon(), std::abs(u * REL_STEP_SIZE));
+        const double step_v = std::max(std::numeric_limits<double>::epsilon(), std::abs(v * REL_STEP_SIZE));
+
+        double du, dv, du_0b, dv_0b, du_0f, dv_0f, du_1b, dv_1b, du_1f, dv_1f;
+        camera_distortion(camera, u, v, du, dv);
+        camera_distortion(camera, u - step_u, v, du_0b, dv_0b);
+        camera_distortion(camera, u + step_u, v, du_0f, dv_0f);
+        camera_distortion(camera, u, v - step_v, du_1b, dv_1b);
+        camera_distortion(camera, u, v + step_v, du_1f, dv_1f);
+
+        // jacobian of x + d(x)
+        const double j00 = 1.0 + (du_0f - du_0b) / (2.0 * step_u);
+        const double j10 = (dv_0f - dv_0b) / (2.0 * step_u);
+        const double j01 = (du_1f - du_1b) / (2.0 * step_v);
+        const double j11 = 1.0 + (dv_1f - dv_1b) / (2.0 * step_v);
+        const double det = j00 * j11 - j01 * j10;
+        if (std::abs(det) < std::numeric_limits<double>::epsilon()) {
+            break;
+        }
+
+        const double ru = u + du - ud;
+        const double rv = v + dv - vd;
+        const double su = (j11 * ru - j01 * rv) / det;
+        const double sv = (j00 * rv - j10 * ru) / det;
+        u -= su;
+        v -= sv;
+        if (su * su + sv * sv < MAX_STEP_NORM) {
+            break;
+        }
+    }
+}
+
+std::pair<size_t, size_t> ColmapModel::filter(const std::vector<uint8_t>& keep_points, const std::vector<uint8_t>& keep_images) {
+    if (!keep_points.empty() && keep_points.size() != points.size()) {
+        throw std::invalid_argument("keep_points must have one entry per point");
+    }
+    if (!keep_images.empty() && keep_images.size() != images.size()) {
+        throw std::invalid_argument("keep_images must have one entry per image");
+    }
+
+    std::unordered_set<uint32_t> kept_image_ids;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (keep_images.empty() || keep_images[i]) {
+            kept_image_ids.insert(images[i].image_id);
+        }
+    }
+
+    // points first: their tracks decide which 2d references survive
+    std::vector<ColmapPoint3D> new_points;
+    std::vector<uint64_t> new_track_offsets(1, 0);
+    std::vector<uint32_t> new_track_image_ids;
+    std::vector<uint32_t> new_track_point2D_idx;
+    std::unordered_set<int64_t> kept_point_ids;
+    new_points.reserve(points.size());
+    new_track_image_ids.reserve(track_image_ids.size());
+    new_track_point2D_idx.reserve(track_point2D_idx.size());
+
+    for (size_t j = 0; j < points.size(); ++j) {
+        if (!keep_points.empty() && !keep_points[j]) {
+            continue;
+        }
+        const size_t track_begin = new_track_image_ids.size();
+        for (uint64_t t = track_offsets[j]; t < track_offsets[j + 1]; ++t) {
+            if (kept_image_ids.count(track_image_ids[t])) {
+                new_track_image_ids.push_back(track_image_ids[t]);
+                new_track_point2D_idx.push_back(track_point2D_idx[t]);
+            }
+        }
+        const size_t track_length = new_track_image_ids.size() - track_begin;
+        if (track_length < 2) {
+            new_track_image_ids.resize(track_begin);
+            new_track_point2D_idx.resize(track_begin);
+            continue;
+        }
+        ColmapPoint3D point = points[j];
+        point.track_length = track_length;
+        new_points.push_back(point);
+        new_track_offsets.push_back(new_track_image_ids.size());
+        kept_point_ids.insert(point.point3D_id);
+    }
+
+    // images are dropped whole, so point2D_idx in the surviving tracks stays valid
+    std::vector<ColmapImage> new_images;
+    std::vector<std::string> new_names;
+    std::vector<uint64_t> new_offsets(1, 0);
+    std::vector<double> new_xy;
+    std::vector<int64_t> new_ids;
+    new_images.reserve(kept_image_ids.size());
+    new_xy.reserve(points2D_xy.size());
+    new_ids.reserve(points2D_point3D_ids.size());
+
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!keep_images.empty() && !keep_images[i]) {
+            continue;
+        }
+        ColmapImage image = images[i];
+        image.num_points3D = 0;
+        for (uint64_t p = points2D_offsets[i]; p < points2D_offsets[i + 1]; ++p) {
+            int64_t id = points2D_point3D_ids[p];
+            if (id != COLMAP_INVALID_POINT3D && !kept_point_ids.count(id)) {
+                id = COLMAP_INVALID_POINT3D;
+            }
+            image.num_points3D += id != COLMAP_INVALID_POINT3D;
+            new_xy.push_back(points2D_xy[p * 2 + 0]);
+            new_xy.push_back(points2D_xy[p * 2 + 1]);
+            new_ids.push_back(id);
+        }
+        new_images.push_back(image);
+        new_names.push_back(std::move(image_names[i]));
+        new_offsets.push_back(new_ids.size());
+    }
+
+    const std::pair<size_t, size_t> removed(points.size() - new_points.size(), images.size() - new_images.size());
+    points = std::move(new_points);
+    track_offsets = std::move(new_track_offsets);
+    track_image_ids = std::move(new_track_image_ids);
+    track_point2D_idx = std::move(new_track_point2D_idx);
+    images = std::move(new_images);
+    image_names = std::move(new_names);
+    points2D_offsets = std::move(new_offsets);
+    points2D_xy = std::move(new_xy);
+    points2D_point3D_ids = std::move(new_ids);
+    return removed;
+}
+
+void image_rotation(const ColmapImage& image, double R[9]) {
+    const double w = image.qvec[0], x = image.qvec[1], y = image.qvec[2], z = image.qvec[3];
+    R[0] = 1.0 - 2.0 * (y * y + z * z);
+    R[1] = 2.0 * (x * y - w * z);
+    R[2] = 2.0 * (x * z + w * y);
+    R[3] = 2.0 * (x * y + w * z);
+    R[4] = 1.0 - 2.0 * (x * x + z * z);
+    R[5] = 2.0 * (y * z - w * x);
+    R[6] = 2.0 * (x * z - w * y);
+    R[7] = 2.0 * (y * z + w * x);
+    R[8] = 1.0 - 2.0 * (x * x + y * y);
+}
+
+void image_center(const ColmapImage& image, double center[3]) {
+    // C = -R^T t
+    double R[9];
+    image_rotation(image, R);
+    for (int k = 0; k < 3; ++k) {
+        center[k] = -(R[k] * image.tvec[0] + R[3 + k] * image.tvec[1] + R[6 + k] * image.tvec[2]);
+    }
+}
+
+bool project_point(const ColmapCamera& camera, const ColmapImage& image, const double xyz[3], double& x, double& y) {
+    double R[9];
+    image_rotation(image, R);
+    const double xc = R[0] * xyz[0] + R[1] * xyz[1] + R[2] * xyz[2] + image.tvec[0];
+    const double yc = R[3] * xyz[0] + R[4] * xyz[1] + R[5] * xyz[2] + image.tvec[1];
+    const double zc = R[6] * xyz[0] + R[7] * xyz[1] + R[8] * xyz[2] + image.tvec[2];
+    if (zc <= std::numeric_limits<double>::epsilon()) {
+        return false;
+    }
+
+    const double u = xc / zc;
+    const double v = yc / zc;
+    double du, dv;
+    camera_distortion(camera, u, v, du, dv);
+    double fx, fy, cx, cy;
+    camera_intrinsics(camera, fx, fy, cx, cy);
+    x = fx * (u + du) + cx;
+    y = fy * (v + dv) + cy;
+    return true;
+}
+
+PYBIND11_NUMPY_DTYPE(ColmapCamera, camera_id, model_id, width, height, params);
+PYBIND11_NUMPY_DTYPE(ColmapImage, image_id, camera_id, qvec, tvec, num_points2D, num_points3D);
+PYBIND11_NUMPY_DTYPE(ColmapPoint3D, point3D_id, xyz, rgb, error, track_length);
+
+/**
+ * numpy view over a model vector, kept alive by the owning python object.
+ * nothing on the python side resizes a model's vectors (filter() returns a
+ * new model), so a view stays valid for as long as it keeps the owner alive
+ */
+template <typename T>
+static py::array vector_view(std::vector<T>& values, py::handle owner) {
+    return py::array_t<T>({static_cast<ssize_t>(values.size())}, {static_cast<ssize_t>(sizeof(T))}, values.data(), owner);
+}
+
+static std::vector<uint8_t> mask_from_object(const py::object& mask) {
+    if (mask.is_none()) {
+        return {};
+    }
+    auto array = py::array_t<bool, py::array::c_style | py::array::forcecast>::ensure(mask);
+    if (!array || array.ndim() != 1) {
+        throw std::invalid_argument("mask must be a 1-d boolean array");
+    }
+    const bool* data = array.data();
+    return std::vector<uint8_t>(data, data + array.shape(0));
+}
+
+/**
+ * quick reconstruction health check: registration ratio, reprojection error
+ * recomputed from the poses (per image too, so bad views can be filtered),
+ * track lengths and observation density
+ */
+static py::dict model_stats(const ColmapModel& model, int num_input_images) {
+    std::unordered_map<int64_t, size_t> point_index;
+    point_index.reserve(model.points.size());
+    for (size_t j = 0; j < model.points.size(); ++j) {
+        point_index[model.points[j].point3D_id] = j;
+    }
+
+    const int num_images = static_cast<int>(model.images.size());
+    py::array_t<double> image_errors(num_images);
+    double* errors = image_errors.mutable_data();
+    std::vector<uint64_t> observations(num_images, 0);
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_images; ++i) {
+        const ColmapImage& image = model.images[i];
+        const ColmapCamera* camera = model.find_camera(image.camera_id);
+        double sum = 0.0;
+        uint64_t count = 0;
+        if (camera) {
+            for (uint64_t p = model.points2D_offsets[i]; p < model.points2D_offsets[i + 1]; ++p) {
+                auto it = point_index.find(model.points2D_point3D_ids[p]);
+                if (it == point_index.end()) {
+                    continue;
+                }
+                double x, y;
+                if (!project_point(*camera, image, model.points[it->second].xyz, x, y)) {
+                    continue;
+                }
+                const double dx = x - model.points2D_xy[p * 2 + 0];
+                const double dy = y - model.points2D_xy[p * 2 + 1];
+                sum += std::sqrt(dx * dx + dy * dy);
+                ++count;
+            }
+        }
+        errors[i] = count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+        observations[i] = count;
+    }
+
+    double error_sum = 0.0;
+    uint64_t total_observations = 0;
+    for (int i = 0; i < num_images; ++i) {
+        if (observations[i] > 0) {
+            error_sum += errors[i] * observations[i];
+            total_observations += observations[i];
+        }
+    }
+
+    py::dict stats;
+    stats["num_cameras"] = model.cameras.size();
+    stats["num_images"] = num_images;
+    stats["num_points"] = model.points.size();
+    stats["num_observations"] = total_observations;
+    stats["registered_ratio"] = num_input_images > 0 ? static_cast<double>(num_images) / num_input_images : 1.0;
+    stats["mean_reprojection_error"] = total_observations > 0 ? error_sum / total_observations : 0.0;
+    stats["mean_track_length"] = model.points.empty() ? 0.0 : static_cast<double>(model.track_image_ids.size()) / model.points.size();
+    stats["mean_observations_per_image"] = num_images > 0 ? static_cast<double>(total_observations) / num_images : 0.0;
+    stats["image_reprojection_errors"] = image_errors;
+    return stats;
+}
+
+void register_colmap_model(py::module_& m) {
+    py::class_<ColmapModel>(m, "ColmapModel",
+        "colmap sparse model; record arrays are zero-copy numpy views")
+        .def(py::init<>())
+        .def_static("read", &ColmapModel::read, "read <dir>/{cameras,images,points3D}.bin", py::arg("dir"))
+        .def("write", &ColmapModel::write, "write <dir>/{cameras,images,points3D}.bin", py::arg("dir"))
+        .def_property_readonly("cameras", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().cameras, self);
+        })
+        .def_property_readonly("images", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().images, self);
+        })
+        .def_property_readonly("points", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().points, self);
+        })
+        .def_property_readonly("image_names", [](const ColmapModel& model) {
+            return model.image_names;
+        })
+        .def_property_readonly("points2D_offsets", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().points2D_offsets, self);
+        })
+        .def_property_readonly("points2D_xy", [](py::object self) {
+            ColmapModel& model = self.cast<ColmapModel&>();
+            const ssize_t count = static_cast<ssize_t>(model.points2D_xy.size() / 2);
+            const ssize_t stride = static_cast<ssize_t>(sizeof(double));
+            return py::array(py::array_t<double>({count, static_cast<ssize_t>(2)}, {2 * stride, stride},
+                                                 model.points2D_xy.data(), self));
+        })
+        .def_property_readonly("points2D_point3D_ids", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().points2D_point3D_ids, self);
+        })
+        .def_property_readonly("track_offsets", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().track_offsets, self);
+        })
+        .def_property_readonly("track_image_ids", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().track_image_ids, self);
+        })
+        .def_property_readonly("track_point2D_idx", [](py::object self) {
+            return vector_view(self.cast<ColmapModel&>().track_point2D_idx, self);
+        })
+        .def("filter", [](const ColmapModel& model, const py::object& keep_points, const py::object& keep_images) {
+            // filtered copy: views into this model keep pointing at live vectors
+            ColmapModel filtered = model;
+            filtered.filter(mask_from_object(keep_points), mask_from_object(keep_images));
+            return filtered;
+        }, "new model without the masked-out points / images, tracks kept consistent; this one is unchanged",
+           py::arg("keep_points") = py::none(), py::arg("keep_images") = py::none())
+        .def("stats", &model_stats, "registration ratio, reprojection error, track length, per-image error",
+             py::arg("num_input_images") = 0);
+
+    m.def("read_colmap_model", &ColmapModel::read,
+          "read a colmap sparse model directory (cameras.bin, images.bin, points3D.bin)",
+          py::arg("dir"));
+}
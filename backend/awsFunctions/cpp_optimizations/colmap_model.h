@@ -0,0 +1,156 @@
+#pragma once
+
+#include "mapped_file.h"
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * colmap sparse model (cameras.bin / images.bin / points3D.bin), same layout
+ * colmap's reader/writer uses (little-endian, see colmap/scene/reconstruction_io.cc)
+ *
+ * records are flat structs in contiguous vectors so python gets them as numpy
+ * structured arrays without a copy; variable-length parts (2d observations,
+ * tracks) are CSR-style: one flat array plus per-record offsets
+ */
+
+// colmap camera model ids (colmap/sensor/models.h)
+enum ColmapCameraModel {
+    COLMAP_MODEL_SIMPLE_PINHOLE = 0,
+    COLMAP_MODEL_PINHOLE = 1,
+    COLMAP_MODEL_SIMPLE_RADIAL = 2,
+    COLMAP_MODEL_RADIAL = 3,
+    COLMAP_MODEL_OPENCV = 4,
+    COLMAP_MODEL_OPENCV_FISHEYE = 5,
+    COLMAP_MODEL_FULL_OPENCV = 6,
+};
+
+// FULL_OPENCV has the most params; unused trailing params stay zero
+static constexpr int COLMAP_MAX_CAMERA_PARAMS = 12;
+
+// images.bin marks 2d points without a 3d point as uint64 max
+static constexpr int64_t COLMAP_INVALID_POINT3D = -1;
+
+struct ColmapCamera {
+    uint32_t camera_id = 0;
+    int32_t model_id = COLMAP_MODEL_PINHOLE;
+    uint64_t width = 0;
+    uint64_t height = 0;
+    double params[COLMAP_MAX_CAMERA_PARAMS] = {};
+};
+
+struct ColmapImage {
+    uint32_t image_id = 0;
+    uint32_t camera_id = 0;
+    double qvec[4] = {1.0, 0.0, 0.0, 0.0};  // world -> camera rotation, w x y z
+    double tvec[3] = {0.0, 0.0, 0.0};
+    uint64_t num_points2D = 0;
+    uint64_t num_points3D = 0;  // observations with a triangulated point
+};
+
+struct ColmapPoint3D {
+    int64_t point3D_id = 0;
+    double xyz[3] = {0.0, 0.0, 0.0};
+    uint8_t rgb[3] = {0, 0, 0};
+    double error = 0.0;
+    uint64_t track_length = 0;
+};
+
+/**
+ * bounds-checked little-endian cursor over a mapped file
+ */
+class BinaryCursor {
+public:
+    BinaryCursor(const uint8_t* data, size_t size, const std::string& path)
+        : data_(data), size_(size), path_(path) {}
+
+    template <typename T>
+    T read();
+    void read_bytes(void* out, size_t n);
+    std::string read_cstring();
+    void skip(size_t n);
+    size_t offset() const { return offset_; }
+
+private:
+    void require(size_t n) const;
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_ = 0;
+    std::string path_;
+};
+
+struct ColmapModel {
+    std::vector<ColmapCamera> cameras;
+
+    std::vector<ColmapImage> images;
+    std::vector<std::string> image_names;
+    // 2d observations of images[i]: [points2D_offsets[i], points2D_offsets[i + 1])
+    std::vector<uint64_t> points2D_offsets;
+    std::vector<double> points2D_xy;         // x, y with pixel centres at +0.5
+    std::vector<int64_t> points2D_point3D_ids;
+
+    std::vector<ColmapPoint3D> points;
+    // track of points[j]: [track_offsets[j], track_offsets[j + 1])
+    std::vector<uint64_t> track_offsets;
+    std::vector<uint32_t> track_image_ids;
+    std::vector<uint32_t> track_point2D_idx;
+
+    // <dir>/cameras.bin, images.bin, points3D.bin
+    static ColmapModel read(const std::string& dir);
+    // staged in <dir>.writing and renamed in once all three files are complete
+    void write(const std::string& dir) const;
+
+    const ColmapCamera* find_camera(uint32_t camera_id) const;
+
+    /**
+     * drop points / images in place (an empty mask keeps everything). tracks
+     * lose observations in dropped images, points left with fewer than two
+     * observations go too, and 2d points referencing a removed point are
+     * reset to COLMAP_INVALID_POINT3D. returns {points removed, images removed}
+     */
+    std::pair<size_t, size_t> filter(const std::vector<uint8_t>& keep_points, const std::vector<uint8_t>& keep_images);
+};
+
+void read_cameras_bin(const std::string& path, ColmapModel& model);
+void read_images_bin(const std::string& path, ColmapModel& model);
+void read_points3D_bin(const std::string& path, ColmapModel& model);
+void write_cameras_bin(const std::string& path, const ColmapModel& model);
+void write_images_bin(const std::string& path, const ColmapModel& model);
+void write_points3D_bin(const std::string& path, const ColmapModel& model);
+
+int camera_model_num_params(int model_id);
+const char* camera_model_name(int model_id);
+
+/**
+ * pinhole part of any supported model (simple models have fx == fy)
+ */
+void camera_intrinsics(const ColmapCamera& camera, double& fx, double& fy, double& cx, double& cy);
+
+/**
+ * lens distortion on normalized image coordinates, colmap's convention:
+ * distorted = (u + du, v + dv)
+ */
+void camera_distortion(const ColmapCamera& camera, double u, double v, double& du, double& dv);
+
+/**
+ * inverse of camera_distortion by newton iteration (as colmap does)
+ */
+void camera_undistort_normalized(const ColmapCamera& camera, double& u, double& v);
+
+/**
+ * world -> camera rotation of an image (row-major) and its centre in world space
+ */
+void image_rotation(const ColmapImage& image, double R[9]);
+void image_center(const ColmapImage& image, double center[3]);
+
+/**
+ * world point -> pixel (colmap convention), false if behind the camera
+ */
+bool project_point(const ColmapCamera& camera, const ColmapImage& image, const double xyz[3], double& x, double& y);
+
+void register_colmap_model(pybind11::module_& m);
@@ -0,0 +1,368 @@
+#include "frame_analysis.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+
+void score_gray_frame(const cv::Mat& gray, FrameScore& out) {
+    const int width = gray.cols;
+    const int height = gray.rows;
+    out = FrameScore();
+    if (width < 3 || height < 3) {
+        return;
+    }
+
+    // int64 accumulators: a 4k frame's sum of squares overflows 32 bits
+    int64_t lap_sum = 0, lap_sq = 0;
+    int64_t luma_sum = 0, clipped = 0;
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* __restrict__ row = gray.ptr<uint8_t>(y);
+
+        // border columns/rows only contribute exposure
+        int64_t row_luma = row[0] + row[width - 1];
+        int64_t row_clipped = (row[0] >= CLIPPED_LUMA) + (row[width - 1] >= CLIPPED_LUMA);
+        if (y == 0 || y == height - 1) {
+            #pragma omp simd reduction(+:row_luma, row_clipped)
+            for (int x = 1; x < width - 1; ++x) {
+                row_luma += row[x];
+                row_clipped += row[x] >= CLIPPED_LUMA;
+            }
+        } else {
+            const uint8_t* __restrict__ up = gray.ptr<uint8_t>(y - 1);
+            const uint8_t* __restrict__ down = gray.ptr<uint8_t>(y + 1);
+            int64_t row_lap = 0, row_lap_sq = 0;
+            #pragma omp simd reduction(+:row_luma, row_clipped, row_lap, row_lap_sq)
+            for (int x = 1; x < width - 1; ++x) {
+                const int c = row[x];
+                const int lap = 4 * c - row[x - 1] - row[x + 1] - up[x] - down[x];
+                row_lap += lap;
+                row_lap_sq += lap * lap;
+                row_luma += c;
+                row_clipped += c >= CLIPPED_LUMA;
+            }
+            lap_sum += row_lap;
+            lap_sq += row_lap_sq;
+        }
+        luma_sum += row_luma;
+        clipped += row_clipped;
+    }
+
+    const double n_lap = static_cast<double>(width - 2) * (height - 2);
+    const double n = static_cast<double>(width) * height;
+    const double lap_mean = lap_sum / n_lap;
+    out.sharpness = static_cast<float>(lap_sq / n_lap - lap_mean * lap_mean);
+    out.clipped_fraction = static_cast<float>(clipped / n);
+    out.mean_luma = static_cast<float>(luma_sum / n);
+    out.valid = true;
+}
+
+std::vector<int> select_frames(
+    const std::vector<FrameScore>& scores,
+    int window,
+    int stride,
+    float max_clipped,
+    float min_luma,
+    float max_luma
+) {
+    const int n = static_cast<int>(scores.size());
+    auto exposed_ok = [&](const FrameScore& s) {
+        return s.clipped_fraction <= max_clipped && s.mean_luma >= min_luma && s.mean_luma <= max_luma;
+    };
+
+    std::vector<bool> keep(n, false);
+    for (int start = 0; start < n; start += stride) {
+        const int end = std::min(n, start + window);
+        int best = -1, best_any = -1;
+        for (int i = start; i < end; ++i) {
+            if (!scores[i].valid) {
+                continue;
+            }
+            if (best_any < 0 || scores[i].sharpness > scores[best_any].sharpness) {
+                best_any = i;
+            }
+            if (exposed_ok(scores[i]) && (best < 0 || scores[i].sharpness > scores[best].sharpness)) {
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            keep[best] = true;
+        } else if (best_any >= 0) {
+            keep[best_any] = true;
+        }
+        if (end == n) {
+            break;
+        }
+    }
+
+    std::vector<int> kept;
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) {
+            kept.push_back(i);
+        }
+    }
+    return kept;
+}
+
+uint64_t difference_hash(const cv::Mat& gray) {
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uint8_t* row = small.ptr<uint8_t>(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | (row[x + 1] > row[x]);
+        }
+    }
+    return hash;
+}
+
+uint64_t perceptual_hash(const cv::Mat& gray) {
+    constexpr int N = 32;
+    constexpr int K = 8;
+
+    // only the 8 lowest dct-ii basis rows are needed, so skip the full 32x32 transform
+    static const std::vector<float> basis = [] {
+        std::vector<float> b(K * N);
+        for (int u = 0; u < K; ++u) {
+            for (int x = 0; x < N; ++x) {
+                b[u * N + x] = static_cast<float>(std::cos(M_PI * (2 * x + 1) * u / (2.0 * N)));
+            }
+        }
+        return b;
+    }();
+
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(N, N), 0, 0, cv::INTER_AREA);
+
+    // rows: tmp[y][u] = sum_x img[y][x] * basis[u][x]
+    float tmp[N][K];
+    for (int y = 0; y < N; ++y) {
+        const uint8_t* row = small.ptr<uint8_t>(y);
+        for (int u = 0; u < K; ++u) {
+            const float* __restrict__ b = &basis[u * N];
+            float acc = 0.0f;
+            #pragma omp simd reduction(+:acc)
+            for (int x = 0; x < N; ++x) {
+                acc += row[x] * b[x];
+            }
+            tmp[y][u] = acc;
+        }
+    }
+
+    // columns: coeff[v][u] = sum_y tmp[y][u] * basis[v][y]
+    float coeff[K * K];
+    for (int v = 0; v < K; ++v) {
+        const float* b = &basis[v * N];
+        for (int u = 0; u < K; ++u) {
+            float acc = 0.0f;
+            for (int y = 0; y < N; ++y) {
+                acc += tmp[y][u] * b[y];
+            }
+            coeff[v * K + u] = acc;
+        }
+    }
+
+    // median over the ac terms, the dc term would skew it
+    float sorted[K * K - 1];
+    std::copy(coeff + 1, coeff + K * K, sorted);
+    std::nth_element(sorted, sorted + (K * K - 1) / 2, sorted + K * K - 1);
+    const float median = sorted[(K * K - 1) / 2];
+
+    uint64_t hash = 0;
+    for (int i = 0; i < K * K; ++i) {
+        hash = (hash << 1) | (coeff[i] > median);
+    }
+    return hash;
+}
+
+std::vector<int> dedup_frames(const std::vector<FrameScore>& scores, int max_distance) {
+    const int n = static_cast<int>(scores.size());
+    std::vector<int> kept;
+
+    int leader = -1;  // first frame of the current cluster
+    int best = -1;    // sharpest frame of the current cluster
+    for (int i = 0; i < n; ++i) {
+        if (!scores[i].valid) {
+            continue;
+        }
+        const bool duplicate = leader >= 0 &&
+            hamming_distance(scores[i].dhash, scores[leader].dhash) <= max_distance &&
+            hamming_distance(scores[i].phash, scores[leader].phash) <= max_distance;
+        if (duplicate) {
+            if (scores[i].sharpness > scores[best].sharpness) {
+                best = i;
+            }
+            continue;
+        }
+        if (best >= 0) {
+            kept.push_back(best);
+        }
+        leader = best = i;
+    }
+    if (best >= 0) {
+        kept.push_back(best);
+    }
+    return kept;
+}
+
+static int reduced_grayscale_flag(int reduce) {
+    switch (reduce) {
+        case 1: return cv::IMREAD_GRAYSCALE;
+        case 2: return cv::IMREAD_REDUCED_GRAYSCALE_2;
+        case 4: return cv::IMREAD_REDUCED_GRAYSCALE_4;
+        case 8: return cv::IMREAD_REDUCED_GRAYSCALE_8;
+    }
+    throw std::invalid_argument("reduce must be one of 1, 2, 4, 8");
+}
+
+/**
+ * score + hash every frame in parallel
+ * reduce > 1 decodes jpegs at 1/2, 1/4 or 1/8 scale straight from the dct
+ * (libjpeg scaled idct), so a 4k frame costs a fraction of a full decode
+ */
+static py::dict score_frames(const std::vector<std::string>& image_paths, int reduce) {
+    const int flag = reduced_grayscale_flag(reduce);
+    const int num_images = static_cast<int>(image_paths.size());
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::vector<FrameScore> scores(num_images);
+    int errors = 0;
+
+    #ifdef _OPENMP
+    const int num_threads = std::min(4, omp_get_max_threads());
+    omp_set_num_threads(num_threads);
+    #endif
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:errors)
+    for (int i = 0; i < num_images; ++i) {
+        cv::Mat gray = cv::imread(image_paths[i], flag);
+        if (gray.empty()) {
+            printf("ERROR: Could not load image: %s\n", image_paths[i].c_str());
+            errors++;
+            continue;
+        }
+        score_gray_frame(gray, scores[i]);
+        scores[i].dhash = difference_hash(gray);
+        scores[i].phash = perceptual_hash(gray);
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::array_t<float> sharpness(num_images), clipped(num_images), luma(num_images);
+    py::array_t<uint64_t> dhash(num_images), phash(num_images);
+    py::array_t<bool> valid(num_images);
+    auto s = sharpness.mutable_unchecked<1>();
+    auto c = clipped.mutable_unchecked<1>();
+    auto l = luma.mutable_unchecked<1>();
+    auto dh = dhash.mutable_unchecked<1>();
+    auto ph = phash.mutable_unchecked<1>();
+    auto v = valid.mutable_unchecked<1>();
+    for (int i = 0; i < num_images; ++i) {
+        s(i) = scores[i].sharpness;
+        c(i) = scores[i].clipped_fraction;
+        l(i) = scores[i].mean_luma;
+        dh(i) = scores[i].dhash;
+        ph(i) = scores[i].phash;
+        v(i) = scores[i].valid;
+    }
+
+    py::dict results;
+    results["sharpness"] = sharpness;
+    results["clipped_fraction"] = clipped;
+    results["mean_luma"] = luma;
+    results["dhash"] = dhash;
+    results["phash"] = phash;
+    results["valid"] = valid;
+    results["errors"] = errors;
+    results["reduce"] = reduce;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("scored %d frames in %.1f ms (1/%d decode)\n", num_images - errors, processing_time_ms, reduce);
+    return results;
+}
+
+/**
+ * back from a score_frames() result (possibly filtered with numpy indexing)
+ */
+static std::vector<FrameScore> scores_from_dict(const py::dict& scores) {
+    using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+    using HashArray = py::array_t<uint64_t, py::array::c_style | py::array::forcecast>;
+    using BoolArray = py::array_t<bool, py::array::c_style | py::array::forcecast>;
+    auto sharpness = scores["sharpness"].cast<FloatArray>();
+    auto clipped = scores["clipped_fraction"].cast<FloatArray>();
+    auto luma = scores["mean_luma"].cast<FloatArray>();
+    auto dhash = scores["dhash"].cast<HashArray>();
+    auto phash = scores["phash"].cast<HashArray>();
+    auto valid = scores["valid"].cast<BoolArray>();
+
+    const ssize_t n = sharpness.size();
+    if (clipped.size() != n || luma.size() != n || dhash.size() != n || phash.size() != n || valid.size() != n) {
+        throw std::invalid_argument("score arrays must all have the same length");
+    }
+
+    std::vector<FrameScore> frame_scores(n);
+    for (ssize_t i = 0; i < n; ++i) {
+        FrameScore& f = frame_scores[i];
+        f.sharpness = sharpness.data()[i];
+        f.clipped_fraction = clipped.data()[i];
+        f.mean_luma = luma.data()[i];
+        f.dhash = dhash.data()[i];
+        f.phash = phash.data()[i];
+        f.valid = valid.data()[i];
+    }
+    return frame_scores;
+}
+
+static std::vector<int> select_frames_py(
+    const py::dict& scores,
+    int window,
+    int stride,
+    float max_clipped,
+    float min_luma,
+    float max_luma
+) {
+    if (window < 1) {
+        throw std::invalid_argument("window must be >= 1");
+    }
+    if (stride <= 0) {
+        stride = window;
+    }
+
+    return select_frames(scores_from_dict(scores), window, stride, max_clipped, min_luma, max_luma);
+}
+
+static std::vector<int> dedup_frames_py(const py::dict& scores, int max_distance) {
+    if (max_distance < 0 || max_distance > 64) {
+        throw std::invalid_argument("max_distance must be in [0, 64]");
+    }
+    return dedup_frames(scores_from_dict(scores), max_distance);
+}
+
+void register_frame_analysis(py::module_& m) {
+    m.def("score_frames", &score_frames,
+          "per-frame laplacian-variance sharpness, clipped-highlight fraction, mean luma and dhash/phash",
+          py::arg("image_paths"), py::arg("reduce") = 2);
+    m.def("select_frames", &select_frames_py,
+          "indices of the sharpest well-exposed frame per window (stride 0 = window)",
+          py::arg("scores"),
+          py::arg("window") = 3, py::arg("stride") = 0, py::arg("max_clipped") = 0.25f,
+          py::arg("min_luma") = 16.0f, py::arg("max_luma") = 240.0f);
+    m.def("dedup_frames", &dedup_frames_py,
+          "indices left after collapsing runs of near-identical frames to their sharpest frame",
+          py::arg("scores"), py::arg("max_distance") = 8);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <pybind11/pybind11.h>
+#include <cstdint>
+#include <vector>
+
+// luma at or above this counts as a clipped highlight
+static constexpr int CLIPPED_LUMA = 250;
+
+/**
+ * per-frame quality measures, all from one pass over the gray frame
+ * sharpness: variance of the 4-neighbour laplacian (scale depends on the
+ * decode size, so only compare frames scored with the same `reduce`)
+ * dhash / phash: 64-bit perceptual hashes from the same decode
+ */
+struct FrameScore {
+    float sharpness = 0.0f;
+    float clipped_fraction = 0.0f;
+    float mean_luma = 0.0f;
+    uint64_t dhash = 0;
+    uint64_t phash = 0;
+    bool valid = false;
+};
+
+/**
+ * fused SIMD pass: laplacian sum / sum of squares, luma sum and clipped count
+ */
+void score_gray_frame(const cv::Mat& gray, FrameScore& out);
+
+/**
+ * dhash: 9x8 area-downscale, one bit per horizontal gradient sign
+ * phash: 32x32 area-downscale, 8x8 low-frequency dct-ii block, one bit per
+ * coefficient above the median
+ */
+uint64_t difference_hash(const cv::Mat& gray);
+uint64_t perceptual_hash(const cv::Mat& gray);
+
+inline int hamming_distance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+/**
+ * near-duplicate runs: each frame joins the current cluster while both its
+ * dhash and phash are within `max_distance` bits of the cluster's first frame,
+ * otherwise it starts a new one. only the sharpest frame of a cluster is kept,
+ * so revisits later in the capture (loop closures) are never merged
+ * returns kept indices in ascending order
+ */
+std::vector<int> dedup_frames(const std::vector<FrameScore>& scores, int max_distance);
+
+/**
+ * keep the sharpest well-exposed frame in each window of `window` frames,
+ * advancing by `stride` (stride < window gives overlapping windows)
+ * a window with no well-exposed frame keeps its sharpest frame anyway so
+ * dark or bright captures are thinned rather than emptied
+ * returns kept indices in ascending order
+ */
+std::vector<int> select_frames(
+    const std::vector<FrameScore>& scores,
+    int window,
+    int stride,
+    float max_clipped,
+    float min_luma,
+    float max_luma
+);
+
+void register_frame_analysis(pybind11::module_& m);
@@ -0,0 +1,129 @@
+#include "frame_cache.h"
+#include "checksum.h"
+#include "mapped_file.h"
+
+#include <sys/stat.h>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// v1 manifests (no checksums) read as empty: one full recompose after the upgrade
+static const char* const MANIFEST_HEADER = "# torque frame manifest v2";
+
+static std::string checksum_field(const std::string& value) {
+    return value.empty() ? "-" : value;
+}
+
+uint64_t file_content_hash(const std::string& path) {
+    const MappedFile file(path);
+    return xxh64(file.data(), file.size());
+}
+
+uint64_t mask_bits_hash(const uint8_t* mask, int width, int height) {
+    const int words_per_row = (width + 63) / 64;
+    thread_local std::vector<uint64_t> bits;
+    bits.assign(static_cast<size_t>(words_per_row) * height, 0);
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* __restrict__ m = mask + static_cast<size_t>(y) * width;
+        uint64_t* __restrict__ row = bits.data() + static_cast<size_t>(y) * words_per_row;
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            uint64_t v;
+            std::memcpy(&v, m + x, sizeof(v));
+            // high bit of each byte set iff the byte is nonzero
+            const uint64_t nonzero = (((v & 0x7F7F7F7F7F7F7F7Full) + 0x7F7F7F7F7F7F7F7Full) | v) & 0x8080808080808080ull;
+            // gather the eight high bits into the top byte, pixel x in its lowest bit
+            const uint64_t packed = ((nonzero >> 7) * 0x0102040810204080ull) >> 56;
+            row[x >> 6] |= packed << (x & 63);
+        }
+        for (; x < width; ++x) {
+            row[x >> 6] |= static_cast<uint64_t>(m[x] != 0) << (x & 63);
+        }
+    }
+    // the seed keeps equal bits of different frame sizes apart
+    return xxh64(bits.data(), bits.size() * sizeof(uint64_t), (static_cast<uint64_t>(width) << 32) | static_cast<uint32_t>(height));
+}
+
+FrameManifest FrameManifest::read(const std::string& path) {
+    FrameManifest manifest;
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != MANIFEST_HEADER) {
+        return manifest;
+    }
+    while (std::getline(in, line)) {
+        FrameCacheEntry entry;
+        char crc[64], digest[64];
+        int consumed = 0;
+        if (std::sscanf(line.c_str(), "%" SCNx64 " %" SCNd64 " %" SCNd64 " %63s %63s %n",
+                        &entry.key, &entry.size, &entry.mtime_ns, crc, digest, &consumed) != 5 ||
+            consumed <= 0 || static_cast<size_t>(consumed) >= line.size()) {
+            continue;
+        }
+        entry.crc32c = std::strcmp(crc, "-") == 0 ? "" : crc;
+        entry.sha256 = std::strcmp(digest, "-") == 0 ? "" : digest;
+        manifest.entries_[line.substr(consumed)] = entry;
+    }
+    return manifest;
+}
+
+bool FrameManifest::matches(const std::string& output_path, uint64_t key) const {
+    const auto it = entries_.find(output_path);
+    if (it == entries_.end() || it->second.key != key) {
+        return false;
+    }
+    const FrameCacheEntry current = stat_output(output_path, key);
+    return current.size >= 0 && current.size == it->second.size && current.mtime_ns == it->second.mtime_ns;
+}
+
+const FrameCacheEntry* FrameManifest::find(const std::string& output_path) const {
+    const auto it = entries_.find(output_path);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+FrameCacheEntry FrameManifest::stat_output(const std::string& output_path, uint64_t key) {
+    FrameCacheEntry entry;
+    entry.key = key;
+    struct stat st;
+    if (::stat(output_path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        entry.size = static_cast<int64_t>(st.st_size);
+        entry.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+    return entry;
+}
+
+void FrameManifest::write(const std::string& path, const std::vector<std::string>& outputs, const std::vector<FrameCacheEntry>& entries) {
+    if (outputs.size() != entries.size()) {
+        throw std::invalid_argument("manifest needs one entry per output");
+    }
+    std::ostringstream text;
+    text << MANIFEST_HEADER << "\n";
+    char prefix[64];
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        if (entries[i].size < 0) {
+            continue;
+        }
+        std::snprintf(prefix, sizeof(prefix), "%016" PRIx64 " %" PRId64 " %" PRId64 " ", entries[i].key, entries[i].size, entries[i].mtime_ns);
+        text << prefix << checksum_field(entries[i].crc32c) << " " << checksum_field(entries[i].sha256) << " " << outputs[i] << "\n";
+    }
+
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Could not open " + tmp_path + " for writing");
+        }
+        out << text.str();
+        if (!out) {
+            throw std::runtime_error("Failed writing " + tmp_path);
+        }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Could not replace " + path + ": " + std::strerror(errno));
+    }
+}
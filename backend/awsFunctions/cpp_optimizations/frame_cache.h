@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// xxh64 of a whole file's bytes (mmap'ed, so an unchanged file is read from the page cache)
+uint64_t file_content_hash(const std::string& path);
+
+/**
+ * xxh64 of a u8 mask packed to one bit per pixel (nonzero = 1, 64 pixels
+ * per word, rows padded to whole words): what the compose kernel actually
+ * reads, at 1/8 of the bytes
+ */
+uint64_t mask_bits_hash(const uint8_t* mask, int width, int height);
+
+struct FrameCacheEntry {
+    uint64_t key = 0;
+    int64_t size = -1;     // output file size, -1: no output
+    int64_t mtime_ns = 0;  // output mtime when recorded
+    std::string crc32c;    // base64 checksums of the output as encoded, empty if not taken
+    std::string sha256;
+};
+
+/**
+ * on-disk manifest of a batch's outputs: output path -> content key of the
+ * inputs it was made from, plus the output's size and mtime as written, so
+ * a file replaced or truncated since then doesn't count as up to date, and
+ * the output's checksums so a reused frame needn't be read back to get them.
+ * text, one frame per line: "<key hex> <size> <mtime ns> <crc32c> <sha256> <output path>",
+ * a checksum not taken is "-"
+ */
+class FrameManifest {
+public:
+    // a missing or unreadable manifest is empty: every frame is recomposed
+    static FrameManifest read(const std::string& path);
+
+    // output_path was made from inputs with this key and is still as written
+    bool matches(const std::string& output_path, uint64_t key) const;
+
+    // the recorded entry for output_path, nullptr if there is none
+    const FrameCacheEntry* find(const std::string& output_path) const;
+
+    // entry for an output on disk, size -1 if it can't be stat'ed
+    static FrameCacheEntry stat_output(const std::string& output_path, uint64_t key);
+
+    /**
+     * entries[i] describes outputs[i]; entries without an output are left
+     * out. written to <path>.tmp and renamed, so a crash never leaves a
+     * half-written manifest
+     */
+    static void write(const std::string& path, const std::vector<std::string>& outputs, const std::vector<FrameCacheEntry>& entries);
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    std::unordered_map<std::string, FrameCacheEntry> entries_;
+};
@@ -0,0 +1,233 @@
+#include "image_retrieval.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+
+// thumbnail carries shape/shading, histogram carries colour; weights^2 sum to 1
+static const float THUMB_WEIGHT = std::sqrt(0.6f);
+static const float HIST_WEIGHT = std::sqrt(0.4f);
+
+static void normalize(float* v, int n, float scale) {
+    float norm = 0.0f;
+    #pragma omp simd reduction(+:norm)
+    for (int i = 0; i < n; ++i) {
+        norm += v[i] * v[i];
+    }
+    const float inv = norm > 0.0f ? scale / std::sqrt(norm) : 0.0f;
+    #pragma omp simd
+    for (int i = 0; i < n; ++i) {
+        v[i] *= inv;
+    }
+}
+
+void compute_global_descriptor(const cv::Mat& bgr, const cv::Mat& mask, float* out) {
+    const int width = bgr.cols;
+    const int height = bgr.rows;
+    constexpr int T = RETRIEVAL_THUMB_SIZE;
+    constexpr int B = RETRIEVAL_HIST_BINS;
+    constexpr int HIST_SHIFT = 8 - 2;  // 256 / 4 bins per channel
+
+    float* thumb = out;
+    float* hist = out + T * T;
+    std::fill(out, out + RETRIEVAL_DESCRIPTOR_DIM, 0.0f);
+
+    // pass 1: mask bbox + colour histogram of the masked pixels
+    int x_min = width, x_max = -1, y_min = height, y_max = -1;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* m = mask.ptr<uint8_t>(y);
+        const uint8_t* p = bgr.ptr<uint8_t>(y);
+        for (int x = 0; x < width; ++x) {
+            if (!m[x]) {
+                continue;
+            }
+            x_min = std::min(x_min, x);
+            x_max = std::max(x_max, x);
+            y_min = std::min(y_min, y);
+            y_max = std::max(y_max, y);
+            const int bin = ((p[x * 3 + 2] >> HIST_SHIFT) * B + (p[x * 3 + 1] >> HIST_SHIFT)) * B + (p[x * 3] >> HIST_SHIFT);
+            hist[bin] += 1.0f;
+        }
+    }
+    const bool empty = x_max < 0;
+    if (empty) {
+        // no mask: describe the whole frame rather than returning zeros
+        x_min = 0, x_max = width - 1, y_min = 0, y_max = height - 1;
+    }
+
+    // pass 2: masked mean luma per thumbnail cell over the bbox
+    const int bw = x_max - x_min + 1;
+    const int bh = y_max - y_min + 1;
+    thread_local std::vector<int> cell_x;
+    cell_x.resize(bw);
+    for (int x = 0; x < bw; ++x) {
+        cell_x[x] = x * T / bw;
+    }
+    float counts[T * T] = {0.0f};
+    for (int y = y_min; y <= y_max; ++y) {
+        const uint8_t* m = mask.ptr<uint8_t>(y);
+        const uint8_t* p = bgr.ptr<uint8_t>(y);
+        const int row_cell = ((y - y_min) * T / bh) * T;
+        for (int x = x_min; x <= x_max; ++x) {
+            if (!empty && !m[x]) {
+                continue;
+            }
+            if (empty) {
+                const int bin = ((p[x * 3 + 2] >> HIST_SHIFT) * B + (p[x * 3 + 1] >> HIST_SHIFT)) * B + (p[x * 3] >> HIST_SHIFT);
+                hist[bin] += 1.0f;
+            }
+            const int cell = row_cell + cell_x[x - x_min];
+            thumb[cell] += (29 * p[x * 3] + 150 * p[x * 3 + 1] + 77 * p[x * 3 + 2]) >> 8;
+            counts[cell] += 1.0f;
+        }
+    }
+
+    // zero-mean thumbnail so global brightness shifts don't dominate
+    float mean = 0.0f;
+    int filled = 0;
+    for (int c = 0; c < T * T; ++c) {
+        if (counts[c] > 0.0f) {
+            thumb[c] /= counts[c];
+            mean += thumb[c];
+            ++filled;
+        }
+    }
+    mean = filled > 0 ? mean / filled : 0.0f;
+    for (int c = 0; c < T * T; ++c) {
+        thumb[c] = counts[c] > 0.0f ? thumb[c] - mean : 0.0f;
+    }
+    normalize(thumb, T * T, THUMB_WEIGHT);
+
+    // hellinger kernel on the histogram
+    for (int b = 0; b < B * B * B; ++b) {
+        hist[b] = std::sqrt(hist[b]);
+    }
+    normalize(hist, B * B * B, HIST_WEIGHT);
+}
+
+std::vector<std::pair<int, int>> knn_image_pairs(
+    const float* descriptors,
+    int num_images,
+    int dim,
+    const std::vector<bool>& valid,
+    int k,
+    int sequential_overlap
+) {
+    std::vector<std::vector<std::pair<int, int>>> per_row(num_images);
+
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int i = 0; i < num_images; ++i) {
+        if (!valid[i]) {
+            continue;
+        }
+        const float* __restrict__ a = descriptors + static_cast<size_t>(i) * dim;
+
+        // similarity against every other frame outside the sequential window
+        std::vector<std::pair<float, int>> scored;
+        scored.reserve(num_images);
+        for (int j = 0; j < num_images; ++j) {
+            if (j == i || !valid[j] || std::abs(i - j) <= sequential_overlap) {
+                continue;
+            }
+            const float* __restrict__ b = descriptors + static_cast<size_t>(j) * dim;
+            float dot = 0.0f;
+            #pragma omp simd reduction(+:dot)
+            for (int d = 0; d < dim; ++d) {
+                dot += a[d] * b[d];
+            }
+            scored.emplace_back(dot, j);
+        }
+
+        const int top = std::min<int>(k, scored.size());
+        std::partial_sort(scored.begin(), scored.begin() + top, scored.end(),
+                          [](const auto& l, const auto& r) { return l.first > r.first; });
+
+        auto& pairs = per_row[i];
+        for (int t = 0; t < top; ++t) {
+            const int j = scored[t].second;
+            pairs.emplace_back(std::min(i, j), std::max(i, j));
+        }
+        for (int j = i + 1; j <= std::min(num_images - 1, i + sequential_overlap); ++j) {
+            if (valid[j]) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto& row : per_row) {
+        pairs.insert(pairs.end(), row.begin(), row.end());
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+void write_match_list(
+    const std::string& path,
+    const std::vector<std::string>& names,
+    const std::vector<std::pair<int, int>>& pairs
+) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not write match list: " + path);
+    }
+    for (const auto& p : pairs) {
+        out << names[p.first] << ' ' << names[p.second] << '\n';
+    }
+}
+
+/**
+ * python entry point for descriptors computed elsewhere (e.g. results["global_descriptors"])
+ */
+static py::dict image_pairs_knn(
+    const py::array_t<float, py::array::c_style | py::array::forcecast>& descriptors,
+    const std::vector<std::string>& names,
+    const std::string& output_path,
+    int k,
+    int sequential_overlap
+) {
+    auto buf = descriptors.request();
+    if (buf.ndim != 2 || buf.shape[0] != static_cast<ssize_t>(names.size())) {
+        throw std::invalid_argument("descriptors must have shape (num_images, dim) matching names");
+    }
+    if (k < 0 || sequential_overlap < 0) {
+        throw std::invalid_argument("k and sequential_overlap must be >= 0");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    const int num_images = buf.shape[0];
+    std::vector<bool> valid(num_images, true);
+    auto pairs = knn_image_pairs(static_cast<const float*>(buf.ptr), num_images, buf.shape[1],
+                                 valid, k, sequential_overlap);
+    write_match_list(output_path, names, pairs);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["num_pairs"] = static_cast<int>(pairs.size());
+    results["exhaustive_pairs"] = num_images * (num_images - 1) / 2;
+    results["output_path"] = output_path;
+    results["processing_time_ms"] = processing_time_ms;
+    return results;
+}
+
+void register_image_retrieval(py::module_& m) {
+    m.def("image_pairs_knn", &image_pairs_knn,
+          "k-nn over global frame descriptors plus sequential neighbours, written as a colmap match list",
+          py::arg("descriptors"), py::arg("names"), py::arg("output_path"),
+          py::arg("k") = 10, py::arg("sequential_overlap") = 5);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 16x16 masked luma thumbnail + 4x4x4 colour histogram
+static constexpr int RETRIEVAL_THUMB_SIZE = 16;
+static constexpr int RETRIEVAL_HIST_BINS = 4;
+static constexpr int RETRIEVAL_DESCRIPTOR_DIM =
+    RETRIEVAL_THUMB_SIZE * RETRIEVAL_THUMB_SIZE + RETRIEVAL_HIST_BINS * RETRIEVAL_HIST_BINS * RETRIEVAL_HIST_BINS;
+
+/**
+ * compact global descriptor for one frame, unit length so dot = cosine
+ * the thumbnail is taken over the mask's bbox, so it tracks the object
+ * rather than where it sits in the frame
+ */
+void compute_global_descriptor(const cv::Mat& bgr, const cv::Mat& mask, float* out);
+
+/**
+ * k most similar frames per frame (brute-force SIMD dot products) plus the
+ * `sequential_overlap` neighbours on either side, deduplicated as i < j
+ * rows of `valid` == false are ignored
+ */
+std::vector<std::pair<int, int>> knn_image_pairs(
+    const float* descriptors,
+    int num_images,
+    int dim,
+    const std::vector<bool>& valid,
+    int k,
+    int sequential_overlap
+);
+
+/**
+ * colmap matches_importer --match_type pairs format: "name1 name2" per line
+ */
+void write_match_list(
+    const std::string& path,
+    const std::vector<std::string>& names,
+    const std::vector<std::pair<int, int>>& pairs
+);
+
+void register_image_retrieval(pybind11::module_& m);
@@ -0,0 +1,149 @@
+#include "photometric.h"
+
+#include <algorithm>
+#include <cmath>
+
+// below this many masked pixels a frame's stats are too noisy to trust
+static constexpr uint64_t MIN_STATS_PIXELS = 256;
+
+void ChannelStats::accumulate_row(const uint8_t* __restrict__ bgr, const uint8_t* __restrict__ mask, int width) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0;
+    uint64_t q0 = 0, q1 = 0, q2 = 0;
+    uint64_t n = 0;
+
+    // branchless: multiply by the 0/1 mask test so the loop stays vectorized
+    #pragma omp simd reduction(+:s0, s1, s2, q0, q1, q2, n)
+    for (int x = 0; x < width; ++x) {
+        const uint32_t m = mask[x] > 0;
+        const uint32_t b = bgr[x * 3 + 0] * m;
+        const uint32_t g = bgr[x * 3 + 1] * m;
+        const uint32_t r = bgr[x * 3 + 2] * m;
+        s0 += b;
+        s1 += g;
+        s2 += r;
+        q0 += b * b;
+        q1 += g * g;
+        q2 += r * r;
+        n += m;
+    }
+
+    sum[0] += s0;
+    sum[1] += s1;
+    sum[2] += s2;
+    sum_sq[0] += q0;
+    sum_sq[1] += q1;
+    sum_sq[2] += q2;
+    count += n;
+}
+
+std::vector<ChannelGains> solve_photometric_gains(
+    const std::vector<ChannelStats>& stats,
+    int window,
+    float max_gain
+) {
+    const int n = static_cast<int>(stats.size());
+    std::vector<ChannelGains> gains(n);
+
+    // per-frame masked mean / std
+    std::vector<double> mean(n * 3), stddev(n * 3);
+    std::vector<bool> valid(n, false);
+    for (int i = 0; i < n; ++i) {
+        if (stats[i].count < MIN_STATS_PIXELS) {
+            continue;
+        }
+        valid[i] = true;
+        const double count = static_cast<double>(stats[i].count);
+        for (int c = 0; c < 3; ++c) {
+            const double mu = stats[i].sum[c] / count;
+            const double var = stats[i].sum_sq[c] / count - mu * mu;
+            mean[i * 3 + c] = mu;
+            // floor keeps flat-colour frames from blowing the gain up
+            stddev[i * 3 + c] = std::sqrt(std::max(var, 1.0));
+        }
+    }
+
+    // sequence reference: median of the per-frame stats, robust to a few bad frames
+    double ref_mean[3], ref_std[3];
+    for (int c = 0; c < 3; ++c) {
+        std::vector<double> mu, sd;
+        for (int i = 0; i < n; ++i) {
+            if (valid[i]) {
+                mu.push_back(mean[i * 3 + c]);
+                sd.push_back(stddev[i * 3 + c]);
+            }
+        }
+        if (mu.empty()) {
+            return gains;  // nothing measurable, identity everywhere
+        }
+        std::nth_element(mu.begin(), mu.begin() + mu.size() / 2, mu.end());
+        std::nth_element(sd.begin(), sd.begin() + sd.size() / 2, sd.end());
+        ref_mean[c] = mu[mu.size() / 2];
+        ref_std[c] = sd[sd.size() / 2];
+    }
+
+    // box-smooth over valid neighbours, then match the smoothed stats to the reference
+    const float min_gain = 1.0f / max_gain;
+    for (int i = 0; i < n; ++i) {
+        const int lo = std::max(0, i - window);
+        const int hi = std::min(n - 1, i + window);
+        double mu[3] = {0.0, 0.0, 0.0}, sd[3] = {0.0, 0.0, 0.0};
+        int used = 0;
+        for (int j = lo; j <= hi; ++j) {
+            if (!valid[j]) {
+                continue;
+            }
+            for (int c = 0; c < 3; ++c) {
+                mu[c] += mean[j * 3 + c];
+                sd[c] += stddev[j * 3 + c];
+            }
+            ++used;
+        }
+        if (used == 0) {
+            continue;  // isolated run of empty masks, leave untouched
+        }
+        for (int c = 0; c < 3; ++c) {
+            mu[c] /= used;
+            sd[c] /= used;
+            const float g = std::min(max_gain, std::max(min_gain, static_cast<float>(ref_std[c] / sd[c])));
+            gains[i].gain[c] = g;
+            gains[i].offset[c] = static_cast<float>(ref_mean[c] - g * mu[c]);
+        }
+    }
+    return gains;
+}
+
+void build_channel_luts(const ChannelGains& gains, uint8_t lut[3][256]) {
+    for (int c = 0; c < 3; ++c) {
+        for (int v = 0; v < 256; ++v) {
+            const float out = gains.gain[c] * v + gains.offset[c];
+            lut[c][v] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, std::round(out))));
+        }
+    }
+}
+
+void apply_channel_luts(cv::Mat& bgra, const uint8_t lut[3][256], bool zero_background) {
+    const int width = bgra.cols;
+    const uint8_t* __restrict__ lut_b = lut[0];
+    const uint8_t* __restrict__ lut_g = lut[1];
+    const uint8_t* __restrict__ lut_r = lut[2];
+
+    for (int y = 0; y < bgra.rows; ++y) {
+        uint8_t* __restrict__ px = bgra.ptr<uint8_t>(y);
+        if (zero_background) {
+            #pragma omp simd
+            for (int x = 0; x < width; ++x) {
+                const uint8_t keep = px[x * 4 + 3] != 0 ? 0xFF : 0x00;
+                px[x * 4 + 0] = lut_b[px[x * 4 + 0]] & keep;
+                px[x * 4 + 1] = lut_g[px[x * 4 + 1]] & keep;
+                px[x * 4 + 2] = lut_r[px[x * 4 + 2]] & keep;
+            }
+        } else {
+            #pragma omp simd
+            for (int x = 0; x < width; ++x) {
+                px[x * 4 + 0] = lut_b[px[x * 4 + 0]];
+                px[x * 4 + 1] = lut_g[px[x * 4 + 1]];
+                px[x * 4 + 2] = lut_r[px[x * 4 + 2]];
+            }
+        }
+    }
+}
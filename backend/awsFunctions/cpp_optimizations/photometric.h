@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * masked per-channel sums for one frame (bgr order), gathered row by row
+ * inside the compose kernel so the frame is only walked once
+ */
+struct ChannelStats {
+    uint64_t sum[3] = {0, 0, 0};
+    uint64_t sum_sq[3] = {0, 0, 0};
+    uint64_t count = 0;
+
+    void accumulate_row(const uint8_t* __restrict__ bgr, const uint8_t* __restrict__ mask, int width);
+};
+
+/**
+ * per-channel affine correction: out = gain * in + offset
+ */
+struct ChannelGains {
+    float gain[3] = {1.0f, 1.0f, 1.0f};
+    float offset[3] = {0.0f, 0.0f, 0.0f};
+};
+
+/**
+ * map every frame's masked mean/std onto the sequence median
+ * stats are box-smoothed over +-`window` frames first, so the correction
+ * follows exposure / white-balance drift rather than per-view content;
+ * gains are clamped to [1 / max_gain, max_gain]. frames with too few
+ * masked pixels borrow their neighbours' smoothed stats
+ */
+std::vector<ChannelGains> solve_photometric_gains(
+    const std::vector<ChannelStats>& stats,
+    int window,
+    float max_gain
+);
+
+/**
+ * one 256-entry table per channel, applied in place to the bgr of a bgra
+ * frame. zero_background leaves rgb under alpha == 0 at zero
+ */
+void build_channel_luts(const ChannelGains& gains, uint8_t lut[3][256]);
+void apply_channel_luts(cv::Mat& bgra, const uint8_t lut[3][256], bool zero_background);
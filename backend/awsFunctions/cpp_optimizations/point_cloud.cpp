@@ -0,0 +1,496 @@
+#include "point_cloud.h"
+#include "colmap_model.h"
+#include "splat_ply.h"
+#include "splat_sort.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// degree-0 sh basis, f_dc -> colour is 0.5 + SH_C0 * f_dc
+static constexpr float SH_C0 = 0.28209479177387814f;
+
+void PointCloud::resize(size_t n) {
+    count = n;
+    positions.resize(n * 3);
+    colors.resize(n * 3);
+}
+
+PointCloud PointCloud::gather(const std::vector<uint32_t>& indices) const {
+    PointCloud out;
+    out.resize(indices.size());
+    const int64_t n = static_cast<int64_t>(indices.size());
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        std::copy_n(&positions[static_cast<size_t>(indices[i]) * 3], 3, &out.positions[i * 3]);
+        std::copy_n(&colors[static_cast<size_t>(indices[i]) * 3], 3, &out.colors[i * 3]);
+    }
+    return out;
+}
+
+PointCloud PointCloud::read(const std::string& path, float min_opacity) {
+    PointCloud cloud;
+    if (fs::is_directory(path)) {
+        ColmapModel model;
+        read_points3D_bin(path + "/points3D.bin", model);
+        cloud.resize(model.points.size());
+        for (size_t i = 0; i < cloud.count; ++i) {
+            for (int a = 0; a < 3; ++a) {
+                cloud.positions[i * 3 + a] = static_cast<float>(model.points[i].xyz[a]);
+                cloud.colors[i * 3 + a] = model.points[i].rgb[a];
+            }
+        }
+        return cloud;
+    }
+
+    const SplatCloud splats = SplatCloud::read(path);
+    // sigmoid(opacity) >= min_opacity, compared on the stored logit
+    const float min_logit = min_opacity > 0.0f ? std::log(min_opacity / (1.0f - min_opacity)) : -std::numeric_limits<float>::infinity();
+    std::vector<uint32_t> kept;
+    kept.reserve(splats.count);
+    for (size_t i = 0; i < splats.count; ++i) {
+        if (splats.opacities[i] >= min_logit) {
+            kept.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    cloud.resize(kept.size());
+    const int64_t n = static_cast<int64_t>(kept.size());
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        const size_t s = kept[i];
+        for (int a = 0; a < 3; ++a) {
+            cloud.positions[i * 3 + a] = splats.positions[s * 3 + a];
+            const float value = std::clamp(0.5f + SH_C0 * splats.sh_dc[s * 3 + a], 0.0f, 1.0f);
+            cloud.colors[i * 3 + a] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+    }
+    return cloud;
+}
+
+size_t PointCloud::write(const std::string& path) const {
+    std::ostringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n";
+    header << "element vertex " << count << "\n";
+    for (const char* axis : {"x", "y", "z"}) {
+        header << "property float " << axis << "\n";
+    }
+    for (const char* channel : {"red", "green", "blue"}) {
+        header << "property uchar " << channel << "\n";
+    }
+    header << "end_header\n";
+
+    // previews are small: interleave the whole body once
+    constexpr size_t row_size = 3 * sizeof(float) + 3;
+    std::vector<char> body(count * row_size);
+    for (size_t i = 0; i < count; ++i) {
+        char* row = body.data() + i * row_size;
+        std::memcpy(row, &positions[i * 3], 3 * sizeof(float));
+        std::memcpy(row + 3 * sizeof(float), &colors[i * 3], 3);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    const std::string header_text = header.str();
+    out.write(header_text.data(), header_text.size());
+    out.write(body.data(), body.size());
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+    return header_text.size() + body.size();
+}
+
+/**
+ * the k best candidates so far, sorted by squared distance; k is small, so
+ * insertion into a sorted array beats a heap
+ */
+struct PointKdTree::KnnList {
+    int k;
+    int count = 0;
+    float distances[KDTREE_MAX_NEIGHBOURS];
+    uint32_t slots[KDTREE_MAX_NEIGHBOURS];  // leaf-order positions
+
+    float worst() const { return count < k ? std::numeric_limits<float>::infinity() : distances[k - 1]; }
+
+    void insert(float distance, uint32_t slot) {
+        int j = count < k ? count++ : k - 1;
+        while (j > 0 && distances[j - 1] > distance) {
+            distances[j] = distances[j - 1];
+            slots[j] = slots[j - 1];
+            --j;
+        }
+        distances[j] = distance;
+        slots[j] = slot;
+    }
+};
+
+PointKdTree::PointKdTree(const PointCloud& cloud) {
+    const size_t n = cloud.count;
+    // balanced splits leave ceil(n / 2^depth) points at most per leaf
+    while (n > 0 && ((n - 1) >> depth_) >= KDTREE_LEAF_SIZE) {
+        ++depth_;
+    }
+    nodes_.resize((size_t(1) << depth_) - 1);
+
+    // partition the points themselves, not indices into the cloud: every
+    // pass over a node is then a sequential scan
+    struct Entry {
+        float p[3];
+        uint32_t index;
+    };
+    std::vector<Entry> entries(n);
+    const int64_t count = static_cast<int64_t>(n);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < count; ++i) {
+        std::copy_n(&cloud.positions[i * 3], 3, entries[i].p);
+        entries[i].index = static_cast<uint32_t>(i);
+    }
+
+    for (int level = 0; level < depth_; ++level) {
+        const int64_t level_nodes = int64_t(1) << level;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int64_t j = 0; j < level_nodes; ++j) {
+            // the node's range follows from the path bits of j
+            size_t begin = 0, end = n;
+            for (int b = level - 1; b >= 0; --b) {
+                const size_t mid = begin + (end - begin) / 2;
+                if ((j >> b) & 1) {
+                    begin = mid;
+                } else {
+                    end = mid;
+                }
+            }
+
+            float lo[3], hi[3];
+            std::fill_n(lo, 3, std::numeric_limits<float>::max());
+            std::fill_n(hi, 3, std::numeric_limits<float>::lowest());
+            for (size_t i = begin; i < end; ++i) {
+                for (int a = 0; a < 3; ++a) {
+                    lo[a] = std::min(lo[a], entries[i].p[a]);
+                    hi[a] = std::max(hi[a], entries[i].p[a]);
+                }
+            }
+            int axis = 0;
+            for (int a = 1; a < 3; ++a) {
+                if (hi[a] - lo[a] > hi[axis] - lo[axis]) {
+                    axis = a;
+                }
+            }
+
+            const size_t mid = begin + (end - begin) / 2;
+            std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end,
+                             [axis](const Entry& a, const Entry& b) { return a.p[axis] < b.p[axis]; });
+            Node& node = nodes_[level_nodes - 1 + j];
+            node.axis = axis;
+            node.split = entries[mid].p[axis];
+        }
+    }
+
+    points_.resize(n * 3);
+    indices_.resize(n);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < count; ++i) {
+        std::copy_n(entries[i].p, 3, &points_[i * 3]);
+        indices_[i] = entries[i].index;
+    }
+}
+
+void PointKdTree::search(size_t node, size_t begin, size_t end, int depth, const float query[3], float box_distance, float offsets[3], KnnList& best) const {
+    if (depth == depth_) {
+        // distances first (vectorized), then the few that beat the worst
+        float distances[KDTREE_LEAF_SIZE];
+        const float* p = &points_[begin * 3];
+        const int size = static_cast<int>(end - begin);
+        #pragma omp simd
+        for (int i = 0; i < size; ++i) {
+            const float dx = p[i * 3] - query[0];
+            const float dy = p[i * 3 + 1] - query[1];
+            const float dz = p[i * 3 + 2] - query[2];
+            distances[i] = dx * dx + dy * dy + dz * dz;
+        }
+        float worst = best.worst();
+        for (int i = 0; i < size; ++i) {
+            if (distances[i] < worst) {
+                best.insert(distances[i], static_cast<uint32_t>(begin + i));
+                worst = best.worst();
+            }
+        }
+        return;
+    }
+
+    // left holds coordinates <= split, right >= split
+    const Node& split = nodes_[node];
+    const size_t mid = begin + (end - begin) / 2;
+    const float diff = query[split.axis] - split.split;
+    const size_t near_node = diff < 0.0f ? 2 * node + 1 : 2 * node + 2;
+    const size_t far_node = diff < 0.0f ? 2 * node + 2 : 2 * node + 1;
+    search(near_node, diff < 0.0f ? begin : mid, diff < 0.0f ? mid : end, depth + 1, query, box_distance, offsets, best);
+
+    // squared distance to the far child's box: this axis' term swaps to the
+    // split plane, the others are inherited from the path (nanoflann's bound)
+    const float old_offset = offsets[split.axis];
+    const float far_distance = box_distance - old_offset * old_offset + diff * diff;
+    if (far_distance < best.worst()) {
+        offsets[split.axis] = diff;
+        search(far_node, diff < 0.0f ? mid : begin, diff < 0.0f ? end : mid, depth + 1, query, far_distance, offsets, best);
+        offsets[split.axis] = old_offset;
+    }
+}
+
+int PointKdTree::knn(const float query[3], int k, uint32_t* indices, float* distances) const {
+    KnnList best;
+    best.k = std::clamp(k, 0, KDTREE_MAX_NEIGHBOURS);
+    if (best.k == 0 || indices_.empty()) {
+        return 0;
+    }
+    float offsets[3] = {0.0f, 0.0f, 0.0f};
+    search(0, 0, indices_.size(), 0, query, 0.0f, offsets, best);
+    for (int j = 0; j < best.count; ++j) {
+        indices[j] = indices_[best.slots[j]];
+        distances[j] = best.distances[j];
+    }
+    return best.count;
+}
+
+PointCloud voxel_downsample(const PointCloud& cloud, size_t max_points, double& voxel_size) {
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    if (n == 0) {
+        voxel_size = 0.0;
+        return PointCloud();
+    }
+    const float* p = cloud.positions.data();
+
+    float lo[3], hi[3];
+    for (int a = 0; a < 3; ++a) {
+        float axis_lo = std::numeric_limits<float>::max();
+        float axis_hi = std::numeric_limits<float>::lowest();
+        #pragma omp parallel for simd reduction(min:axis_lo) reduction(max:axis_hi)
+        for (int64_t i = 0; i < n; ++i) {
+            axis_lo = std::min(axis_lo, p[i * 3 + a]);
+            axis_hi = std::max(axis_hi, p[i * 3 + a]);
+        }
+        lo[a] = axis_lo;
+        hi[a] = axis_hi;
+    }
+    // cubic cells: one scale for every axis over the longest side
+    const double extent = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2], 1e-12f});
+    const double cells = static_cast<double>(1u << VOXEL_GRID_BITS);
+    const double scale = cells / extent;
+
+    std::vector<uint64_t> codes(n);
+    std::vector<uint32_t> order(n);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        uint32_t cell[3];
+        for (int a = 0; a < 3; ++a) {
+            cell[a] = static_cast<uint32_t>(std::clamp((p[i * 3 + a] - lo[a]) * scale, 0.0, cells - 1.0));
+        }
+        codes[i] = morton_encode(cell[0], cell[1], cell[2]);
+        order[i] = static_cast<uint32_t>(i);
+    }
+    radix_sort(codes, order, 3 * VOXEL_GRID_BITS);
+
+    int level = 0;
+    if (voxel_size > 0.0) {
+        level = static_cast<int>(std::ceil(std::log2(extent / voxel_size)));
+    } else {
+        // neighbours in morton order first differ at some octree level and
+        // stay apart below it, so one pass counts the occupied cells of
+        // every level at once
+        int64_t first_split[VOXEL_GRID_BITS + 1] = {};
+        #pragma omp parallel for schedule(static) reduction(+:first_split[:VOXEL_GRID_BITS + 1])
+        for (int64_t i = 1; i < n; ++i) {
+            const uint64_t diff = codes[i] ^ codes[i - 1];
+            if (diff != 0) {
+                const int top_triple = (63 - __builtin_clzll(diff)) / 3;
+                ++first_split[VOXEL_GRID_BITS - top_triple];
+            }
+        }
+        size_t occupied = 1;
+        for (int l = 1; l <= VOXEL_GRID_BITS; ++l) {
+            occupied += first_split[l];
+            if (occupied > max_points) {
+                break;
+            }
+            level = l;
+        }
+    }
+    level = std::clamp(level, 0, VOXEL_GRID_BITS);
+    voxel_size = extent / static_cast<double>(uint64_t(1) << level);
+    const int shift = 3 * (VOXEL_GRID_BITS - level);
+
+    std::vector<size_t> starts;
+    starts.reserve(std::min<size_t>(n, max_points) + 1);
+    for (int64_t i = 0; i < n; ++i) {
+        if (i == 0 || (codes[i] >> shift) != (codes[i - 1] >> shift)) {
+            starts.push_back(static_cast<size_t>(i));
+        }
+    }
+    starts.push_back(static_cast<size_t>(n));
+
+    PointCloud out;
+    out.resize(starts.size() - 1);
+    const int64_t num_voxels = static_cast<int64_t>(out.count);
+    #pragma omp parallel for schedule(static)
+    for (int64_t v = 0; v < num_voxels; ++v) {
+        double position[3] = {0.0, 0.0, 0.0};
+        // 64-bit: a coarse voxel over a dense cloud can hold more than 2^32 / 255 points
+        uint64_t color[3] = {0, 0, 0};
+        for (size_t i = starts[v]; i < starts[v + 1]; ++i) {
+            const size_t s = order[i];
+            for (int a = 0; a < 3; ++a) {
+                position[a] += p[s * 3 + a];
+                color[a] += cloud.colors[s * 3 + a];
+            }
+        }
+        const size_t members = starts[v + 1] - starts[v];
+        for (int a = 0; a < 3; ++a) {
+            out.positions[v * 3 + a] = static_cast<float>(position[a] / members);
+            out.colors[v * 3 + a] = static_cast<uint8_t>((color[a] + members / 2) / members);
+        }
+    }
+    return out;
+}
+
+std::vector<uint32_t> statistical_inliers(const PointCloud& cloud, int k, double std_ratio) {
+    std::vector<uint32_t> kept(cloud.count);
+    std::iota(kept.begin(), kept.end(), 0u);
+    if (k < 1 || cloud.count <= static_cast<size_t>(k)) {
+        return kept;
+    }
+
+    const PointKdTree tree(cloud);
+    std::vector<float> mean_distance(cloud.count);
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    // leaf order keeps consecutive queries on the same part of the tree
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t i = 0; i < n; ++i) {
+        uint32_t indices[KDTREE_MAX_NEIGHBOURS];
+        float distances[KDTREE_MAX_NEIGHBOURS];
+        // the first hit is the point itself
+        const int found = tree.knn(tree.point(i), k + 1, indices, distances);
+        float sum = 0.0f;
+        for (int j = 1; j < found; ++j) {
+            sum += std::sqrt(distances[j]);
+        }
+        mean_distance[tree.index(i)] = sum / (found - 1);
+    }
+
+    double sum = 0.0, sum_sq = 0.0;
+    #pragma omp parallel for simd reduction(+:sum, sum_sq)
+    for (int64_t i = 0; i < n; ++i) {
+        sum += mean_distance[i];
+        sum_sq += static_cast<double>(mean_distance[i]) * mean_distance[i];
+    }
+    const double mean = sum / n;
+    const double sigma = std::sqrt(std::max(0.0, sum_sq / n - mean * mean));
+    const double threshold = mean + std_ratio * sigma;
+
+    kept.clear();
+    for (int64_t i = 0; i < n; ++i) {
+        if (mean_distance[i] <= threshold) {
+            kept.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return kept;
+}
+
+/**
+ * small point cloud for the job preview from a colmap sparse model
+ * (directory) or a splat ply: voxel-grid downsampling to about max_points,
+ * then statistical outlier removal over k neighbours (k = 0 skips it),
+ * written as a binary ply of positions and 8-bit colours
+ */
+static py::dict make_point_cloud_preview(
+    const std::string& input_path,
+    const std::string& output_path,
+    int max_points,
+    double voxel_size,
+    int k,
+    double std_ratio,
+    double min_opacity
+) {
+    if (max_points < 1) {
+        throw std::invalid_argument("max_points must be >= 1");
+    }
+    if (k < 0 || k >= KDTREE_MAX_NEIGHBOURS) {
+        throw std::invalid_argument("k must be in [0, " + std::to_string(KDTREE_MAX_NEIGHBOURS - 1) + "]");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    size_t input_points = 0, voxels = 0, points = 0, bytes = 0;
+    double cell_size = voxel_size;
+    double read_time_ms = 0.0, downsample_time_ms = 0.0, outlier_time_ms = 0.0;
+    {
+        py::gil_scoped_release release;
+
+        #ifdef _OPENMP
+        omp_set_num_threads(std::min(4, omp_get_max_threads()));
+        #endif
+
+        const PointCloud cloud = PointCloud::read(input_path, static_cast<float>(min_opacity));
+        input_points = cloud.count;
+        auto read_time = std::chrono::high_resolution_clock::now();
+        read_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(read_time - start_time).count() / 1000.0;
+
+        const PointCloud downsampled = voxel_downsample(cloud, static_cast<size_t>(max_points), cell_size);
+        voxels = downsampled.count;
+        auto downsample_time = std::chrono::high_resolution_clock::now();
+        downsample_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(downsample_time - read_time).count() / 1000.0;
+
+        const PointCloud preview = downsampled.gather(statistical_inliers(downsampled, k, std_ratio));
+        points = preview.count;
+        outlier_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - downsample_time).count() / 1000.0;
+
+        bytes = preview.write(output_path);
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["input_points"] = input_points;
+    results["voxel_size"] = cell_size;
+    results["voxels"] = voxels;
+    results["outliers_removed"] = voxels - points;
+    results["points"] = points;
+    results["bytes"] = bytes;
+    results["output_path"] = output_path;
+    results["read_time_ms"] = read_time_ms;
+    results["downsample_time_ms"] = downsample_time_ms;
+    results["outlier_time_ms"] = outlier_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ point cloud preview results:\n");
+    printf("  points: %zu -> %zu voxels (size %.4g) -> %zu after outlier removal\n", input_points, voxels, cell_size, points);
+    printf("  output: %.2f MB\n", bytes / (1024.0 * 1024.0));
+    printf("  total time: %.2f ms (read %.2f ms, downsample %.2f ms, outliers %.2f ms)\n",
+           processing_time_ms, read_time_ms, downsample_time_ms, outlier_time_ms);
+    return results;
+}
+
+void register_point_cloud(py::module_& m) {
+    m.def("make_point_cloud_preview", &make_point_cloud_preview,
+          "voxel-downsample a colmap model or splat ply, drop statistical outliers and write a small binary ply",
+          py::arg("input_path"), py::arg("output_path"), py::arg("max_points") = 200000,
+          py::arg("voxel_size") = 0.0, py::arg("k") = 16, py::arg("std_ratio") = 2.0,
+          py::arg("min_opacity") = 0.1);
+}
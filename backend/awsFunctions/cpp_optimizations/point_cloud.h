@@ -0,0 +1,106 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// points per kd-tree leaf (upper bound, leaves are balanced)
+static constexpr size_t KDTREE_LEAF_SIZE = 16;
+
+// neighbours per k-nn query, the result lists live on the stack
+static constexpr int KDTREE_MAX_NEIGHBOURS = 64;
+
+// finest voxel grid is 2^16 cells per axis of the bounding cube: 48-bit
+// morton keys, two radix passes fewer than a full 63-bit code
+static constexpr int VOXEL_GRID_BITS = 16;
+
+/**
+ * coloured points as structure of arrays: float32 xyz, 8-bit rgb
+ */
+struct PointCloud {
+    size_t count = 0;
+    std::vector<float> positions;  // N x 3
+    std::vector<uint8_t> colors;   // N x 3
+
+    void resize(size_t n);
+
+    // new cloud holding points[indices] in that order
+    PointCloud gather(const std::vector<uint32_t>& indices) const;
+
+    /**
+     * points3D.bin of a colmap sparse model (a directory), or a splat ply:
+     * splat centres coloured by their dc term, skipping splats whose sigmoid
+     * opacity is below min_opacity
+     */
+    static PointCloud read(const std::string& path, float min_opacity);
+
+    // binary little-endian ply: float x y z, uchar red green blue
+    size_t write(const std::string& path) const;
+};
+
+/**
+ * static kd-tree over 3d points for k-nearest-neighbour queries
+ *
+ * balanced median splits on the widest axis of each node, stored
+ * implicitly (node i has children 2i + 1 and 2i + 2, every leaf at the
+ * same depth), so the tree is just a split per node plus the points copied
+ * in leaf order: a leaf scan is a contiguous run of floats. the levels are
+ * built one at a time, the nodes of a level in parallel. queries are
+ * read-only and safe from any number of threads
+ */
+class PointKdTree {
+public:
+    explicit PointKdTree(const PointCloud& cloud);
+
+    /**
+     * the k (<= KDTREE_MAX_NEIGHBOURS) points nearest to query, closest
+     * first: indices into the cloud and squared distances. a query point
+     * that is in the cloud finds itself. returns how many were found
+     * (min(k, count))
+     */
+    int knn(const float query[3], int k, uint32_t* indices, float* distances) const;
+
+    size_t size() const { return indices_.size(); }
+
+    // point i in leaf order and its index in the cloud
+    const float* point(size_t i) const { return &points_[i * 3]; }
+    uint32_t index(size_t i) const { return indices_[i]; }
+
+private:
+    struct Node {
+        float split;
+        int axis;
+    };
+    struct KnnList;
+
+    // box_distance: squared distance from the query to the node's cell,
+    // offsets: per axis, the query's offset from the cell's nearest face
+    void search(size_t node, size_t begin, size_t end, int depth, const float query[3], float box_distance, float offsets[3], KnnList& best) const;
+
+    int depth_ = 0;               // split levels; nodes at this depth are leaves
+    std::vector<Node> nodes_;     // 2^depth_ - 1 inner nodes
+    std::vector<float> points_;   // N x 3, leaf order
+    std::vector<uint32_t> indices_;
+};
+
+/**
+ * voxel-grid downsampling: one point per occupied cell at the centroid of
+ * its points, with their mean colour. cells are a power-of-two grid over
+ * the cloud's bounding cube (the octree level of its morton codes):
+ * voxel_size > 0 picks the coarsest level whose cells are no larger,
+ * otherwise the finest level with at most max_points occupied cells
+ * (levels stop at VOXEL_GRID_BITS).
+ * returns the cloud in morton order; voxel_size is set to the cell size used
+ */
+PointCloud voxel_downsample(const PointCloud& cloud, size_t max_points, double& voxel_size);
+
+/**
+ * statistical outlier removal: a point goes when its mean distance to its
+ * k nearest neighbours exceeds the cloud-wide mean of that by more than
+ * std_ratio standard deviations. returns the kept indices in order
+ */
+std::vector<uint32_t> statistical_inliers(const PointCloud& cloud, int k, double std_ratio);
+
+void register_point_cloud(pybind11::module_& m);
@@ -0,0 +1,290 @@
+#include "progress_watcher.h"
+#include "colmap_model.h"
+#include "splat_ply.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// one read() of queued inotify events
+static constexpr size_t EVENT_BUFFER_BYTES = 64 * 1024;
+
+static constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+static std::string lowercase_extension(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+ProgressWatcher::ProgressWatcher(
+    const std::string& directory,
+    const std::string& sparse_dir,
+    int max_size,
+    const std::string& format,
+    int quality
+) : directory_(directory), max_size_(max_size) {
+    if (max_size < 16) {
+        throw std::invalid_argument("max_size must be >= 16");
+    }
+    if (quality < 1 || quality > 100) {
+        throw std::invalid_argument("quality must be in [1, 100]");
+    }
+    if (format == "webp") {
+        extension_ = ".webp";
+        encode_params_ = {cv::IMWRITE_WEBP_QUALITY, quality};
+    } else if (format == "jpg" || format == "jpeg") {
+        extension_ = ".jpg";
+        encode_params_ = {cv::IMWRITE_JPEG_QUALITY, quality};
+    } else {
+        throw std::invalid_argument("format must be webp or jpg, got " + format);
+    }
+    if (!fs::is_directory(directory)) {
+        throw std::runtime_error("Could not watch " + directory + ": not a directory");
+    }
+
+    if (!sparse_dir.empty()) {
+        const ColmapModel model = ColmapModel::read(sparse_dir);
+        const ColmapCamera* camera = model.images.empty() ? nullptr : model.find_camera(model.images[0].camera_id);
+        if (!camera || camera->width == 0 || camera->height == 0) {
+            throw std::runtime_error("No usable first view in " + sparse_dir);
+        }
+        camera_ = colmap_render_camera(*camera, model.images[0], max_size);
+        render_splats_ = true;
+    }
+
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0 || pipe2(stop_pipe_, O_CLOEXEC) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (inotify_fd_ >= 0) {
+            close(inotify_fd_);
+        }
+        throw std::runtime_error("Could not watch " + directory + ": " + reason);
+    }
+    add_watch(directory_);
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory_)) {
+        if (entry.is_directory()) {
+            add_watch(entry.path().string());
+        }
+    }
+    thread_ = std::thread(&ProgressWatcher::run, this);
+}
+
+ProgressWatcher::~ProgressWatcher() {
+    stop();
+    close(inotify_fd_);
+    close(stop_pipe_[0]);
+    close(stop_pipe_[1]);
+}
+
+void ProgressWatcher::add_watch(const std::string& path) {
+    const int wd = inotify_add_watch(inotify_fd_, path.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        printf("ERROR: Could not watch %s: %s\n", path.c_str(), std::strerror(errno));
+        return;
+    }
+    watches_[wd] = path;
+}
+
+void ProgressWatcher::run() {
+    alignas(inotify_event) char buffer[EVENT_BUFFER_BYTES];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_pipe_[0], POLLIN, 0}};
+    bool stopping = false;
+    while (!stopping) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf("ERROR: Progress watcher poll failed: %s\n", std::strerror(errno));
+            break;
+        }
+        stopping = fds[1].revents != 0;
+        // drain the non-blocking fd: on stop this still takes whatever the
+        // kernel queued before it, e.g. the final export
+        for (;;) {
+            const ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            handle_events(buffer, static_cast<size_t>(length));
+        }
+    }
+}
+
+void ProgressWatcher::handle_events(const char* buffer, size_t length) {
+    for (size_t offset = 0; offset < length;) {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += sizeof(inotify_event) + event->len;
+        if (event->mask & IN_Q_OVERFLOW) {
+            printf("ERROR: Progress watcher event queue overflowed, some frames were missed\n");
+            continue;
+        }
+        const auto watch = watches_.find(event->wd);
+        if (event->len == 0 || watch == watches_.end()) {
+            continue;
+        }
+        const std::string path = watch->second + "/" + event->name;
+        if (event->mask & IN_ISDIR) {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                add_watch(path);
+                // files written before the watch existed
+                std::error_code error;
+                for (const fs::directory_entry& entry : fs::directory_iterator(path, error)) {
+                    if (entry.is_regular_file()) {
+                        handle_file(entry.path().string());
+                    }
+                }
+            }
+        } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+            handle_file(path);
+        }
+    }
+}
+
+void ProgressWatcher::handle_file(const std::string& path) {
+    const fs::path file(path);
+    const std::string extension = lowercase_extension(file);
+    const bool image = extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".webp";
+    // export_5000.ply yes, export_5000.compressed.ply no
+    const bool splat = extension == ".ply" && render_splats_ && file.stem().extension().empty();
+    if (!image && !splat) {
+        return;
+    }
+
+    cv::Mat frame;
+    std::vector<uint8_t> bytes;
+    try {
+        if (image) {
+            frame = cv::imread(path, cv::IMREAD_COLOR);
+        } else {
+            const SplatCloud cloud = SplatCloud::read(path);
+            SplatRenderer renderer(cloud);
+            const float white[3] = {1.0f, 1.0f, 1.0f};
+            frame = renderer.render(camera_, white);
+        }
+        if (frame.empty()) {
+            throw std::runtime_error("unreadable image");
+        }
+        const int longest = std::max(frame.cols, frame.rows);
+        if (longest > max_size_) {
+            const double scale = static_cast<double>(max_size_) / longest;
+            cv::Mat small;
+            cv::resize(frame, small, cv::Size(std::max(1, static_cast<int>(std::lround(frame.cols * scale))),
+                                              std::max(1, static_cast<int>(std::lround(frame.rows * scale)))),
+                       0, 0, cv::INTER_AREA);
+            frame = small;
+        }
+        if (!cv::imencode(extension_, frame, bytes, encode_params_)) {
+            throw std::runtime_error("encoding failed");
+        }
+    } catch (const std::exception& e) {
+        printf("ERROR: Progress frame %s skipped: %s\n", path.c_str(), e.what());
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++failed_;
+        return;
+    }
+
+    ProgressPreview preview;
+    preview.name = file.lexically_relative(directory_).replace_extension(extension_).generic_string();
+    preview.bytes = std::move(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(preview));
+        if (queue_.size() > PROGRESS_MAX_PENDING) {
+            queue_.pop_front();
+            ++dropped_;
+        }
+        ++encoded_;
+    }
+    ready_.notify_one();
+}
+
+bool ProgressWatcher::next(ProgressPreview& preview, double timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [this] { return !queue_.empty() || stopped_; };
+    if (timeout < 0.0) {
+        ready_.wait(lock, ready);
+    } else {
+        ready_.wait_for(lock, std::chrono::duration<double>(timeout), ready);
+    }
+    if (queue_.empty()) {
+        return false;
+    }
+    preview = std::move(queue_.front());
+    queue_.pop_front();
+    return true;
+}
+
+void ProgressWatcher::stop() {
+    if (thread_.joinable()) {
+        const char wake = 1;
+        if (write(stop_pipe_[1], &wake, 1) != 1) {
+            printf("ERROR: Could not signal the progress watcher: %s\n", std::strerror(errno));
+        }
+        thread_.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    ready_.notify_all();
+}
+
+size_t ProgressWatcher::encoded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return encoded_;
+}
+
+size_t ProgressWatcher::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+size_t ProgressWatcher::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+void register_progress_watcher(py::module_& m) {
+    py::class_<ProgressWatcher>(m, "ProgressWatcher",
+        "inotify watch on a directory tree; new frames (and splat exports, given a sparse model) come back "
+        "downsized and re-encoded in memory through get()")
+        .def(py::init<const std::string&, const std::string&, int, const std::string&, int>(),
+             py::arg("directory"), py::arg("sparse_dir") = "", py::arg("max_size") = 384,
+             py::arg("format") = "webp", py::arg("quality") = 75)
+        .def("get", [](ProgressWatcher& watcher, double timeout) -> py::object {
+            ProgressPreview preview;
+            bool found;
+            {
+                py::gil_scoped_release release;
+                found = watcher.next(preview, timeout);
+            }
+            if (!found) {
+                return py::none();
+            }
+            return py::make_tuple(preview.name, py::bytes(reinterpret_cast<const char*>(preview.bytes.data()), preview.bytes.size()));
+        }, "(name, bytes) of the oldest preview, or None after timeout seconds (< 0 waits until one arrives "
+           "or the watcher stops)", py::arg("timeout") = -1.0)
+        .def("stop", &ProgressWatcher::stop, "handle the events already queued, then stop watching",
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("encoded", &ProgressWatcher::encoded)
+        .def_property_readonly("dropped", &ProgressWatcher::dropped)
+        .def_property_readonly("failed", &ProgressWatcher::failed);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "splat_render.h"
+
+#include <pybind11/pybind11.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// previews waiting for python; a stalled consumer loses the oldest
+static constexpr size_t PROGRESS_MAX_PENDING = 64;
+
+struct ProgressPreview {
+    std::string name;            // path relative to the watched dir, preview extension
+    std::vector<uint8_t> bytes;  // encoded webp / jpeg
+};
+
+/**
+ * training-progress previews without polling: an inotify watch on a
+ * directory tree (subdirectories created later are watched too) feeds one
+ * worker thread that downsizes each newly written frame and re-encodes it
+ * in memory. images (png / jpg / webp) are taken as they are; splat
+ * exports (<name>.ply, not derived <name>.<kind>.ply files) are rendered
+ * from the first colmap view when a sparse model is given
+ *
+ * files count once closed after writing or renamed into place. the queue
+ * holds at most PROGRESS_MAX_PENDING previews; older ones are dropped
+ * first. stop() handles the events already queued, then ends the thread
+ */
+class ProgressWatcher {
+public:
+    ProgressWatcher(const std::string& directory, const std::string& sparse_dir, int max_size, const std::string& format, int quality);
+    ~ProgressWatcher();
+
+    ProgressWatcher(const ProgressWatcher&) = delete;
+    ProgressWatcher& operator=(const ProgressWatcher&) = delete;
+
+    /**
+     * pop the oldest preview, waiting up to timeout seconds (< 0: until one
+     * arrives or the watcher stops). false if there is none
+     */
+    bool next(ProgressPreview& preview, double timeout);
+
+    void stop();
+
+    size_t encoded() const;
+    size_t dropped() const;
+    size_t failed() const;
+
+private:
+    void run();
+    void handle_events(const char* buffer, size_t length);
+    void add_watch(const std::string& path);
+    void handle_file(const std::string& path);
+
+    std::string directory_;
+    int max_size_;
+    std::string extension_;
+    std::vector<int> encode_params_;
+    bool render_splats_ = false;
+    RenderCamera camera_;
+
+    int inotify_fd_ = -1;
+    int stop_pipe_[2] = {-1, -1};
+    std::unordered_map<int, std::string> watches_;  // watch descriptor -> directory
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<ProgressPreview> queue_;
+    bool stopped_ = false;
+    size_t encoded_ = 0;
+    size_t dropped_ = 0;
+    size_t failed_ = 0;
+};
+
+void register_progress_watcher(pybind11::module_& m);
@@ -4,11 +4,35 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include "colmap_features.h"
+#include "image_retrieval.h"
+#include "frame_analysis.h"
+#include "photometric.h"
+#include "frame_cache.h"
+#include "checksum.h"
+#include "mapped_file.h"
+#include "colmap_model.h"
+#include "undistort.h"
+#include "visual_hull.h"
+#include "splat_ply.h"
+#include "splat_compress.h"
+#include "splat_cleanup.h"
+#include "splat_sort.h"
+#include "splat_lod.h"
+#include "splat_render.h"
+#include "progress_watcher.h"
+#include "point_cloud.h"
+#include "splat_mesh.h"
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <atomic>
 #include <thread>
+#include <stdexcept>
+#include <cstring>
+#include <climits>
+#include <fstream>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -16,6 +40,514 @@
 
 namespace py = pybind11;
 
+/**
+ * knobs for the rgba batch, exposed to python as torque_cpp.RGBAOptions
+ * defaults reproduce the original hard-alpha output
+ */
+struct RGBAOptions {
+    // 0 = hard alpha (mask > 0 ? 255 : 0), otherwise box-feather radius in pixels
+    int feather_radius = 0;
+    // what to store under alpha == 0: "keep" original rgb, "zero" it, or "bleed" nearest foreground
+    std::string background = "keep";
+    // write only the (padded) mask bounding box of each frame
+    bool crop = false;
+    int crop_padding = 16;
+    // use one crop size for the whole sequence (centred per frame)
+    bool crop_snap = false;
+    // optional json with per-frame crop offsets for principal point fix-ups
+    std::string crop_json_path;
+    // optional colmap --ImageReader.mask_path dir: <output name>.png binary masks
+    std::string mask_dir;
+    // optional colmap database.db: masked sift from the decoded frames, replaces feature_extractor
+    std::string feature_db_path;
+    int max_features = 8192;
+    // share one camera per frame size (colmap's ImageReader.single_camera)
+    bool single_camera = true;
+    // optional colmap match list from global-descriptor k-nn (matches_importer --match_type pairs)
+    std::string match_list_path;
+    int retrieval_k = 10;
+    int retrieval_overlap = 5;
+    // match each frame's masked colour stats to the sequence (two passes, frames held in memory)
+    bool photometric_normalize = false;
+    int photometric_window = 15;
+    float photometric_max_gain = 1.5f;
+    // optional manifest of content keys: frames whose image, mask and settings are unchanged keep their output
+    std::string cache_manifest_path;
+    // checksums of each encoded output, taken from the in-memory buffer (s3's ChecksumCRC32C / ChecksumSHA256)
+    bool checksum_crc32c = false;
+    bool checksum_sha256 = false;
+};
+
+static constexpr int MAX_FEATHER_RADIUS = 64;
+
+enum class BackgroundMode { Keep, Zero, Bleed };
+
+static BackgroundMode parse_background_mode(const std::string& mode) {
+    if (mode == "keep") return BackgroundMode::Keep;
+    if (mode == "zero") return BackgroundMode::Zero;
+    if (mode == "bleed") return BackgroundMode::Bleed;
+    throw std::invalid_argument("background must be one of 'keep', 'zero', 'bleed'");
+}
+
+static void validate_options(const RGBAOptions& options) {
+    if (options.feather_radius < 0 || options.feather_radius > MAX_FEATHER_RADIUS) {
+        throw std::invalid_argument("feather_radius must be in [0, 64]");
+    }
+    parse_background_mode(options.background);
+    if (options.crop_padding < 0) {
+        throw std::invalid_argument("crop_padding must be >= 0");
+    }
+    if (options.max_features <= 0) {
+        throw std::invalid_argument("max_features must be > 0");
+    }
+    if (options.retrieval_k < 0 || options.retrieval_overlap < 0) {
+        throw std::invalid_argument("retrieval_k and retrieval_overlap must be >= 0");
+    }
+    if (options.photometric_window < 0 || options.photometric_max_gain < 1.0f) {
+        throw std::invalid_argument("photometric_window must be >= 0 and photometric_max_gain >= 1");
+    }
+}
+
+/**
+ * mask bounding box via SIMD row/column reductions
+ * one streaming pass: each row is OR-reduced for the row test and OR-ed into
+ * a column accumulator for the column test. returns an empty rect if the
+ * mask has no foreground.
+ */
+static cv::Rect mask_bounding_box(const uint8_t* __restrict__ mask_data, const int width, const int height) {
+    thread_local std::vector<uint8_t> col_any;
+    col_any.assign(width, 0);
+    uint8_t* __restrict__ cols = col_any.data();
+    
+    int y_min = -1, y_max = -1;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* __restrict__ m = mask_data + static_cast<size_t>(y) * width;
+        uint8_t row_any = 0;
+        #pragma omp simd reduction(|:row_any)
+        for (int x = 0; x < width; ++x) {
+            row_any |= m[x];
+            cols[x] |= m[x];
+        }
+        if (row_any) {
+            if (y_min < 0) y_min = y;
+            y_max = y;
+        }
+    }
+    if (y_min < 0) {
+        return cv::Rect();
+    }
+    
+    int x_min = 0, x_max = width - 1;
+    while (x_min < width && !cols[x_min]) ++x_min;
+    while (x_max > x_min && !cols[x_max]) --x_max;
+    return cv::Rect(x_min, y_min, x_max - x_min + 1, y_max - y_min + 1);
+}
+
+/**
+ * per-frame output rects: padded bbox (plus the feather band) clamped to the
+ * frame, optionally snapped to the largest padded size in the sequence and
+ * re-centred on each frame's bbox. empty masks keep the full frame unless
+ * snapping, in which case they get a centred box of the common size.
+ */
+static std::vector<cv::Rect> compute_crop_rects(
+    const std::vector<cv::Rect>& bboxes,
+    const int width,
+    const int height,
+    const RGBAOptions& options
+) {
+    const int pad = options.crop_padding + options.feather_radius;
+    std::vector<cv::Rect> rects(bboxes.size());
+    
+    int snap_w = 0, snap_h = 0;
+    for (size_t i = 0; i < bboxes.size(); ++i) {
+        const cv::Rect& b = bboxes[i];
+        if (b.area() == 0) {
+            rects[i] = cv::Rect(0, 0, width, height);
+            continue;
+        }
+        const int x0 = std::max(0, b.x - pad);
+        const int y0 = std::max(0, b.y - pad);
+        const int x1 = std::min(width, b.x + b.width + pad);
+        const int y1 = std::min(height, b.y + b.height + pad);
+        rects[i] = cv::Rect(x0, y0, x1 - x0, y1 - y0);
+        snap_w = std::max(snap_w, rects[i].width);
+        snap_h = std::max(snap_h, rects[i].height);
+    }
+    
+    if (!options.crop_snap || snap_w == 0) {
+        return rects;
+    }
+    
+    for (size_t i = 0; i < bboxes.size(); ++i) {
+        const cv::Rect& b = bboxes[i];
+        const int cx = b.area() > 0 ? b.x + b.width / 2 : width / 2;
+        const int cy = b.area() > 0 ? b.y + b.height / 2 : height / 2;
+        const int x0 = std::min(std::max(0, cx - snap_w / 2), width - snap_w);
+        const int y0 = std::min(std::max(0, cy - snap_h / 2), height - snap_h);
+        rects[i] = cv::Rect(x0, y0, snap_w, snap_h);
+    }
+    return rects;
+}
+
+/**
+ * content key of one output frame: the source image bytes, the bit-packed
+ * mask, and every setting that changes the encoded png. bump the version
+ * when the compose kernel's output changes
+ */
+static uint64_t frame_content_key(
+    const std::string& image_path,
+    const uint8_t* mask_data,
+    const int width,
+    const int height,
+    const cv::Rect& roi,
+    const RGBAOptions& options
+) {
+    const uint64_t fields[] = {
+        1,  // kernel version
+        file_content_hash(image_path),
+        mask_bits_hash(mask_data, width, height),
+        static_cast<uint64_t>(options.feather_radius),
+        static_cast<uint64_t>(parse_background_mode(options.background)),
+        static_cast<uint64_t>(roi.x), static_cast<uint64_t>(roi.y),
+        static_cast<uint64_t>(roi.width), static_cast<uint64_t>(roi.height),
+    };
+    return xxh64(fields, sizeof(fields));
+}
+
+/**
+ * roi of the hard mask as 0/255, what compose_bgra hands the colmap mask
+ * and sift paths, for frames whose rgba output is reused
+ */
+static void binary_mask_roi(const uint8_t* __restrict__ mask_data, const int width, const cv::Rect& roi, cv::Mat& out) {
+    out.create(roi.height, roi.width, CV_8UC1);
+    for (int oy = 0; oy < roi.height; ++oy) {
+        const uint8_t* __restrict__ m = mask_data + static_cast<size_t>(roi.y + oy) * width + roi.x;
+        uint8_t* __restrict__ mo = out.ptr<uint8_t>(oy);
+        #pragma omp simd
+        for (int x = 0; x < roi.width; ++x) {
+            mo[x] = (m[x] > 0) ? 255 : 0;
+        }
+    }
+}
+
+static bool file_exists(const std::string& path) {
+    return std::ifstream(path).good();
+}
+
+// ".png" for "dir/0001.png", what imencode picks the codec by
+static std::string path_extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of("/\\");
+    return dot == std::string::npos || (slash != std::string::npos && dot < slash) ? std::string() : path.substr(dot);
+}
+
+static bool write_buffer(const std::string& path, const std::vector<uint8_t>& buffer) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && written;
+}
+
+static std::string path_basename(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/**
+ * crop metadata for downstream intrinsics: cx' = cx - x, cy' = cy - y
+ */
+// quoted json string: quotes, backslashes and control characters escaped
+static std::string json_string(const std::string& value) {
+    std::string out = "\"";
+    for (const char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+static void write_crop_json(
+    const std::string& json_path,
+    const std::vector<std::string>& output_paths,
+    const std::vector<cv::Rect>& rects,
+    const std::vector<cv::Rect>& bboxes,
+    const int width,
+    const int height,
+    const RGBAOptions& options
+) {
+    std::ofstream out(json_path);
+    if (!out) {
+        throw std::runtime_error("Could not write crop metadata: " + json_path);
+    }
+    out << "{\n";
+    out << "  \"image_width\": " << width << ",\n";
+    out << "  \"image_height\": " << height << ",\n";
+    out << "  \"padding\": " << options.crop_padding << ",\n";
+    out << "  \"snapped\": " << (options.crop_snap ? "true" : "false") << ",\n";
+    out << "  \"frames\": [\n";
+    for (size_t i = 0; i < rects.size(); ++i) {
+        const cv::Rect& r = rects[i];
+        out << "    {\"image\": " << json_string(path_basename(output_paths[i])) << ", "
+            << "\"x\": " << r.x << ", \"y\": " << r.y << ", "
+            << "\"width\": " << r.width << ", \"height\": " << r.height << ", "
+            << "\"empty_mask\": " << (bboxes[i].area() == 0 ? "true" : "false") << "}"
+            << (i + 1 < rects.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * bleed the nearest visible colour along the row into alpha == 0 pixels
+ * returns false if the row has no visible pixels (caller fills it vertically)
+ */
+static bool bleed_row(uint8_t* __restrict__ out, const int width) {
+    thread_local std::vector<int32_t> dist;
+    dist.resize(width);
+    
+    // left -> right: carry the last visible colour
+    int last = -1;
+    for (int x = 0; x < width; ++x) {
+        if (out[x * 4 + 3] != 0) {
+            last = x;
+            dist[x] = 0;
+        } else if (last >= 0) {
+            std::memcpy(out + x * 4, out + last * 4, 3);
+            dist[x] = x - last;
+        } else {
+            dist[x] = INT32_MAX;
+        }
+    }
+    if (last < 0) {
+        return false;
+    }
+    
+    // right -> left: take the next visible colour where it is closer
+    int next = -1;
+    for (int x = width - 1; x >= 0; --x) {
+        if (dist[x] == 0) {
+            next = x;
+        } else if (next >= 0 && next - x < dist[x]) {
+            std::memcpy(out + x * 4, out + next * 4, 3);
+        }
+    }
+    return true;
+}
+
+static inline void copy_colour_row(const uint8_t* __restrict__ src, uint8_t* __restrict__ dst, const int width) {
+    #pragma omp simd
+    for (int x = 0; x < width; ++x) {
+        dst[x * 4 + 0] = src[x * 4 + 0];
+        dst[x * 4 + 1] = src[x * 4 + 1];
+        dst[x * 4 + 2] = src[x * 4 + 2];
+    }
+}
+
+/**
+ * fused compose kernel: bgr + mask -> bgra in one pass over the rows
+ *
+ * feathering keeps a running per-column count of mask hits over the
+ * (2r+1)-row window and a per-row prefix over those counts, so the box blur
+ * is separable and costs O(width) scratch per thread instead of a full-frame
+ * float buffer. pixels whose window is all background or all foreground
+ * short-circuit to 0/255, only the band around the silhouette pays for the
+ * division.
+ *
+ * background handling runs on the row while it is still in cache: "zero"
+ * clears rgb under alpha == 0, "bleed" carries the nearest visible colour
+ * along the row and repeats rows that have nothing visible, which leaves long
+ * runs that png's sub/up filters reduce to zeros.
+ *
+ * only the roi is written (bgra is roi-sized), but the feather window still
+ * reads mask rows/columns outside it so cropped and full outputs match.
+ *
+ * if binary_mask is given it receives the roi of the hard mask as 0/255 from
+ * the same row loop, for colmap's mask_path.
+ *
+ * if stats is given it accumulates masked per-channel sums over the roi for
+ * photometric normalization, again from rows already in cache.
+ */
+static void compose_bgra(
+    const cv::Mat& bgr,
+    const uint8_t* __restrict__ mask_data,
+    const int width,
+    const int height,
+    const cv::Rect& roi,
+    const RGBAOptions& options,
+    cv::Mat& bgra,
+    cv::Mat* binary_mask = nullptr,
+    ChannelStats* stats = nullptr
+) {
+    bgra.create(roi.height, roi.width, CV_8UC4);
+    if (binary_mask) {
+        binary_mask->create(roi.height, roi.width, CV_8UC1);
+    }
+    const int r = options.feather_radius;
+    const BackgroundMode background = parse_background_mode(options.background);
+    const int out_w = roi.width;
+    
+    // per-thread scratch, grows once and is reused across frames
+    thread_local std::vector<uint16_t> col_sum;
+    thread_local std::vector<uint32_t> row_prefix;
+    
+    // feather columns span the roi plus the window overhang, clipped to the frame
+    const int cx0 = std::max(0, roi.x - r);
+    const int cx1 = std::min(width, roi.x + roi.width + r);
+    const int span = cx1 - cx0;
+    const int prime_start = std::max(0, roi.y - r);
+    
+    if (r > 0) {
+        col_sum.assign(span, 0);
+        row_prefix.resize(span + 1);
+        
+        // prime the window with rows [roi.y - r, roi.y + r - 1]; row roi.y + r is added in the loop
+        for (int y = prime_start; y < std::min(roi.y + r, height); ++y) {
+            const uint8_t* __restrict__ m = mask_data + static_cast<size_t>(y) * width + cx0;
+            uint16_t* __restrict__ cs = col_sum.data();
+            #pragma omp simd
+            for (int x = 0; x < span; ++x) {
+                cs[x] += (m[x] > 0);
+            }
+        }
+    }
+    
+    int first_visible_row = -1;
+    int last_visible_row = -1;
+    
+    for (int oy = 0; oy < roi.height; ++oy) {
+        const int y = roi.y + oy;
+        const uint8_t* __restrict__ bgr_row = bgr.ptr<uint8_t>(y) + roi.x * 3;
+        const uint8_t* __restrict__ mask_row = mask_data + static_cast<size_t>(y) * width + roi.x;
+        uint8_t* __restrict__ out = bgra.ptr<uint8_t>(oy);
+        
+        // copy colour channels; opencv writes bgra so no channel swap needed
+        #pragma omp simd
+        for (int x = 0; x < out_w; ++x) {
+            out[x * 4 + 0] = bgr_row[x * 3 + 0];
+            out[x * 4 + 1] = bgr_row[x * 3 + 1];
+            out[x * 4 + 2] = bgr_row[x * 3 + 2];
+        }
+        
+        if (stats) {
+            stats->accumulate_row(bgr_row, mask_row, out_w);
+        }
+        
+        if (binary_mask) {
+            uint8_t* __restrict__ mo = binary_mask->ptr<uint8_t>(oy);
+            #pragma omp simd
+            for (int x = 0; x < out_w; ++x) {
+                mo[x] = (mask_row[x] > 0) ? 255 : 0;
+            }
+        }
+        
+        if (r == 0) {
+            // alpha channel (branchless for vectorization)
+            #pragma omp simd
+            for (int x = 0; x < out_w; ++x) {
+                out[x * 4 + 3] = (mask_row[x] > 0) ? 255 : 0;
+            }
+        } else {
+            // slide the vertical window: add row y + r, drop row y - r - 1
+            uint16_t* __restrict__ cs = col_sum.data();
+            if (y + r < height) {
+                const uint8_t* __restrict__ m_in = mask_data + static_cast<size_t>(y + r) * width + cx0;
+                #pragma omp simd
+                for (int x = 0; x < span; ++x) {
+                    cs[x] += (m_in[x] > 0);
+                }
+            }
+            if (y - r - 1 >= prime_start) {
+                const uint8_t* __restrict__ m_out = mask_data + static_cast<size_t>(y - r - 1) * width + cx0;
+                #pragma omp simd
+                for (int x = 0; x < span; ++x) {
+                    cs[x] -= (m_out[x] > 0);
+                }
+            }
+            
+            // horizontal pass via prefix sums over the column counts
+            uint32_t* __restrict__ prefix = row_prefix.data();
+            prefix[0] = 0;
+            for (int x = 0; x < span; ++x) {
+                prefix[x + 1] = prefix[x] + cs[x];
+            }
+            
+            // clip the window at frame borders so edges aren't darkened
+            const uint32_t rows_in_window = std::min(height - 1, y + r) - std::max(0, y - r) + 1;
+            for (int ox = 0; ox < out_w; ++ox) {
+                const int x = roi.x + ox;
+                const int x0 = std::max(0, x - r);
+                const int x1 = std::min(width - 1, x + r);
+                const uint32_t sum = prefix[x1 + 1 - cx0] - prefix[x0 - cx0];
+                const uint32_t count = rows_in_window * static_cast<uint32_t>(x1 - x0 + 1);
+                
+                uint8_t alpha;
+                if (sum == 0) {
+                    alpha = 0;
+                } else if (sum == count) {
+                    alpha = 255;
+                } else {
+                    alpha = static_cast<uint8_t>((sum * 255u + count / 2) / count);
+                }
+                out[ox * 4 + 3] = alpha;
+            }
+        }
+        
+        if (background == BackgroundMode::Zero) {
+            // branchless select keeps this vectorized
+            #pragma omp simd
+            for (int x = 0; x < out_w; ++x) {
+                const uint8_t keep = out[x * 4 + 3] != 0 ? 0xFF : 0x00;
+                out[x * 4 + 0] &= keep;
+                out[x * 4 + 1] &= keep;
+                out[x * 4 + 2] &= keep;
+            }
+        } else if (background == BackgroundMode::Bleed) {
+            if (bleed_row(out, out_w)) {
+                if (first_visible_row < 0) {
+                    first_visible_row = oy;
+                }
+                last_visible_row = oy;
+            } else if (last_visible_row >= 0) {
+                // fully transparent row below the object: repeat the row above
+                copy_colour_row(bgra.ptr<uint8_t>(oy - 1), out, out_w);
+            }
+        }
+    }
+    
+    if (background == BackgroundMode::Bleed) {
+        if (first_visible_row < 0) {
+            // nothing visible in the frame, fall back to zeroing
+            for (int oy = 0; oy < roi.height; ++oy) {
+                uint8_t* __restrict__ out = bgra.ptr<uint8_t>(oy);
+                #pragma omp simd
+                for (int x = 0; x < out_w; ++x) {
+                    out[x * 4 + 0] = out[x * 4 + 1] = out[x * 4 + 2] = 0;
+                }
+            }
+        } else {
+            // rows above the object repeat the first visible row (only touches background rows)
+            const uint8_t* src = bgra.ptr<uint8_t>(first_visible_row);
+            for (int oy = 0; oy < first_visible_row; ++oy) {
+                copy_colour_row(src, bgra.ptr<uint8_t>(oy), out_w);
+            }
+        }
+    }
+}
+
 class RGBAProcessor {
 public:
     /**
@@ -26,7 +558,8 @@ public:
         // vector of img paths, not a dir
         const std::vector<std::string>& image_paths,
         const py::array_t<uint8_t>& masks_array,
-        const std::vector<std::string>& output_paths
+        const std::vector<std::string>& output_paths,
+        const RGBAOptions& options
     ) {
         const int num_images = image_paths.size();
         
@@ -36,6 +569,7 @@ public:
         if (num_images != output_paths.size()) {
             throw std::invalid_argument("Number of image paths must match output paths");
         }
+        validate_options(options);
         
         // check masks array shape: (num_images, height, width)
         auto masks_buf = masks_array.request();
@@ -51,6 +585,25 @@ public:
         std::atomic<int> processed{0};
         std::atomic<int> errors{0};
         std::vector<std::string> output_files(num_images);
+        std::vector<std::string> mask_files(num_images);
+        const bool write_masks = !options.mask_dir.empty();
+        const bool extract_features = !options.feature_db_path.empty();
+        std::vector<FrameFeatures> features(extract_features ? num_images : 0);
+        const bool retrieval = !options.match_list_path.empty();
+        std::vector<float> global_descriptors(retrieval ? static_cast<size_t>(num_images) * RETRIEVAL_DESCRIPTOR_DIM : 0);
+        std::vector<uint8_t> descriptor_valid(num_images, 0);
+        const bool need_binary_mask = write_masks || extract_features || retrieval;
+        // normalization needs every frame's stats before any frame is encoded, so
+        // pass 1 keeps the composed frames and pass 2 applies the luts + encodes
+        const bool normalize = options.photometric_normalize;
+        std::vector<cv::Mat> composed(normalize ? num_images : 0);
+        std::vector<ChannelStats> channel_stats(normalize ? num_images : 0);
+        // reuse last run's output where the content key is unchanged; normalized
+        // frames depend on the whole sequence, so they are always recomposed
+        const bool use_cache = !options.cache_manifest_path.empty() && !normalize;
+        const FrameManifest manifest = use_cache ? FrameManifest::read(options.cache_manifest_path) : FrameManifest();
+        std::vector<FrameCacheEntry> cache_entries(use_cache ? num_images : 0);
+        std::vector<uint8_t> reused(num_images, 0);
         
         auto start_time = std::chrono::high_resolution_clock::now();
         
@@ -61,15 +614,136 @@ public:
         omp_set_num_threads(max_threads);
         #endif
         
+        // crop pre-pass: mask-only bbox reductions (cheap next to decode), then snap
+        std::vector<cv::Rect> bboxes(num_images);
+        std::vector<cv::Rect> rects(num_images, cv::Rect(0, 0, width, height));
+        if (options.crop) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < num_images; ++i) {
+                bboxes[i] = mask_bounding_box(masks_data + static_cast<size_t>(i) * height * width, width, height);
+            }
+            rects = compute_crop_rects(bboxes, width, height, options);
+        }
+        std::atomic<long long> output_pixels{0};
+        
+        // checksums come from the bytes as written, so the upload never reads the file back;
+        // the manifest keeps them for reruns that reuse the output
+        std::vector<std::string> crc32c_values(options.checksum_crc32c ? num_images : 0);
+        std::vector<std::string> sha256_values(options.checksum_sha256 ? num_images : 0);
+        auto record_checksums = [&](int i, const uint8_t* data, size_t size) {
+            if (options.checksum_crc32c) {
+                crc32c_values[i] = crc32c_base64(crc32c(data, size));
+            }
+            if (options.checksum_sha256) {
+                uint8_t digest[32];
+                sha256(data, size, digest);
+                sha256_values[i] = base64_encode(digest, sizeof(digest));
+            }
+            if (use_cache) {
+                if (options.checksum_crc32c) {
+                    cache_entries[i].crc32c = crc32c_values[i];
+                }
+                if (options.checksum_sha256) {
+                    cache_entries[i].sha256 = sha256_values[i];
+                }
+            }
+        };
+        
+        // save with decent PNG compression: encode to memory, checksum the
+        // buffer while it is in cache, then write it out in one go
+        const std::vector<int> png_params = {cv::IMWRITE_PNG_COMPRESSION, 6};
+        auto encode_output = [&](int i, const cv::Mat& rgba_image) {
+            thread_local std::vector<uint8_t> encoded;
+            if (cv::imencode(path_extension(output_paths[i]), rgba_image, encoded, png_params) &&
+                write_buffer(output_paths[i], encoded)) {
+                if (use_cache) {
+                    cache_entries[i] = FrameManifest::stat_output(output_paths[i], cache_entries[i].key);
+                }
+                record_checksums(i, encoded.data(), encoded.size());
+                output_files[i] = output_paths[i];
+                processed.fetch_add(1);
+                return true;
+            }
+            printf("ERROR: Could not save RGBA image: %s\n", output_paths[i].c_str());
+            errors.fetch_add(1);
+            return false;
+        };
+        auto write_colmap_mask = [&](int i, const std::string& mask_path, const cv::Mat& binary_mask) {
+            const std::vector<int> mask_params = {cv::IMWRITE_PNG_COMPRESSION, 3};
+            if (cv::imwrite(mask_path, binary_mask, mask_params)) {
+                mask_files[i] = mask_path;
+            } else {
+                printf("ERROR: Could not save COLMAP mask: %s\n", mask_path.c_str());
+            }
+        };
+        
+        // each frame counts once: a frame whose output already exists (reused,
+        // or encoded before sift / retrieval failed) stays processed, not an error
+        auto frame_failed = [&](int i) {
+            if (output_files[i].empty()) {
+                errors.fetch_add(1);
+            }
+        };
+        
         // process images in parallel with OpenMP
         #pragma omp parallel for schedule(dynamic) shared(output_files)
         for (int i = 0; i < num_images; ++i) {
             try {
+                // get mask data for this image
+                const uint8_t* mask_data = masks_data + (static_cast<size_t>(i) * height * width);
+                // colmap looks up <mask_path>/<image name>.png, e.g. 0001.png -> 0001.png.png
+                const std::string mask_path = write_masks ? options.mask_dir + "/" + path_basename(output_paths[i]) + ".png" : std::string();
+                // per-thread buffers, reused across frames
+                thread_local cv::Mat rgba_image;
+                thread_local cv::Mat binary_mask;
+                
+                // same image bytes, mask bits and settings as an output still on disk: keep it
+                if (use_cache) {
+                    cache_entries[i].key = frame_content_key(image_paths[i], mask_data, width, height, rects[i], options);
+                    if (manifest.matches(output_paths[i], cache_entries[i].key)) {
+                        reused[i] = 1;
+                        const FrameCacheEntry* recorded = manifest.find(output_paths[i]);
+                        cache_entries[i] = FrameManifest::stat_output(output_paths[i], cache_entries[i].key);
+                        cache_entries[i].crc32c = recorded->crc32c;
+                        cache_entries[i].sha256 = recorded->sha256;
+                        output_files[i] = output_paths[i];
+                        processed.fetch_add(1);
+                        output_pixels.fetch_add(static_cast<long long>(rects[i].area()));
+                        // checksums recorded when the output was encoded; the file is only read
+                        // back for one an earlier run didn't take
+                        if ((options.checksum_crc32c && recorded->crc32c.empty()) || (options.checksum_sha256 && recorded->sha256.empty())) {
+                            const MappedFile output(output_paths[i]);
+                            record_checksums(i, output.data(), output.size());
+                        } else {
+                            if (options.checksum_crc32c) {
+                                crc32c_values[i] = recorded->crc32c;
+                            }
+                            if (options.checksum_sha256) {
+                                sha256_values[i] = recorded->sha256;
+                            }
+                        }
+                        if (need_binary_mask) {
+                            binary_mask_roi(mask_data, width, rects[i], binary_mask);
+                        }
+                        // the colmap mask depends on the mask bits alone, so an existing one is current
+                        if (write_masks && file_exists(mask_path)) {
+                            mask_files[i] = mask_path;
+                        }
+                        // sift and retrieval still need the decoded frame
+                        if (!extract_features && !retrieval) {
+                            if (write_masks && mask_files[i].empty()) {
+                                write_colmap_mask(i, mask_path, binary_mask);
+                            }
+                            continue;
+                        }
+                    }
+                }
+                
                 // load image
                 cv::Mat image = cv::imread(image_paths[i], cv::IMREAD_COLOR);
                 if (image.empty()) {
                     printf("ERROR: Could not load image: %s\n", image_paths[i].c_str());
-                    errors.fetch_add(1);
+                    frame_failed(i);
                     continue;
                 }
                 
@@ -77,55 +751,105 @@ public:
                 if (image.rows != height || image.cols != width) {
                     printf("ERROR: Image dimensions (%dx%d) don't match mask (%dx%d): %s\n",
                            image.cols, image.rows, width, height, image_paths[i].c_str());
-                    errors.fetch_add(1);
+                    frame_failed(i);
                     continue;
                 }
                 
-                // convert BGR to RGB
-                cv::Mat image_rgb;
-                cv::cvtColor(image, image_rgb, cv::COLOR_BGR2RGB);
-                
-                // get mask data for this image
-                const uint8_t* mask_data = masks_data + (static_cast<size_t>(i) * height * width);
-                
-                // create RGBA output with aligned memory
-                cv::Mat rgba_image(height, width, CV_8UC4);
+                // compose straight from the decoded bgr into a per-thread buffer
+                if (!reused[i]) {
+                    cv::Mat& target = normalize ? composed[i] : rgba_image;
+                    compose_bgra(image, mask_data, width, height, rects[i], options, target,
+                                 need_binary_mask ? &binary_mask : nullptr,
+                                 normalize ? &channel_stats[i] : nullptr);
+                    output_pixels.fetch_add(static_cast<long long>(rects[i].area()));
+                    
+                    // encode now unless pass 2 still has to correct the colours
+                    if (!normalize && !encode_output(i, rgba_image)) {
+                        continue;
+                    }
+                }
                 
-                // SIMD-optimized pixel processing
-                const int total_pixels = height * width;
-                uint8_t* __restrict__ rgba_ptr = rgba_image.ptr<uint8_t>();
-                const uint8_t* __restrict__ rgb_ptr = image_rgb.ptr<uint8_t>();
+                if (write_masks && mask_files[i].empty()) {
+                    write_colmap_mask(i, mask_path, binary_mask);
+                }
                 
-                // vectorize with alignment hints for SIMD
-                #pragma omp simd aligned(rgb_ptr, mask_data, rgba_ptr: 32) \
-                                safelen(16) \
-                                simdlen(8)
-                for (int pixel = 0; pixel < total_pixels; ++pixel) {
-                    const int rgb_offset = pixel * 3;
-                    const int rgba_offset = pixel * 4;
-                    
-                    // copy RGB channels
-                    rgba_ptr[rgba_offset + 0] = rgb_ptr[rgb_offset + 0]; // R
-                    rgba_ptr[rgba_offset + 1] = rgb_ptr[rgb_offset + 1]; // G
-                    rgba_ptr[rgba_offset + 2] = rgb_ptr[rgb_offset + 2]; // B
-                    
-                    // alpha channel (branchless for vectorization)
-                    rgba_ptr[rgba_offset + 3] = (mask_data[pixel] > 0) ? 255 : 0; // A
+                // sift on the frame we already decoded, restricted to the mask
+                if (extract_features) {
+                    thread_local cv::Mat gray;
+                    cv::cvtColor(image(rects[i]), gray, cv::COLOR_BGR2GRAY);
+                    features[i].name = path_basename(output_paths[i]);
+                    extract_sift_features(gray, binary_mask, options.max_features, features[i]);
                 }
                 
-                // save with decent PNG compression
-                std::vector<int> png_params = {cv::IMWRITE_PNG_COMPRESSION, 6};
-                if (cv::imwrite(output_paths[i], rgba_image, png_params)) {
-                    output_files[i] = output_paths[i];
-                    processed.fetch_add(1);
-                } else {
-                    printf("ERROR: Could not save RGBA image: %s\n", output_paths[i].c_str());
-                    errors.fetch_add(1);
+                // global descriptor for pair preselection, from the same roi + mask
+                if (retrieval) {
+                    compute_global_descriptor(image(rects[i]), binary_mask,
+                                              global_descriptors.data() + static_cast<size_t>(i) * RETRIEVAL_DESCRIPTOR_DIM);
+                    descriptor_valid[i] = 1;
                 }
                 
             } catch (const std::exception& e) {
                 printf("ERROR: Exception processing image %d: %s\n", i, e.what());
-                errors.fetch_add(1);
+                frame_failed(i);
+            }
+        }
+        
+        // pass 2: smoothed per-frame gain/offset through per-channel luts, then encode
+        std::vector<ChannelGains> gains;
+        if (normalize) {
+            gains = solve_photometric_gains(channel_stats, options.photometric_window, options.photometric_max_gain);
+            const bool zero_background = parse_background_mode(options.background) == BackgroundMode::Zero;
+            
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < num_images; ++i) {
+                if (composed[i].empty()) {
+                    continue;  // failed in pass 1, already counted
+                }
+                uint8_t lut[3][256];
+                build_channel_luts(gains[i], lut);
+                apply_channel_luts(composed[i], lut, zero_background);
+                encode_output(i, composed[i]);
+                composed[i].release();
+            }
+        }
+        
+        // single writer: sqlite inserts happen after the parallel section
+        int feature_images = 0;
+        long long feature_count = 0;
+        if (extract_features) {
+            try {
+                feature_images = write_features_database(options.feature_db_path, features, options.single_camera);
+                for (const auto& f : features) {
+                    feature_count += f.valid ? f.num_features() : 0;
+                }
+            } catch (const std::exception& e) {
+                printf("ERROR: Could not write COLMAP database %s: %s\n", options.feature_db_path.c_str(), e.what());
+                feature_images = 0;
+            }
+        }
+        
+        // k-nn pairs over all frames -> colmap match list
+        int num_pairs = 0;
+        if (retrieval) {
+            std::vector<bool> valid(descriptor_valid.begin(), descriptor_valid.end());
+            std::vector<std::string> names(num_images);
+            for (int i = 0; i < num_images; ++i) {
+                names[i] = path_basename(output_paths[i]);
+            }
+            auto pairs = knn_image_pairs(global_descriptors.data(), num_images, RETRIEVAL_DESCRIPTOR_DIM,
+                                         valid, options.retrieval_k, options.retrieval_overlap);
+            write_match_list(options.match_list_path, names, pairs);
+            num_pairs = static_cast<int>(pairs.size());
+        }
+        
+        // the next run compares against what this one left on disk
+        int reused_count = 0;
+        if (use_cache) {
+            reused_count = static_cast<int>(std::count(reused.begin(), reused.end(), 1));
+            try {
+                FrameManifest::write(options.cache_manifest_path, output_paths, cache_entries);
+            } catch (const std::exception& e) {
+                printf("ERROR: Could not write frame manifest %s: %s\n", options.cache_manifest_path.c_str(), e.what());
             }
         }
         
@@ -148,6 +872,16 @@ public:
         results["output_files"] = valid_output_files;
         results["uploaded"] = 0;  // s3 handled in python
         
+        if (write_masks) {
+            std::vector<std::string> valid_mask_files;
+            for (const auto& file : mask_files) {
+                if (!file.empty()) {
+                    valid_mask_files.push_back(file);
+                }
+            }
+            results["mask_files"] = valid_mask_files;
+        }
+        
         // perf metrics for benchmarking
         results["processing_time_ms"] = processing_time_ms;
         results["avg_time_per_image_ms"] = processed.load() > 0 ? 
@@ -158,14 +892,110 @@ public:
         results["throughput_mpix_per_sec"] = mpixels_per_sec;
         results["threads_used"] = max_threads;
         
+        if (extract_features) {
+            results["feature_db"] = options.feature_db_path;
+            results["feature_images"] = feature_images;
+            results["feature_count"] = feature_count;
+        }
+        
+        if (retrieval) {
+            results["match_list"] = options.match_list_path;
+            results["num_pairs"] = num_pairs;
+            // (num_images, dim) float32, rows of failed frames are zero
+            results["global_descriptors"] = py::array_t<float>(
+                {static_cast<ssize_t>(num_images), static_cast<ssize_t>(RETRIEVAL_DESCRIPTOR_DIM)},
+                global_descriptors.data());
+        }
+        
+        if (normalize) {
+            // (num_images, 3) in bgr order, out = gain * in + offset
+            py::array_t<float> gain_array({static_cast<ssize_t>(num_images), static_cast<ssize_t>(3)});
+            py::array_t<float> offset_array({static_cast<ssize_t>(num_images), static_cast<ssize_t>(3)});
+            auto g = gain_array.mutable_unchecked<2>();
+            auto o = offset_array.mutable_unchecked<2>();
+            for (int i = 0; i < num_images; ++i) {
+                for (int c = 0; c < 3; ++c) {
+                    g(i, c) = gains[i].gain[c];
+                    o(i, c) = gains[i].offset[c];
+                }
+            }
+            results["photometric_gains"] = gain_array;
+            results["photometric_offsets"] = offset_array;
+        }
+        
+        if (options.checksum_crc32c || options.checksum_sha256) {
+            // output path -> {"crc32c", "sha256"}, base64 as s3 takes them
+            py::dict checksums;
+            for (int i = 0; i < num_images; ++i) {
+                if (output_files[i].empty()) {
+                    continue;
+                }
+                py::dict frame;
+                if (options.checksum_crc32c) {
+                    frame["crc32c"] = crc32c_values[i];
+                }
+                if (options.checksum_sha256) {
+                    frame["sha256"] = sha256_values[i];
+                }
+                checksums[output_paths[i].c_str()] = frame;
+            }
+            results["checksums"] = checksums;
+        }
+        
+        if (use_cache) {
+            // outputs kept from the last run (already uploaded by it), same order as output_paths
+            std::vector<std::string> reused_files;
+            for (int i = 0; i < num_images; ++i) {
+                if (reused[i]) {
+                    reused_files.push_back(output_paths[i]);
+                }
+            }
+            results["reused"] = reused_count;
+            results["reused_files"] = reused_files;
+            results["cache_manifest"] = options.cache_manifest_path;
+        }
+        
+        if (options.crop) {
+            // (x, y, width, height) per input frame, same order as image_paths
+            py::list crops;
+            for (const auto& r : rects) {
+                crops.append(py::make_tuple(r.x, r.y, r.width, r.height));
+            }
+            results["crops"] = crops;
+            results["output_pixel_ratio"] = total_pixels > 0 ? output_pixels.load() / total_pixels : 0.0;
+            
+            if (!options.crop_json_path.empty()) {
+                write_crop_json(options.crop_json_path, output_paths, rects, bboxes, width, height, options);
+                results["crop_json"] = options.crop_json_path;
+            }
+        }
+        
         printf("c++ OpenMP+SIMD rgba processing results:\n");
         printf("  processed: %d/%d images\n", processed.load(), num_images);
         printf("  errors: %d\n", errors.load());
+        if (options.checksum_crc32c || options.checksum_sha256) {
+            printf("  checksums:%s%s\n", options.checksum_crc32c ? (crc32c_hardware() ? " crc32c (sse4.2)" : " crc32c (software)") : "",
+                   options.checksum_sha256 ? " sha256" : "");
+        }
+        if (use_cache) {
+            printf("  reused: %d unchanged frames (%d recomposed)\n", reused_count, processed.load() - reused_count);
+        }
         printf("  total time: %.2f ms (%.2f ms/image)\n", 
                processing_time_ms, 
                processed.load() > 0 ? processing_time_ms / processed.load() : 0.0);
         printf("  throughput: %.1f MPix/s\n", mpixels_per_sec);
         printf("  threads: %d\n", max_threads);
+        if (extract_features) {
+            printf("  sift features: %lld in %d images -> %s\n",
+                   feature_count, feature_images, options.feature_db_path.c_str());
+        }
+        if (retrieval) {
+            printf("  match list: %d pairs (exhaustive would be %d) -> %s\n",
+                   num_pairs, num_images * (num_images - 1) / 2, options.match_list_path.c_str());
+        }
+        if (options.crop && total_pixels > 0) {
+            printf("  cropped output: %.1f%% of input pixels\n", 100.0 * output_pixels.load() / total_pixels);
+        }
         
         return results;
     }
@@ -176,8 +1006,11 @@ public:
     static bool create_rgba_single(
         const std::string& image_path,
         const py::array_t<uint8_t>& mask,
-        const std::string& output_path
+        const std::string& output_path,
+        const RGBAOptions& options
     ) {
+        validate_options(options);
+        
         try {
             // Load image
             cv::Mat image = cv::imread(image_path, cv::IMREAD_COLOR);
@@ -200,27 +1033,15 @@ public:
                 return false;
             }
             
-            // Convert and process
-            cv::Mat image_rgb;
-            cv::cvtColor(image, image_rgb, cv::COLOR_BGR2RGB);
-            
-            cv::Mat rgba_image(height, width, CV_8UC4);
-            const int total_pixels = height * width;
-            
-            uint8_t* rgba_ptr = rgba_image.ptr<uint8_t>();
-            const uint8_t* rgb_ptr = image_rgb.ptr<uint8_t>();
-            
-            // single-threaded SIMD for one image
-            #pragma omp simd aligned(rgb_ptr, mask_data, rgba_ptr: 32)
-            for (int pixel = 0; pixel < total_pixels; ++pixel) {
-                const int rgb_offset = pixel * 3;
-                const int rgba_offset = pixel * 4;
-                
-                rgba_ptr[rgba_offset + 0] = rgb_ptr[rgb_offset + 0];
-                rgba_ptr[rgba_offset + 1] = rgb_ptr[rgb_offset + 1];
-                rgba_ptr[rgba_offset + 2] = rgb_ptr[rgb_offset + 2];
-                rgba_ptr[rgba_offset + 3] = (mask_data[pixel] > 0) ? 255 : 0;
+            // same fused kernel as the batch path, single-threaded for one image
+            cv::Rect roi(0, 0, width, height);
+            if (options.crop) {
+                RGBAOptions single = options;
+                single.crop_snap = false;
+                roi = compute_crop_rects({mask_bounding_box(mask_data, width, height)}, width, height, single)[0];
             }
+            cv::Mat rgba_image;
+            compose_bgra(image, mask_data, width, height, roi, options, rgba_image);
             
             // Save with PNG compression
             std::vector<int> png_params = {cv::IMWRITE_PNG_COMPRESSION, 6};
@@ -248,6 +1069,7 @@ public:
         #endif
         
         info["hardware_concurrency"] = static_cast<int>(std::thread::hardware_concurrency());
+        info["crc32c_hardware"] = crc32c_hardware();
         
         // check what SIMD support we have
         #ifdef __AVX512F__
@@ -277,19 +1099,83 @@ public:
 PYBIND11_MODULE(torque_cpp, m) {
     m.doc() = "c++ optimizations for torque 3d scanning pipeline using OpenMP + SIMD";
     
+    py::class_<RGBAOptions>(m, "RGBAOptions")
+        .def(py::init<>())
+        .def_readwrite("feather_radius", &RGBAOptions::feather_radius,
+                       "0 = hard alpha, otherwise box-feather radius in pixels (max 64)")
+        .def_readwrite("background", &RGBAOptions::background,
+                       "rgb under alpha == 0: 'keep', 'zero' or 'bleed' (nearest foreground colour)")
+        .def_readwrite("crop", &RGBAOptions::crop,
+                       "write only the padded mask bounding box of each frame")
+        .def_readwrite("crop_padding", &RGBAOptions::crop_padding,
+                       "pixels added around the mask bbox (the feather band is added on top)")
+        .def_readwrite("crop_snap", &RGBAOptions::crop_snap,
+                       "use one crop size for the whole sequence, centred on each frame's bbox")
+        .def_readwrite("crop_json_path", &RGBAOptions::crop_json_path,
+                       "if set, write per-frame crop offsets here for principal point adjustment")
+        .def_readwrite("mask_dir", &RGBAOptions::mask_dir,
+                       "if set, write colmap --ImageReader.mask_path masks (<image>.png, 0/255) here")
+        .def_readwrite("feature_db_path", &RGBAOptions::feature_db_path,
+                       "if set, extract masked sift from the decoded frames into this colmap database.db")
+        .def_readwrite("max_features", &RGBAOptions::max_features,
+                       "sift features per frame (colmap's SiftExtraction.max_num_features)")
+        .def_readwrite("single_camera", &RGBAOptions::single_camera,
+                       "share one SIMPLE_RADIAL camera per frame size in the feature database")
+        .def_readwrite("match_list_path", &RGBAOptions::match_list_path,
+                       "if set, write a colmap match list from global-descriptor k-nn over all frames")
+        .def_readwrite("retrieval_k", &RGBAOptions::retrieval_k,
+                       "most similar frames matched per frame (loop closures)")
+        .def_readwrite("retrieval_overlap", &RGBAOptions::retrieval_overlap,
+                       "sequential neighbours always matched on either side")
+        .def_readwrite("photometric_normalize", &RGBAOptions::photometric_normalize,
+                       "match each frame's masked colour mean/std to the sequence median (holds frames in memory)")
+        .def_readwrite("photometric_window", &RGBAOptions::photometric_window,
+                       "frames on either side used to smooth the per-frame stats")
+        .def_readwrite("photometric_max_gain", &RGBAOptions::photometric_max_gain,
+                       "per-channel gains are clamped to [1 / max_gain, max_gain]")
+        .def_readwrite("cache_manifest_path", &RGBAOptions::cache_manifest_path,
+                       "if set, skip frames whose image, mask and settings match this manifest (ignored with photometric_normalize)")
+        .def_readwrite("checksum_crc32c", &RGBAOptions::checksum_crc32c,
+                       "return each output's crc32c (base64, s3's ChecksumCRC32C) computed from the encoded buffer")
+        .def_readwrite("checksum_sha256", &RGBAOptions::checksum_sha256,
+                       "return each output's sha-256 (base64, s3's ChecksumSHA256) computed from the encoded buffer");
+    
     py::class_<RGBAProcessor>(m, "RGBAProcessor")
         .def_static("batch_create_rgba", &RGBAProcessor::batch_create_rgba_optimized,
-                   "batch rgba processing with OpenMP parallelization and SIMD vectorization")
+                   "batch rgba processing with OpenMP parallelization and SIMD vectorization",
+                   py::arg("image_paths"), py::arg("masks"), py::arg("output_paths"),
+                   py::arg("options") = RGBAOptions())
         .def_static("create_rgba_single", &RGBAProcessor::create_rgba_single,
-                   "single image rgba processing with SIMD optimization")
+                   "single image rgba processing with SIMD optimization",
+                   py::arg("image_path"), py::arg("mask"), py::arg("output_path"),
+                   py::arg("options") = RGBAOptions())
         .def_static("get_info", &RGBAProcessor::get_optimization_info,
                    "get system optimization capabilities and compiler information");
     
     // convenience functions for direct access
     m.def("batch_rgba", &RGBAProcessor::batch_create_rgba_optimized,
-          "high-performance batch rgba processing");
+          "high-performance batch rgba processing",
+          py::arg("image_paths"), py::arg("masks"), py::arg("output_paths"),
+          py::arg("options") = RGBAOptions());
     m.def("single_rgba", &RGBAProcessor::create_rgba_single,
-          "single image rgba processing");
+          "single image rgba processing",
+          py::arg("image_path"), py::arg("mask"), py::arg("output_path"),
+          py::arg("options") = RGBAOptions());
     m.def("optimization_info", &RGBAProcessor::get_optimization_info,
           "system and compiler optimization information");
+    
+    register_image_retrieval(m);
+    register_frame_analysis(m);
+    register_colmap_model(m);
+    register_undistort(m);
+    register_visual_hull(m);
+    register_splat_ply(m);
+    register_splat_compress(m);
+    register_splat_cleanup(m);
+    register_splat_sort(m);
+    register_splat_lod(m);
+    register_splat_render(m);
+    register_progress_watcher(m);
+    register_point_cloud(m);
+    register_splat_mesh(m);
 }
\ No newline at end of file
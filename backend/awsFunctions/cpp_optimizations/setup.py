@@ -68,6 +68,7 @@ def get_opencv_configuration():
         'opencv_core',
         'opencv_imgproc', 
         'opencv_imgcodecs',
+        'opencv_features2d',
     ]
     
     if not include_dirs:
@@ -133,10 +134,29 @@ ext_modules = [
         "torque_cpp",
         [
             "rgba_processor.cpp",  # Use the clean OpenMP implementation
+            "colmap_features.cpp",  # native sift -> colmap database.db
+            "image_retrieval.cpp",  # global descriptors + k-nn match lists
+            "frame_analysis.cpp",  # blur / exposure scoring + frame selection
+            "photometric.cpp",  # cross-frame gain / offset normalization
+            "mapped_file.cpp",  # read-only mmap shared by the binary readers
+            "checksum.cpp",  # xxh64 content keys, crc32c (sse4.2) / sha-256 upload checksums
+            "frame_cache.cpp",  # content-keyed manifest for incremental rgba reruns
+            "colmap_model.cpp",  # sparse model io, numpy views, camera models
+            "undistort.cpp",  # cached remap undistortion to PINHOLE
+            "visual_hull.cpp",  # mask carving: sparse point filter + dense voxel init
+            "splat_ply.cpp",  # gaussian splat ply io as numpy SoA
+            "splat_compress.cpp",  # chunked quantized compressed.ply for the web viewer
+            "splat_cleanup.cpp",  # floater removal against the sam2 masks
+            "splat_sort.cpp",  # morton radix sort, reordered ply + chunk bounds
+            "splat_lod.cpp",  # octree lod levels of moment-matched splats
+            "splat_render.cpp",  # cpu tile rasterizer for thumbnails / previews
+            "progress_watcher.cpp",  # inotify-driven training preview encoder
+            "point_cloud.cpp",  # voxel downsample + kd-tree outlier removal preview
+            "splat_mesh.cpp",  # splat density -> marching cubes -> qem mesh (glb / obj)
         ],
         include_dirs=include_dirs,
         library_dirs=opencv_lib_dirs,
-        libraries=opencv_libs,
+        libraries=opencv_libs + ['sqlite3'],
         language='c++',
         cxx_std=17,
         define_macros=[
@@ -200,7 +220,7 @@ print("""
 To compile on EC2:
 1. Install dependencies:
    sudo apt update
-   sudo apt install build-essential libopencv-dev libomp-dev
+   sudo apt install build-essential libopencv-dev libomp-dev libsqlite3-dev
    pip3 install pybind11 numpy
 
 2. Build extension:
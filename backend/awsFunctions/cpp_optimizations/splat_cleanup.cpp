@@ -0,0 +1,256 @@
+#include "splat_cleanup.h"
+#include "splat_ply.h"
+#include "visual_hull.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// a splat's footprint reaches 3 sigma along its largest axis
+static constexpr double FOOTPRINT_SIGMA = 3.0;
+
+// wider footprints are clipped so one huge splat costs a bounded rect scan
+static constexpr int MAX_FOOTPRINT_PX = 32;
+
+enum SplatVerdict : uint8_t {
+    SPLAT_KEEP = 0,
+    SPLAT_LOW_OPACITY,
+    SPLAT_TOO_SMALL,
+    SPLAT_OUTSIDE_MASKS,
+};
+
+/**
+ * one masked view with its rotation and intrinsics expanded once, instead of
+ * per call as project_point does: the splat loop runs views x splats times
+ */
+struct ViewProjection {
+    const ColmapCamera* camera;
+    const BitMask* mask;
+    double R[9];
+    double t[3];
+    double fx, fy, cx, cy;
+    bool distorted;
+};
+
+static inline bool project_to_view(const ViewProjection& view, const double xyz[3], double& x, double& y, double& depth) {
+    const double* R = view.R;
+    const double xc = R[0] * xyz[0] + R[1] * xyz[1] + R[2] * xyz[2] + view.t[0];
+    const double yc = R[3] * xyz[0] + R[4] * xyz[1] + R[5] * xyz[2] + view.t[1];
+    const double zc = R[6] * xyz[0] + R[7] * xyz[1] + R[8] * xyz[2] + view.t[2];
+    if (zc <= std::numeric_limits<double>::epsilon()) {
+        return false;
+    }
+    double u = xc / zc;
+    double v = yc / zc;
+    if (view.distorted) {
+        double du, dv;
+        camera_distortion(*view.camera, u, v, du, dv);
+        u += du;
+        v += dv;
+    }
+    x = view.fx * u + view.cx;
+    y = view.fy * v + view.cy;
+    depth = zc;
+    return true;
+}
+
+/**
+ * drop floaters from a trained splat: gaussians whose footprint misses the
+ * object mask in more than (1 - min_inside_ratio) of the views that see
+ * their centre, plus ones that are effectively invisible (sigmoid opacity
+ * below min_opacity) or degenerate (largest axis below min_scale_ratio of
+ * the camera orbit radius). splats no masked view sees are kept: there is
+ * no evidence against them
+ *
+ * the splat must live in the model's frame, i.e. sparse_dir is the model
+ * brush trained on and mask_dir holds its frames or masks
+ */
+static py::dict remove_splat_floaters(
+    const std::string& ply_path,
+    const std::string& sparse_dir,
+    const std::string& mask_dir,
+    const std::string& output_path,
+    double min_inside_ratio,
+    double min_opacity,
+    double min_scale_ratio,
+    int margin
+) {
+    if (min_inside_ratio < 0.0 || min_inside_ratio > 1.0) {
+        throw std::invalid_argument("min_inside_ratio must be in [0, 1]");
+    }
+    if (min_opacity < 0.0 || min_opacity >= 1.0) {
+        throw std::invalid_argument("min_opacity must be in [0, 1)");
+    }
+    if (min_scale_ratio < 0.0 || margin < 0) {
+        throw std::invalid_argument("min_scale_ratio and margin must be >= 0");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    SplatCloud cloud = SplatCloud::read(ply_path);
+    const ColmapModel model = ColmapModel::read(sparse_dir);
+    const int num_images = static_cast<int>(model.images.size());
+    const MaskedViews views = load_masked_views(model, mask_dir, margin);
+
+    std::vector<ViewProjection> projections;
+    std::vector<double> centres;
+    for (int i = 0; i < num_images; ++i) {
+        if (!views.cameras[i]) {
+            continue;
+        }
+        ViewProjection view;
+        view.camera = views.cameras[i];
+        view.mask = &views.masks[i];
+        image_rotation(model.images[i], view.R);
+        std::copy_n(model.images[i].tvec, 3, view.t);
+        camera_intrinsics(*view.camera, view.fx, view.fy, view.cx, view.cy);
+        view.distorted = view.camera->model_id != COLMAP_MODEL_SIMPLE_PINHOLE && view.camera->model_id != COLMAP_MODEL_PINHOLE;
+        projections.push_back(view);
+
+        double centre[3];
+        image_center(model.images[i], centre);
+        centres.insert(centres.end(), centre, centre + 3);
+    }
+    const int num_views = static_cast<int>(projections.size());
+
+    // orbit radius: mean camera distance from the cameras' centroid
+    double orbit_radius = 0.0;
+    if (num_views > 0) {
+        double centroid[3] = {0.0, 0.0, 0.0};
+        for (int v = 0; v < num_views; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                centroid[k] += centres[v * 3 + k] / num_views;
+            }
+        }
+        for (int v = 0; v < num_views; ++v) {
+            const double dx = centres[v * 3 + 0] - centroid[0];
+            const double dy = centres[v * 3 + 1] - centroid[1];
+            const double dz = centres[v * 3 + 2] - centroid[2];
+            orbit_radius += std::sqrt(dx * dx + dy * dy + dz * dz) / num_views;
+        }
+    }
+    const double min_scale = min_scale_ratio * orbit_radius;
+
+    auto masks_time = std::chrono::high_resolution_clock::now();
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    std::vector<uint8_t> verdict(n, SPLAT_KEEP);
+    std::vector<uint8_t> unseen(n, 0);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t i = 0; i < n; ++i) {
+        const double opacity = 1.0 / (1.0 + std::exp(-static_cast<double>(cloud.opacities[i])));
+        if (opacity < min_opacity) {
+            verdict[i] = SPLAT_LOW_OPACITY;
+            continue;
+        }
+        const float* log_scale = &cloud.scales[i * 3];
+        const double sigma = std::exp(static_cast<double>(std::max({log_scale[0], log_scale[1], log_scale[2]})));
+        if (sigma < min_scale) {
+            verdict[i] = SPLAT_TOO_SMALL;
+            continue;
+        }
+
+        const double xyz[3] = {cloud.positions[i * 3 + 0], cloud.positions[i * 3 + 1], cloud.positions[i * 3 + 2]};
+        int visible = 0, inside = 0;
+        for (const ViewProjection& view : projections) {
+            double x, y, depth;
+            if (!project_to_view(view, xyz, x, y, depth)) {
+                continue;
+            }
+            // colmap pixel centres sit at +0.5, so floor gives the pixel index
+            const int ix = static_cast<int>(std::floor(x));
+            const int iy = static_cast<int>(std::floor(y));
+            if (ix < 0 || iy < 0 || ix >= view.mask->width || iy >= view.mask->height) {
+                continue;
+            }
+            ++visible;
+            const int radius = static_cast<int>(std::min<double>(MAX_FOOTPRINT_PX, FOOTPRINT_SIGMA * sigma * view.fx / depth));
+            inside += radius < 1 ? view.mask->test(ix, iy) : view.mask->any_in_rect(ix - radius, iy - radius, ix + radius, iy + radius);
+        }
+        if (visible == 0) {
+            unseen[i] = 1;
+        } else if (inside < min_inside_ratio * visible) {
+            verdict[i] = SPLAT_OUTSIDE_MASKS;
+        }
+    }
+
+    std::vector<uint32_t> kept;
+    kept.reserve(n);
+    size_t removed_opacity = 0, removed_small = 0, removed_outside = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        switch (verdict[i]) {
+            case SPLAT_KEEP: kept.push_back(static_cast<uint32_t>(i)); break;
+            case SPLAT_LOW_OPACITY: ++removed_opacity; break;
+            case SPLAT_TOO_SMALL: ++removed_small; break;
+            case SPLAT_OUTSIDE_MASKS: ++removed_outside; break;
+        }
+    }
+    const size_t num_unseen = static_cast<size_t>(std::count(unseen.begin(), unseen.end(), 1));
+
+    const bool write_cloud = !kept.empty() && num_views > 0;
+    const std::string out = output_path.empty() ? ply_path : output_path;
+    if (write_cloud) {
+        const fs::path parent = fs::path(out).parent_path();
+        if (!parent.empty()) {
+            fs::create_directories(parent);
+        }
+        cloud.gather(kept).write(out);
+    } else if (num_views == 0) {
+        printf("ERROR: No usable mask for any image in %s, leaving the splat untouched\n", mask_dir.c_str());
+    } else {
+        printf("ERROR: Every splat would be removed, leaving the splat untouched\n");
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double mask_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(masks_time - start_time).count() / 1000.0;
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+    const size_t splats_after = write_cloud ? kept.size() : cloud.count;
+
+    py::dict results;
+    results["success"] = write_cloud;
+    results["splats_before"] = cloud.count;
+    results["splats_after"] = splats_after;
+    results["removed"] = cloud.count - splats_after;
+    results["removed_outside_masks"] = removed_outside;
+    results["removed_low_opacity"] = removed_opacity;
+    results["removed_small"] = removed_small;
+    results["unseen"] = num_unseen;
+    results["images"] = num_images;
+    results["images_without_mask"] = views.missing;
+    results["output_path"] = write_cloud ? out : std::string();
+    results["mask_time_ms"] = mask_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat floater removal results:\n");
+    printf("  splats: %zu -> %zu (outside masks %zu, low opacity %zu, too small %zu, unseen kept %zu)\n",
+           cloud.count, splats_after, removed_outside, removed_opacity, removed_small, num_unseen);
+    printf("  images without mask: %d/%d\n", views.missing, num_images);
+    printf("  total time: %.2f ms (masks %.2f ms)\n", processing_time_ms, mask_time_ms);
+    return results;
+}
+
+void register_splat_cleanup(py::module_& m) {
+    m.def("remove_splat_floaters", &remove_splat_floaters,
+          "drop splat gaussians outside the object masks, near-transparent or degenerate; writes the cleaned ply",
+          py::arg("ply_path"), py::arg("sparse_dir"), py::arg("mask_dir"), py::arg("output_path") = "",
+          py::arg("min_inside_ratio") = 0.5, py::arg("min_opacity") = 1.0 / 255.0,
+          py::arg("min_scale_ratio") = 1e-4, py::arg("margin") = 2);
+}
@@ -0,0 +1,505 @@
+#include "splat_compress.h"
+#include "splat_sort.h"
+
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// degree-0 sh basis, f_dc -> colour is 0.5 + SH_C0 * f_dc
+static constexpr float SH_C0 = 0.28209479177387814f;
+
+// log scales beyond this are degenerate splats; clamping keeps chunk ranges tight
+static constexpr float MAX_LOG_SCALE = 20.0f;
+
+// 8-bit sh coefficients cover [-SH_RANGE / 2, SH_RANGE / 2]
+static constexpr float SH_RANGE = 8.0f;
+
+// chunk record: min/max position, min/max log scale, min/max colour
+static constexpr int CHUNK_FLOATS = 18;
+
+// degree-4 input is cut to 3: 45 rest coefficients per splat at most
+static constexpr int MAX_COMPRESSED_SH_DEGREE = 3;
+static constexpr int MAX_SH_DIMS = 3 * ((MAX_COMPRESSED_SH_DEGREE + 1) * (MAX_COMPRESSED_SH_DEGREE + 1) - 1);
+
+static constexpr int MAX_SH_PALETTE = 1 << 16;
+static constexpr int KMEANS_ITERATIONS = 8;
+static constexpr int KMEANS_MAX_COARSE = 64;
+static constexpr size_t KMEANS_MIN_SAMPLES = 1 << 16;
+static constexpr size_t KMEANS_MAX_SAMPLES = 1 << 18;
+
+static inline uint32_t pack_unorm(float value, int bits) {
+    const float t = static_cast<float>((1u << bits) - 1);
+    const float v = std::floor(value * t + 0.5f);
+    // written so nan lands on 0
+    if (!(v > 0.0f)) {
+        return 0;
+    }
+    return v >= t ? static_cast<uint32_t>(t) : static_cast<uint32_t>(v);
+}
+
+static inline float normalize_range(float value, float lo, float hi) {
+    return hi > lo ? (value - lo) / (hi - lo) : 0.0f;
+}
+
+static inline uint32_t pack_111011(float x, float y, float z) {
+    return (pack_unorm(x, 11) << 21) | (pack_unorm(y, 10) << 11) | pack_unorm(z, 11);
+}
+
+static inline uint32_t pack_8888(float r, float g, float b, float a) {
+    return (pack_unorm(r, 8) << 24) | (pack_unorm(g, 8) << 16) | (pack_unorm(b, 8) << 8) | pack_unorm(a, 8);
+}
+
+/**
+ * smallest three: drop the largest component (its index in the top two bits),
+ * flip the sign so it is positive and store the other three, which then lie
+ * in [-1/sqrt2, 1/sqrt2], at 10 bits each. q is w x y z as in the ply
+ */
+static inline uint32_t pack_rotation(const float* q) {
+    float a[4] = {q[0], q[1], q[2], q[3]};
+    const float length = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3]);
+    const float inv = length > 0.0f ? 1.0f / length : 0.0f;
+    int largest = 0;
+    for (int k = 0; k < 4; ++k) {
+        a[k] *= inv;
+        if (std::fabs(a[k]) > std::fabs(a[largest])) {
+            largest = k;
+        }
+    }
+    const float sign = a[largest] < 0.0f ? -1.0f : 1.0f;
+    const float norm = 0.70710678f;
+    uint32_t packed = static_cast<uint32_t>(largest);
+    for (int k = 0; k < 4; ++k) {
+        if (k != largest) {
+            packed = (packed << 10) | pack_unorm(sign * a[k] * norm + 0.5f, 10);
+        }
+    }
+    return packed;
+}
+
+/**
+ * the first `rest` coefficients per channel of splat i, channel-major
+ */
+static inline void load_sh_row(const SplatCloud& cloud, size_t i, int rest, float* out) {
+    const int source_rest = cloud.sh_rest_count();
+    const float* src = cloud.sh_rest.data() + i * 3 * source_rest;
+    for (int c = 0; c < 3; ++c) {
+        std::memcpy(out + c * rest, src + c * source_rest, rest * sizeof(float));
+    }
+}
+
+/**
+ * centroids are passed dimension-major (d * k + c) so the distance loop runs
+ * across centroids in simd lanes instead of reducing 9-45 dims per centroid
+ */
+static inline int nearest_centroid(const float* row, const float* centroids_t, int k, int dims, float* distance) {
+    std::fill_n(distance, k, 0.0f);
+    for (int d = 0; d < dims; ++d) {
+        const float value = row[d];
+        const float* column = centroids_t + static_cast<size_t>(d) * k;
+        #pragma omp simd
+        for (int c = 0; c < k; ++c) {
+            const float diff = value - column[c];
+            distance[c] += diff * diff;
+        }
+    }
+    return static_cast<int>(std::min_element(distance, distance + k) - distance);
+}
+
+static std::vector<float> transpose_rows(const float* rows, int k, int dims) {
+    std::vector<float> columns(static_cast<size_t>(k) * dims);
+    for (int c = 0; c < k; ++c) {
+        for (int d = 0; d < dims; ++d) {
+            columns[static_cast<size_t>(d) * k + c] = rows[static_cast<size_t>(c) * dims + d];
+        }
+    }
+    return columns;
+}
+
+/**
+ * lloyd iterations over n rows, seeded with evenly spaced rows; clusters that
+ * empty out keep their previous centroid. the assignment loop is parallel at
+ * the top level and runs serially when called from inside a parallel region
+ */
+static std::vector<float> kmeans(const float* data, size_t n, int dims, int k, std::vector<int>& labels) {
+    std::vector<float> centroids(static_cast<size_t>(k) * dims);
+    for (int c = 0; c < k; ++c) {
+        const size_t row = static_cast<size_t>(c) * n / k;
+        std::copy_n(data + row * dims, dims, centroids.data() + static_cast<size_t>(c) * dims);
+    }
+
+    labels.assign(n, 0);
+    std::vector<double> sums(static_cast<size_t>(k) * dims);
+    std::vector<size_t> counts(k);
+    for (int iteration = 0; iteration < KMEANS_ITERATIONS; ++iteration) {
+        const std::vector<float> centroids_t = transpose_rows(centroids.data(), k, dims);
+        #pragma omp parallel
+        {
+            std::vector<float> distance(k);
+            #pragma omp for schedule(static)
+            for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+                labels[i] = nearest_centroid(data + i * dims, centroids_t.data(), k, dims, distance.data());
+            }
+        }
+
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t i = 0; i < n; ++i) {
+            double* sum = sums.data() + static_cast<size_t>(labels[i]) * dims;
+            for (int d = 0; d < dims; ++d) {
+                sum[d] += data[i * dims + d];
+            }
+            ++counts[labels[i]];
+        }
+        for (int c = 0; c < k; ++c) {
+            if (counts[c] == 0) {
+                continue;
+            }
+            for (int d = 0; d < dims; ++d) {
+                centroids[static_cast<size_t>(c) * dims + d] = static_cast<float>(sums[static_cast<size_t>(c) * dims + d] / counts[c]);
+            }
+        }
+    }
+    return centroids;
+}
+
+/**
+ * sh palette by two-level k-means: up to 64 coarse clusters trained on a
+ * sample of the splats, each split again in proportion to its share of the
+ * sample. assigning a splat then costs ~64 + K / 64 distance evaluations
+ * instead of K, which is what keeps a 4096-entry palette over millions of
+ * splats to a few seconds
+ */
+struct ShPalette {
+    std::vector<float> entries;    // size x dims
+    std::vector<uint16_t> labels;  // per splat, input order
+    int size = 0;
+};
+
+static ShPalette build_sh_palette(const SplatCloud& cloud, int rest, int palette_size) {
+    const int dims = 3 * rest;
+    const size_t n = cloud.count;
+    ShPalette palette;
+    palette.labels.assign(n, 0);
+    if (n == 0) {
+        return palette;
+    }
+
+    // strided sample so the training set spans the whole capture
+    const size_t num_samples = std::min(n, std::clamp(static_cast<size_t>(palette_size) * 16, KMEANS_MIN_SAMPLES, KMEANS_MAX_SAMPLES));
+    std::vector<float> samples(num_samples * dims);
+    #pragma omp parallel for schedule(static)
+    for (int64_t s = 0; s < static_cast<int64_t>(num_samples); ++s) {
+        load_sh_row(cloud, static_cast<size_t>(s) * n / num_samples, rest, samples.data() + s * dims);
+    }
+
+    const int target = static_cast<int>(std::min(static_cast<size_t>(palette_size), num_samples));
+    const int coarse_k = std::max(1, std::min(KMEANS_MAX_COARSE, static_cast<int>(std::sqrt(static_cast<double>(target)))));
+    std::vector<int> coarse_labels;
+    const std::vector<float> coarse = kmeans(samples.data(), num_samples, dims, coarse_k, coarse_labels);
+
+    // members of each coarse cluster, then their share of the palette
+    std::vector<std::vector<float>> members(coarse_k);
+    for (size_t s = 0; s < num_samples; ++s) {
+        std::vector<float>& rows = members[coarse_labels[s]];
+        rows.insert(rows.end(), samples.begin() + s * dims, samples.begin() + (s + 1) * dims);
+    }
+    std::vector<int> fine_k(coarse_k);
+    std::vector<int> fine_offset(coarse_k + 1, 0);
+    for (int c = 0; c < coarse_k; ++c) {
+        const size_t count = members[c].size() / dims;
+        const size_t share = static_cast<size_t>(target - coarse_k) * count / num_samples;
+        fine_k[c] = count == 0 ? 0 : static_cast<int>(std::min(count, std::max<size_t>(1, share)));
+        fine_offset[c + 1] = fine_offset[c] + fine_k[c];
+    }
+    palette.size = fine_offset[coarse_k];
+    palette.entries.assign(static_cast<size_t>(palette.size) * dims, 0.0f);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < coarse_k; ++c) {
+        if (fine_k[c] == 0) {
+            continue;
+        }
+        std::vector<int> labels;
+        const std::vector<float> fine = kmeans(members[c].data(), members[c].size() / dims, dims, fine_k[c], labels);
+        std::copy(fine.begin(), fine.end(), palette.entries.begin() + static_cast<size_t>(fine_offset[c]) * dims);
+    }
+
+    // coarse clusters that caught no samples can't own a splat
+    std::vector<float> live_coarse;
+    std::vector<int> live_index;
+    for (int c = 0; c < coarse_k; ++c) {
+        if (fine_k[c] > 0) {
+            live_coarse.insert(live_coarse.end(), coarse.begin() + static_cast<size_t>(c) * dims, coarse.begin() + static_cast<size_t>(c + 1) * dims);
+            live_index.push_back(c);
+        }
+    }
+    const int num_live = static_cast<int>(live_index.size());
+    const std::vector<float> live_t = transpose_rows(live_coarse.data(), num_live, dims);
+    std::vector<std::vector<float>> fine_t(coarse_k);
+    for (int c = 0; c < coarse_k; ++c) {
+        fine_t[c] = transpose_rows(palette.entries.data() + static_cast<size_t>(fine_offset[c]) * dims, fine_k[c], dims);
+    }
+
+    #pragma omp parallel
+    {
+        std::vector<float> distance(std::max(num_live, *std::max_element(fine_k.begin(), fine_k.end())));
+        float row[MAX_SH_DIMS];
+        #pragma omp for schedule(static)
+        for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+            load_sh_row(cloud, static_cast<size_t>(i), rest, row);
+            const int c = live_index[nearest_centroid(row, live_t.data(), num_live, dims, distance.data())];
+            palette.labels[i] = static_cast<uint16_t>(fine_offset[c] + nearest_centroid(row, fine_t[c].data(), fine_k[c], dims, distance.data()));
+        }
+    }
+    return palette;
+}
+
+static inline uint8_t quantize_sh(float value) {
+    return static_cast<uint8_t>(pack_unorm(value / SH_RANGE + 0.5f, 8));
+}
+
+CompressedSplatStats write_compressed_ply(const SplatCloud& cloud, const std::string& path, int sh_degree, int sh_palette_size) {
+    if (sh_degree < -1 || sh_degree > 3) {
+        throw std::invalid_argument("sh_degree must be -1 (keep) or 0-3");
+    }
+    if (sh_palette_size < 0 || sh_palette_size > MAX_SH_PALETTE) {
+        throw std::invalid_argument("sh_palette_size must be between 0 and 65536");
+    }
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    const size_t n = cloud.count;
+    const int degree = std::min(sh_degree < 0 ? cloud.sh_degree : sh_degree, std::min(cloud.sh_degree, MAX_COMPRESSED_SH_DEGREE));
+    const int rest = (degree + 1) * (degree + 1) - 1;
+    const int sh_dims = 3 * rest;
+    const bool use_palette = sh_palette_size > 0 && sh_dims > 0;
+    const size_t num_chunks = (n + SPLAT_CHUNK_SIZE - 1) / SPLAT_CHUNK_SIZE;
+
+    const std::vector<uint32_t> order = morton_order(cloud);
+
+    ShPalette palette;
+    if (use_palette) {
+        palette = build_sh_palette(cloud, rest, sh_palette_size);
+    }
+
+    std::vector<float> chunks(num_chunks * CHUNK_FLOATS);
+    std::vector<uint32_t> packed(n * 4);
+    std::vector<uint8_t> sh_bytes(use_palette ? 0 : n * sh_dims);
+    std::vector<uint16_t> sh_index(use_palette ? n : 0);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t chunk = 0; chunk < static_cast<int64_t>(num_chunks); ++chunk) {
+        const size_t start = static_cast<size_t>(chunk) * SPLAT_CHUNK_SIZE;
+        const int size = static_cast<int>(std::min(SPLAT_CHUNK_SIZE, n - start));
+
+        // gather the chunk into local planes so the range and pack loops vectorize
+        float px[SPLAT_CHUNK_SIZE], py[SPLAT_CHUNK_SIZE], pz[SPLAT_CHUNK_SIZE];
+        float sx[SPLAT_CHUNK_SIZE], sy[SPLAT_CHUNK_SIZE], sz[SPLAT_CHUNK_SIZE];
+        float cr[SPLAT_CHUNK_SIZE], cg[SPLAT_CHUNK_SIZE], cb[SPLAT_CHUNK_SIZE], ca[SPLAT_CHUNK_SIZE];
+        for (int j = 0; j < size; ++j) {
+            const size_t i = order[start + j];
+            px[j] = cloud.positions[i * 3 + 0];
+            py[j] = cloud.positions[i * 3 + 1];
+            pz[j] = cloud.positions[i * 3 + 2];
+            sx[j] = std::clamp(cloud.scales[i * 3 + 0], -MAX_LOG_SCALE, MAX_LOG_SCALE);
+            sy[j] = std::clamp(cloud.scales[i * 3 + 1], -MAX_LOG_SCALE, MAX_LOG_SCALE);
+            sz[j] = std::clamp(cloud.scales[i * 3 + 2], -MAX_LOG_SCALE, MAX_LOG_SCALE);
+            cr[j] = 0.5f + SH_C0 * cloud.sh_dc[i * 3 + 0];
+            cg[j] = 0.5f + SH_C0 * cloud.sh_dc[i * 3 + 1];
+            cb[j] = 0.5f + SH_C0 * cloud.sh_dc[i * 3 + 2];
+            ca[j] = 1.0f / (1.0f + std::exp(-cloud.opacities[i]));
+        }
+
+        float* bounds = chunks.data() + chunk * CHUNK_FLOATS;
+        const float* planes[9] = {px, py, pz, sx, sy, sz, cr, cg, cb};
+        for (int a = 0; a < 9; ++a) {
+            const float* plane = planes[a];
+            float lo = std::numeric_limits<float>::max();
+            float hi = std::numeric_limits<float>::lowest();
+            #pragma omp simd reduction(min:lo) reduction(max:hi)
+            for (int j = 0; j < size; ++j) {
+                lo = std::min(lo, plane[j]);
+                hi = std::max(hi, plane[j]);
+            }
+            // layout: min xyz, max xyz, min scale, max scale, min rgb, max rgb
+            bounds[(a / 3) * 6 + a % 3] = lo;
+            bounds[(a / 3) * 6 + 3 + a % 3] = hi;
+        }
+
+        uint32_t* out = packed.data() + start * 4;
+        #pragma omp simd
+        for (int j = 0; j < size; ++j) {
+            out[j * 4 + 0] = pack_111011(normalize_range(px[j], bounds[0], bounds[3]),
+                                         normalize_range(py[j], bounds[1], bounds[4]),
+                                         normalize_range(pz[j], bounds[2], bounds[5]));
+            out[j * 4 + 2] = pack_111011(normalize_range(sx[j], bounds[6], bounds[9]),
+                                         normalize_range(sy[j], bounds[7], bounds[10]),
+                                         normalize_range(sz[j], bounds[8], bounds[11]));
+            out[j * 4 + 3] = pack_8888(normalize_range(cr[j], bounds[12], bounds[15]),
+                                       normalize_range(cg[j], bounds[13], bounds[16]),
+                                       normalize_range(cb[j], bounds[14], bounds[17]), ca[j]);
+        }
+        for (int j = 0; j < size; ++j) {
+            out[j * 4 + 1] = pack_rotation(&cloud.rotations[static_cast<size_t>(order[start + j]) * 4]);
+        }
+
+        if (use_palette) {
+            for (int j = 0; j < size; ++j) {
+                sh_index[start + j] = palette.labels[order[start + j]];
+            }
+        } else if (sh_dims > 0) {
+            for (int j = 0; j < size; ++j) {
+                float row[MAX_SH_DIMS];
+                load_sh_row(cloud, order[start + j], rest, row);
+                uint8_t* dst = sh_bytes.data() + (start + j) * sh_dims;
+                #pragma omp simd
+                for (int d = 0; d < sh_dims; ++d) {
+                    dst[d] = quantize_sh(row[d]);
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> palette_bytes(use_palette ? static_cast<size_t>(palette.size) * sh_dims : 0);
+    for (size_t k = 0; k < palette_bytes.size(); ++k) {
+        palette_bytes[k] = quantize_sh(palette.entries[k]);
+    }
+
+    std::ostringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n";
+    header << "element chunk " << num_chunks << "\n";
+    for (const char* name : {"min_x", "min_y", "min_z", "max_x", "max_y", "max_z",
+                             "min_scale_x", "min_scale_y", "min_scale_z", "max_scale_x", "max_scale_y", "max_scale_z",
+                             "min_r", "min_g", "min_b", "max_r", "max_g", "max_b"}) {
+        header << "property float " << name << "\n";
+    }
+    header << "element vertex " << n << "\n";
+    for (const char* name : {"packed_position", "packed_rotation", "packed_scale", "packed_color"}) {
+        header << "property uint " << name << "\n";
+    }
+    // palette elements come last so readers that only know the standard layout still get dc colour
+    if (!use_palette && sh_dims > 0) {
+        header << "element sh " << n << "\n";
+    } else if (use_palette) {
+        header << "element sh_palette " << palette.size << "\n";
+    }
+    for (int k = 0; k < sh_dims; ++k) {
+        header << "property uchar f_rest_" << k << "\n";
+    }
+    if (use_palette) {
+        header << "element sh_index " << n << "\n";
+        header << "property ushort palette_index\n";
+    }
+    header << "end_header\n";
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    const std::string header_text = header.str();
+    out.write(header_text.data(), header_text.size());
+    out.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(sh_bytes.data()), sh_bytes.size());
+    out.write(reinterpret_cast<const char*>(palette_bytes.data()), palette_bytes.size());
+    out.write(reinterpret_cast<const char*>(sh_index.data()), sh_index.size() * sizeof(uint16_t));
+    const std::streamoff written = out.tellp();
+    // close here so a failed flush throws instead of passing silently
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+
+    CompressedSplatStats stats;
+    stats.chunks = num_chunks;
+    stats.sh_degree = degree;
+    stats.sh_palette_size = use_palette ? palette.size : 0;
+    stats.bytes = static_cast<size_t>(written);
+    return stats;
+}
+
+static py::dict compress_results(const CompressedSplatStats& stats, size_t splats, size_t input_bytes,
+                                 const std::string& output_path, double processing_time_ms) {
+    const double ratio = stats.bytes > 0 ? static_cast<double>(input_bytes) / stats.bytes : 0.0;
+
+    py::dict results;
+    results["splats"] = splats;
+    results["chunks"] = stats.chunks;
+    results["sh_degree"] = stats.sh_degree;
+    results["sh_palette_size"] = stats.sh_palette_size;
+    results["input_bytes"] = input_bytes;
+    results["output_bytes"] = stats.bytes;
+    results["compression_ratio"] = ratio;
+    results["output_path"] = output_path;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat compression results:\n");
+    printf("  splats: %zu in %zu chunks, sh degree %d", splats, stats.chunks, stats.sh_degree);
+    if (stats.sh_palette_size > 0) {
+        printf(" (palette of %d)", stats.sh_palette_size);
+    }
+    printf("\n  size: %.2f MB -> %.2f MB (%.1fx)\n", input_bytes / 1e6, stats.bytes / 1e6, ratio);
+    printf("  total time: %.2f ms\n", processing_time_ms);
+    return results;
+}
+
+/**
+ * raw float32 ply size of a cloud, the baseline the ratio is reported against
+ */
+static size_t raw_ply_bytes(const SplatCloud& cloud) {
+    return cloud.count * (3 + 3 + 3 * cloud.sh_rest_count() + 1 + 3 + 4) * sizeof(float);
+}
+
+static py::dict compress_splat_ply(const std::string& input_path, const std::string& output_path, int sh_degree, int sh_palette_size) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CompressedSplatStats stats;
+    SplatCloud cloud;
+    {
+        py::gil_scoped_release release;
+        cloud = SplatCloud::read(input_path);
+        stats = write_compressed_ply(cloud, output_path, sh_degree, sh_palette_size);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+    return compress_results(stats, cloud.count, fs::file_size(input_path), output_path, processing_time_ms);
+}
+
+static py::dict compress_splats(const SplatCloud& cloud, const std::string& output_path, int sh_degree, int sh_palette_size) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CompressedSplatStats stats;
+    {
+        py::gil_scoped_release release;
+        stats = write_compressed_ply(cloud, output_path, sh_degree, sh_palette_size);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+    return compress_results(stats, cloud.count, raw_ply_bytes(cloud), output_path, processing_time_ms);
+}
+
+void register_splat_compress(py::module_& m) {
+    m.def("compress_splat_ply", &compress_splat_ply,
+          "convert a splat ply to the chunked, quantized compressed.ply web format",
+          py::arg("input_path"), py::arg("output_path"), py::arg("sh_degree") = -1, py::arg("sh_palette_size") = 0);
+    m.def("compress_splats", &compress_splats,
+          "write a SplatCloud as compressed.ply",
+          py::arg("cloud"), py::arg("output_path"), py::arg("sh_degree") = -1, py::arg("sh_palette_size") = 0);
+}
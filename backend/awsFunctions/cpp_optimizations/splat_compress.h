@@ -0,0 +1,36 @@
+#pragma once
+
+#include "splat_ply.h"
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * chunked, quantized splat ply for web delivery, the "compressed.ply" layout
+ * supersplat / playcanvas load. splats are morton-ordered and cut into chunks
+ * of 256; each chunk stores its position, log-scale and colour bounds and
+ * every splat packs into four uint32 relative to them:
+ *   position 11-10-11, log scale 11-10-11, rotation smallest-three (2 + 3 x 10),
+ *   colour + sigmoid opacity rgba8
+ * higher-order sh is 8 bits per coefficient (optionally truncated to a lower
+ * degree), or a shared k-means palette plus one uint16 index per splat
+ */
+static constexpr size_t SPLAT_CHUNK_SIZE = 256;
+
+struct CompressedSplatStats {
+    size_t chunks = 0;
+    int sh_degree = 0;
+    int sh_palette_size = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * sh_degree: keep at most this degree (-1 keeps the cloud's, capped at 3)
+ * sh_palette_size: > 0 stores sh as a palette of that many entries (<= 65536)
+ */
+CompressedSplatStats write_compressed_ply(const SplatCloud& cloud, const std::string& path, int sh_degree, int sh_palette_size);
+
+void register_splat_compress(pybind11::module_& m);
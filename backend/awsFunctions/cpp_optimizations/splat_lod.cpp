@@ -0,0 +1,376 @@
+#include "splat_lod.h"
+#include "splat_compress.h"
+#include "splat_ply.h"
+#include "splat_sort.h"
+
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// merged opacity stays inside the logit's finite range
+static constexpr double MIN_LOD_OPACITY = 1e-4;
+static constexpr double MAX_LOD_OPACITY = 0.9999;
+
+// keeps zero-opacity splats from producing an empty (0-weight) node
+static constexpr double MIN_MERGE_WEIGHT = 1e-12;
+
+/**
+ * one level of the hierarchy: splats in morton order, each the merge of the
+ * finer splats in one octree cell
+ */
+struct LodLevel {
+    SplatCloud cloud;
+    std::vector<double> weights;  // merge weight: opacity x footprint area
+    std::vector<uint64_t> codes;  // morton code of the cell's first leaf
+    int depth = MORTON_AXIS_BITS;
+};
+
+static inline void matrix_to_quaternion(const double R[9], float* q) {
+    const double trace = R[0] + R[4] + R[8];
+    double w, x, y, z;
+    if (trace > 0.0) {
+        const double s = std::sqrt(trace + 1.0) * 2.0;
+        w = s / 4; x = (R[7] - R[5]) / s; y = (R[2] - R[6]) / s; z = (R[3] - R[1]) / s;
+    } else if (R[0] > R[4] && R[0] > R[8]) {
+        const double s = std::sqrt(1.0 + R[0] - R[4] - R[8]) * 2.0;
+        w = (R[7] - R[5]) / s; x = s / 4; y = (R[1] + R[3]) / s; z = (R[2] + R[6]) / s;
+    } else if (R[4] > R[8]) {
+        const double s = std::sqrt(1.0 + R[4] - R[0] - R[8]) * 2.0;
+        w = (R[2] - R[6]) / s; x = (R[1] + R[3]) / s; y = s / 4; z = (R[5] + R[7]) / s;
+    } else {
+        const double s = std::sqrt(1.0 + R[8] - R[0] - R[4]) * 2.0;
+        w = (R[3] - R[1]) / s; x = (R[2] + R[6]) / s; y = (R[5] + R[7]) / s; z = s / 4;
+    }
+    q[0] = static_cast<float>(w);
+    q[1] = static_cast<float>(x);
+    q[2] = static_cast<float>(y);
+    q[3] = static_cast<float>(z);
+}
+
+/**
+ * cyclic jacobi on a symmetric 3x3: eigenvalues plus eigenvectors as the
+ * columns of a row-major matrix. converges in a handful of sweeps
+ */
+static void symmetric_eigen3(const double cov[6], double values[3], double vectors[9]) {
+    double a[3][3] = {{cov[0], cov[1], cov[2]}, {cov[1], cov[3], cov[4]}, {cov[2], cov[4], cov[5]}};
+    double v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    static const int PAIRS[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+    for (int sweep = 0; sweep < 16; ++sweep) {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        const double diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off <= 1e-30 * diag) {
+            break;
+        }
+        for (const auto& pair : PAIRS) {
+            const int p = pair[0], q = pair[1];
+            if (a[p][q] == 0.0) {
+                continue;
+            }
+            const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+            const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+            const double c = 1.0 / std::sqrt(t * t + 1.0);
+            const double s = t * c;
+            for (int k = 0; k < 3; ++k) {
+                const double kp = a[k][p], kq = a[k][q];
+                a[k][p] = c * kp - s * kq;
+                a[k][q] = s * kp + c * kq;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const double pk = a[p][k], qk = a[q][k];
+                a[p][k] = c * pk - s * qk;
+                a[q][k] = s * pk + c * qk;
+            }
+            for (int k = 0; k < 3; ++k) {
+                const double kp = v[k][p], kq = v[k][q];
+                v[k][p] = c * kp - s * kq;
+                v[k][q] = s * kp + c * kq;
+            }
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        values[k] = a[k][k];
+        for (int j = 0; j < 3; ++j) {
+            vectors[k * 3 + j] = v[k][j];
+        }
+    }
+}
+
+/**
+ * covariance -> log scales + w x y z rotation, returns the footprint area
+ * (product of the two largest axes) the opacity is spread over
+ */
+static double covariance_to_splat(const double cov[6], float* log_scale, float* rotation) {
+    double values[3], R[9];
+    symmetric_eigen3(cov, values, R);
+    // eigenvectors may come out as a reflection
+    const double det = R[0] * (R[4] * R[8] - R[5] * R[7]) - R[1] * (R[3] * R[8] - R[5] * R[6]) + R[2] * (R[3] * R[7] - R[4] * R[6]);
+    if (det < 0.0) {
+        R[2] = -R[2];
+        R[5] = -R[5];
+        R[8] = -R[8];
+    }
+    matrix_to_quaternion(R, rotation);
+
+    double sigma[3];
+    for (int k = 0; k < 3; ++k) {
+        sigma[k] = std::sqrt(std::max(values[k], 1e-20));
+        log_scale[k] = static_cast<float>(std::log(sigma[k]));
+    }
+    std::sort(sigma, sigma + 3);
+    return sigma[1] * sigma[2];
+}
+
+static inline double splat_weight(float opacity_logit, const float* log_scale) {
+    const double opacity = 1.0 / (1.0 + std::exp(-static_cast<double>(opacity_logit)));
+    float sorted[3] = {log_scale[0], log_scale[1], log_scale[2]};
+    std::sort(sorted, sorted + 3);
+    return opacity * std::exp(static_cast<double>(sorted[1]) + sorted[2]) + MIN_MERGE_WEIGHT;
+}
+
+/**
+ * the finer level's splats grouped by depth-`depth` octree cell (contiguous
+ * in morton order) and moment-matched into one gaussian per cell: weighted
+ * mean, covariance of the mixture (each splat's own plus the spread of the
+ * means), weighted colour and sh. opacity is the summed weight over the
+ * merged footprint, so covered area is conserved. running merges use the
+ * pairwise (chan) update so far-from-origin scenes don't lose precision
+ */
+static LodLevel merge_level(const LodLevel& fine, int depth) {
+    const size_t n = fine.cloud.count;
+    const int shift = 3 * (MORTON_AXIS_BITS - depth);
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || (fine.codes[i] >> shift) != (fine.codes[i - 1] >> shift)) {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(n);
+    const int64_t num_nodes = static_cast<int64_t>(starts.size()) - 1;
+
+    LodLevel coarse;
+    coarse.depth = depth;
+    coarse.cloud.resize(num_nodes, fine.cloud.sh_degree);
+    coarse.weights.resize(num_nodes);
+    coarse.codes.resize(num_nodes);
+    const int rest = 3 * fine.cloud.sh_rest_count();
+    const SplatCloud& src = fine.cloud;
+    SplatCloud& dst = coarse.cloud;
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int64_t node = 0; node < num_nodes; ++node) {
+        const size_t begin = starts[node], end = starts[node + 1];
+        coarse.codes[node] = fine.codes[begin];
+
+        double weight = 0.0, mean[3] = {0, 0, 0}, cov[6] = {0, 0, 0, 0, 0, 0}, dc[3] = {0, 0, 0};
+        float* rest_out = dst.sh_rest.data() + node * rest;
+        std::fill_n(rest_out, rest, 0.0f);
+        for (size_t i = begin; i < end; ++i) {
+            const double w = fine.weights[i];
+            const double total = weight + w;
+            const double a = w / total;
+            double splat_cov[6];
+            splat_covariance(&src.rotations[i * 4], &src.scales[i * 3], splat_cov);
+            double delta[3];
+            for (int k = 0; k < 3; ++k) {
+                delta[k] = src.positions[i * 3 + k] - mean[k];
+                mean[k] += a * delta[k];
+                dc[k] += a * (src.sh_dc[i * 3 + k] - dc[k]);
+            }
+            const double spread[6] = {delta[0] * delta[0], delta[0] * delta[1], delta[0] * delta[2],
+                                      delta[1] * delta[1], delta[1] * delta[2], delta[2] * delta[2]};
+            for (int e = 0; e < 6; ++e) {
+                cov[e] = (1.0 - a) * cov[e] + a * splat_cov[e] + a * (1.0 - a) * spread[e];
+            }
+            const float* rest_in = src.sh_rest.data() + i * rest;
+            const float fa = static_cast<float>(a);
+            #pragma omp simd
+            for (int k = 0; k < rest; ++k) {
+                rest_out[k] += fa * (rest_in[k] - rest_out[k]);
+            }
+            weight = total;
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            dst.positions[node * 3 + k] = static_cast<float>(mean[k]);
+            dst.sh_dc[node * 3 + k] = static_cast<float>(dc[k]);
+        }
+        const double area = covariance_to_splat(cov, &dst.scales[node * 3], &dst.rotations[node * 4]);
+        const double opacity = std::clamp(weight / area, MIN_LOD_OPACITY, MAX_LOD_OPACITY);
+        dst.opacities[node] = static_cast<float>(std::log(opacity / (1.0 - opacity)));
+        coarse.weights[node] = weight;
+    }
+    return coarse;
+}
+
+/**
+ * octree depths to emit, coarse first: each level about level_ratio times
+ * smaller than the next finer one, stopping at min_splats. the count of
+ * cells at every depth comes from one pass over adjacent sorted codes: two
+ * neighbours first separate at the depth of their highest differing bit
+ */
+static std::vector<int> choose_depths(const std::vector<uint64_t>& codes, size_t min_splats, double level_ratio) {
+    std::vector<size_t> splits(MORTON_AXIS_BITS + 1, 0);
+    for (size_t i = 1; i < codes.size(); ++i) {
+        const uint64_t diff = codes[i] ^ codes[i - 1];
+        if (diff != 0) {
+            const int msb = 63 - __builtin_clzll(diff);
+            ++splits[MORTON_AXIS_BITS - msb / 3];
+        }
+    }
+    std::vector<size_t> cells(MORTON_AXIS_BITS + 1);
+    size_t running = codes.empty() ? 0 : 1;
+    for (int d = 0; d <= MORTON_AXIS_BITS; ++d) {
+        running += splits[d];
+        cells[d] = running;
+    }
+
+    std::vector<int> depths;
+    size_t count = codes.size();
+    int depth = MORTON_AXIS_BITS + 1;
+    while (count > min_splats && depth > 0) {
+        const double target = count / level_ratio;
+        int next = depth - 1;
+        while (next > 0 && static_cast<double>(cells[next]) > target) {
+            --next;
+        }
+        depth = next;
+        count = cells[depth];
+        depths.push_back(depth);
+    }
+    std::reverse(depths.begin(), depths.end());
+    return depths;
+}
+
+/**
+ * level-of-detail hierarchy for progressive streaming. the splat is sorted
+ * by 63-bit morton code (parallel radix sort), then coarser levels are built
+ * bottom-up, each merging the finer level's gaussians per octree cell.
+ * writes <output_dir>/lod_<k>.ply (or .compressed.ply), k = 0 coarsest, the
+ * last level being the full splat, plus lod.json listing them coarse-first
+ * so a viewer can show level 0 and swap in finer levels as they arrive
+ */
+static py::dict build_splat_lod(
+    const std::string& ply_path,
+    const std::string& output_dir,
+    int min_splats,
+    double level_ratio,
+    bool compressed,
+    int sh_degree,
+    int sh_palette_size
+) {
+    if (min_splats < 1) {
+        throw std::invalid_argument("min_splats must be >= 1");
+    }
+    if (level_ratio < 1.5) {
+        throw std::invalid_argument("level_ratio must be >= 1.5");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<LodLevel> levels;
+    std::vector<std::string> files;
+    std::vector<size_t> file_bytes;
+    {
+        py::gil_scoped_release release;
+
+        #ifdef _OPENMP
+        omp_set_num_threads(std::min(4, omp_get_max_threads()));
+        #endif
+
+        const SplatCloud source = SplatCloud::read(ply_path);
+        std::vector<uint64_t> codes = morton_codes(source);
+        std::vector<uint32_t> order(source.count);
+        for (size_t i = 0; i < source.count; ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        radix_sort(codes, order, 3 * MORTON_AXIS_BITS);
+
+        LodLevel leaves;
+        leaves.cloud = source.gather(order);
+        leaves.codes = std::move(codes);
+        leaves.weights.resize(source.count);
+        #pragma omp parallel for schedule(static)
+        for (int64_t i = 0; i < static_cast<int64_t>(source.count); ++i) {
+            leaves.weights[i] = splat_weight(leaves.cloud.opacities[i], &leaves.cloud.scales[i * 3]);
+        }
+
+        // finest first while merging, emitted coarsest first
+        const std::vector<int> depths = choose_depths(leaves.codes, static_cast<size_t>(min_splats), level_ratio);
+        levels.push_back(std::move(leaves));
+        for (auto it = depths.rbegin(); it != depths.rend(); ++it) {
+            levels.push_back(merge_level(levels.back(), *it));
+        }
+        std::reverse(levels.begin(), levels.end());
+
+        fs::create_directories(output_dir);
+        for (size_t k = 0; k < levels.size(); ++k) {
+            const std::string name = "lod_" + std::to_string(k) + (compressed ? ".compressed.ply" : ".ply");
+            const std::string path = output_dir + "/" + name;
+            if (compressed) {
+                write_compressed_ply(levels[k].cloud, path, sh_degree, sh_palette_size);
+            } else {
+                levels[k].cloud.write(path);
+            }
+            files.push_back(name);
+            file_bytes.push_back(static_cast<size_t>(fs::file_size(path)));
+        }
+
+        std::ofstream manifest(output_dir + "/lod.json", std::ios::trunc);
+        if (!manifest) {
+            throw std::runtime_error("Could not open " + output_dir + "/lod.json for writing");
+        }
+        manifest << "{\n  \"format\": \"" << (compressed ? "compressed_ply" : "ply") << "\",\n  \"levels\": [\n";
+        for (size_t k = 0; k < levels.size(); ++k) {
+            manifest << "    {\"file\": \"" << files[k] << "\", \"splats\": " << levels[k].cloud.count
+                     << ", \"depth\": " << levels[k].depth << ", \"bytes\": " << file_bytes[k] << "}"
+                     << (k + 1 < levels.size() ? ",\n" : "\n");
+        }
+        manifest << "  ]\n}\n";
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::list level_info;
+    for (size_t k = 0; k < levels.size(); ++k) {
+        py::dict info;
+        info["file"] = files[k];
+        info["splats"] = levels[k].cloud.count;
+        info["depth"] = levels[k].depth;
+        info["bytes"] = file_bytes[k];
+        level_info.append(info);
+    }
+
+    py::dict results;
+    results["levels"] = level_info;
+    results["output_dir"] = output_dir;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat lod results:\n");
+    for (size_t k = 0; k < levels.size(); ++k) {
+        printf("  level %zu: %zu splats (depth %d), %.2f MB\n", k, levels[k].cloud.count, levels[k].depth, file_bytes[k] / 1e6);
+    }
+    printf("  total time: %.2f ms\n", processing_time_ms);
+    return results;
+}
+
+void register_splat_lod(py::module_& m) {
+    m.def("build_splat_lod", &build_splat_lod,
+          "morton octree level-of-detail hierarchy of moment-matched splats, written coarse-first with lod.json",
+          py::arg("ply_path"), py::arg("output_dir"), py::arg("min_splats") = 16384, py::arg("level_ratio") = 4.0,
+          py::arg("compressed") = true, py::arg("sh_degree") = -1, py::arg("sh_palette_size") = 0);
+}
@@ -0,0 +1,1290 @@
+#include "splat_mesh.h"
+#include "colmap_model.h"
+#include "splat_ply.h"
+#include "visual_hull.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+// density samples are stored in bricks of 8^3
+static constexpr int MESH_BRICK_SIZE = 8;
+static constexpr int MESH_BRICK_SAMPLES = MESH_BRICK_SIZE * MESH_BRICK_SIZE * MESH_BRICK_SIZE;
+
+// a splat adds density out to 3 sigma
+static constexpr double SPLAT_EXTENT_SIGMA = 3.0;
+
+// splats are widened by this std (in voxels) so thin, flat ones still hit
+// voxel centres instead of falling between them
+static constexpr double MIN_SIGMA_VOXELS = 0.5;
+
+// splats reaching further than this (voxels from the centre) are background blobs, not surface
+static constexpr int MAX_FOOTPRINT_VOXELS = 48;
+
+// grid box: central 98% of the splat centres per axis, padded by 10% of the extent per side
+static constexpr double GRID_PERCENTILE = 0.01;
+static constexpr double GRID_PADDING = 0.1;
+
+// a collapse may not turn any face by more than ~78 degrees
+static constexpr double DECIMATE_MIN_NORMAL_COS = 0.2;
+
+// degree-0 sh basis, f_dc -> colour is 0.5 + SH_C0 * f_dc
+static constexpr float SH_C0 = 0.28209479177387814f;
+
+// ---------------------------------------------------------------------------
+// marching cubes case table
+//
+// corner c of a cube is at (c & 1, c >> 1 & 1, c >> 2 & 1); edge e runs
+// along axis e / 4 from the corner edge_corner(e)
+
+struct CubeCase {
+    int8_t edges[31];  // triangles as cube edges, -1 terminated (at most 10)
+};
+
+static int edge_corner(int e) {
+    const int axis = e / 4, j = e % 4;
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    return ((j & 1) << u) | ((j >> 1) << v);
+}
+
+static int cube_edge(int a, int b) {
+    const int axis = __builtin_ctz(a ^ b);
+    const int lo = std::min(a, b);
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    return axis * 4 + (((lo >> u) & 1) | (((lo >> v) & 1) << 1));
+}
+
+// the cube faces edge e lies on, bit axis * 2 + side
+static int edge_faces(int e) {
+    const int axis = e / 4, j = e % 4;
+    const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    return (1 << (u * 2 + (j & 1))) | (1 << (v * 2 + (j >> 1)));
+}
+
+/**
+ * triangulates loop[first..last] (loop order, so facing is kept) without a
+ * diagonal between two edges on the same cube face: such a diagonal would
+ * lie in the face, where the neighbouring cube has its own contour segment,
+ * and the mesh would stop being edge-manifold. first-last is the polygon's
+ * closing side. false if no such triangulation exists
+ */
+static bool triangulate_loop(const int* loop, int first, int last, int8_t* out, int& n) {
+    if (last - first < 2) {
+        return true;
+    }
+    const auto diagonal_ok = [loop](int a, int b) {
+        return b - a == 1 || (edge_faces(loop[a]) & edge_faces(loop[b])) == 0;
+    };
+    for (int apex = first + 1; apex < last; ++apex) {
+        if (!diagonal_ok(first, apex) || !diagonal_ok(apex, last)) {
+            continue;
+        }
+        const int mark = n;
+        out[n++] = static_cast<int8_t>(loop[first]);
+        out[n++] = static_cast<int8_t>(loop[apex]);
+        out[n++] = static_cast<int8_t>(loop[last]);
+        if (triangulate_loop(loop, first, apex, out, n) && triangulate_loop(loop, apex, last, out, n)) {
+            return true;
+        }
+        n = mark;
+    }
+    return false;
+}
+
+/**
+ * the 256 cases are derived rather than typed in: on every cube face each
+ * run of inside corners is cut off by one segment between the two crossed
+ * edges around it, so diagonal inside corners stay apart, and both cubes
+ * sharing a face make the same choice (no cracks). segments run the same
+ * way round the cube, chain into closed loops, and every loop is split
+ * into triangles facing away from the inside corners, with every interior
+ * diagonal running through the cube rather than along one of its faces
+ */
+static const std::array<CubeCase, 256>& cube_cases() {
+    static const std::array<CubeCase, 256> table = [] {
+        std::array<CubeCase, 256> cases;
+        for (int config = 0; config < 256; ++config) {
+            const auto inside = [config](int corner) { return (config >> corner) & 1; };
+
+            // next[e]: the crossed edge the contour reaches after e
+            int next[12];
+            std::fill_n(next, 12, -1);
+            for (int axis = 0; axis < 3; ++axis) {
+                const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+                for (int side = 0; side < 2; ++side) {
+                    const int base = side << axis;
+                    int ring[4] = {base, base | (1 << u), base | (1 << u) | (1 << v), base | (1 << v)};
+                    if (side == 0) {
+                        // counter-clockwise seen from outside the cube
+                        std::reverse(ring, ring + 4);
+                    }
+                    for (int k = 0; k < 4; ++k) {
+                        const int prev = (k + 3) % 4;
+                        if (!inside(ring[k]) || inside(ring[prev])) {
+                            continue;
+                        }
+                        int last = k;
+                        while (inside(ring[(last + 1) % 4])) {
+                            last = (last + 1) % 4;
+                        }
+                        next[cube_edge(ring[prev], ring[k])] = cube_edge(ring[last], ring[(last + 1) % 4]);
+                    }
+                }
+            }
+
+            CubeCase& cube = cases[config];
+            std::fill_n(cube.edges, 31, -1);
+            int n = 0;
+            bool used[12] = {};
+            for (int start = 0; start < 12; ++start) {
+                if (next[start] < 0 || used[start]) {
+                    continue;
+                }
+                int loop[12], length = 0;
+                for (int e = start; !used[e]; e = next[e]) {
+                    used[e] = true;
+                    loop[length++] = e;
+                }
+                if (!triangulate_loop(loop, 0, length - 1, cube.edges, n)) {
+                    throw std::logic_error("marching cubes case " + std::to_string(config) + " has no manifold triangulation");
+                }
+            }
+        }
+        return cases;
+    }();
+    return table;
+}
+
+// ---------------------------------------------------------------------------
+// density grid
+
+/**
+ * sparse sample grid: samples at voxel centres, stored per 8^3 brick only
+ * where splats were evaluated (plus the bricks just below them, which own
+ * the cube edges reaching into them). unstored bricks read as empty, or as
+ * solid inside a filled cavity
+ */
+struct DensityGrid {
+    double origin[3] = {0.0, 0.0, 0.0};
+    double voxel_size = 0.0;
+    int dims[3] = {0, 0, 0};
+    int bricks[3] = {0, 0, 0};
+    float fill_value = 0.0f;
+    std::vector<int32_t> brick_slot;    // -1: not stored
+    std::vector<uint8_t> brick_inside;  // unstored brick inside a filled cavity
+    std::vector<uint32_t> slot_brick;   // brick of each stored slot
+    std::vector<float> density;         // slots x 512
+    std::vector<float> color;           // slots x 512 x 4: weighted r g b, weight
+
+    size_t brick_index(int bx, int by, int bz) const {
+        return (static_cast<size_t>(bz) * bricks[1] + by) * bricks[0] + bx;
+    }
+
+    static int local_index(int x, int y, int z) {
+        return ((z & 7) * MESH_BRICK_SIZE + (y & 7)) * MESH_BRICK_SIZE + (x & 7);
+    }
+
+    // stored sample index, or -1
+    int64_t sample(int x, int y, int z) const {
+        if (x < 0 || y < 0 || z < 0 || x >= dims[0] || y >= dims[1] || z >= dims[2]) {
+            return -1;
+        }
+        const int32_t slot = brick_slot[brick_index(x >> 3, y >> 3, z >> 3)];
+        return slot < 0 ? -1 : static_cast<int64_t>(slot) * MESH_BRICK_SAMPLES + local_index(x, y, z);
+    }
+
+    float value(int x, int y, int z) const {
+        if (x < 0 || y < 0 || z < 0 || x >= dims[0] || y >= dims[1] || z >= dims[2]) {
+            return 0.0f;
+        }
+        const size_t b = brick_index(x >> 3, y >> 3, z >> 3);
+        const int32_t slot = brick_slot[b];
+        if (slot < 0) {
+            return brick_inside[b] ? fill_value : 0.0f;
+        }
+        return density[static_cast<size_t>(slot) * MESH_BRICK_SAMPLES + local_index(x, y, z)];
+    }
+};
+
+/**
+ * a splat ready to evaluate: inverse of its (widened) covariance and the
+ * voxel box its 3 sigma ellipsoid covers
+ */
+struct SplatKernel {
+    float mean[3];
+    float inverse[6];  // xx xy xz yy yz zz
+    float opacity;
+    float color[3];
+    int lo[3], hi[3];  // inclusive voxel range, lo > hi when unused
+};
+
+struct DensityStats {
+    size_t splats_used = 0;
+    size_t skipped_large = 0;
+    size_t live_bricks = 0;
+    size_t carved_bricks = 0;
+};
+
+static DensityGrid make_density_grid(const SplatCloud& cloud, int resolution) {
+    double lo[3], hi[3];
+    std::vector<float> values(cloud.count);
+    for (int a = 0; a < 3; ++a) {
+        for (size_t i = 0; i < cloud.count; ++i) {
+            values[i] = cloud.positions[i * 3 + a];
+        }
+        const size_t low = static_cast<size_t>(values.size() * GRID_PERCENTILE);
+        const size_t high = values.size() - 1 - low;
+        std::nth_element(values.begin(), values.begin() + low, values.end());
+        lo[a] = values[low];
+        std::nth_element(values.begin(), values.begin() + high, values.end());
+        hi[a] = values[high];
+    }
+
+    double max_extent = 0.0;
+    for (int a = 0; a < 3; ++a) {
+        const double pad = (hi[a] - lo[a]) * GRID_PADDING;
+        lo[a] -= pad;
+        hi[a] += pad;
+        max_extent = std::max(max_extent, hi[a] - lo[a]);
+    }
+    if (max_extent <= 0.0) {
+        throw std::runtime_error("splat has no extent to mesh");
+    }
+
+    DensityGrid grid;
+    grid.voxel_size = max_extent / resolution;
+    for (int a = 0; a < 3; ++a) {
+        const int voxels = std::max(1, static_cast<int>(std::ceil((hi[a] - lo[a]) / grid.voxel_size)));
+        grid.bricks[a] = (voxels + MESH_BRICK_SIZE - 1) / MESH_BRICK_SIZE;
+        grid.dims[a] = grid.bricks[a] * MESH_BRICK_SIZE;
+        grid.origin[a] = 0.5 * (lo[a] + hi[a]) - 0.5 * grid.dims[a] * grid.voxel_size;
+    }
+    const size_t num_bricks = static_cast<size_t>(grid.bricks[0]) * grid.bricks[1] * grid.bricks[2];
+    grid.brick_slot.assign(num_bricks, -1);
+    grid.brick_inside.assign(num_bricks, 0);
+    return grid;
+}
+
+/**
+ * splat every gaussian into the voxels its footprint overlaps. splats are
+ * binned per brick first, then bricks are evaluated in parallel, each by
+ * one thread, so no two threads ever add into the same sample. bricks the
+ * mask hull rules out are never evaluated. the outermost sample layer is
+ * left empty, which closes the surface at the grid border
+ */
+static DensityStats splat_density(
+    DensityGrid& grid,
+    const SplatCloud& cloud,
+    float min_opacity,
+    const ColmapModel* model,
+    const MaskedViews* views,
+    int max_misses
+) {
+    DensityStats stats;
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    const double voxel = grid.voxel_size;
+    const double widen = (MIN_SIGMA_VOXELS * voxel) * (MIN_SIGMA_VOXELS * voxel);
+    const float min_logit = min_opacity > 0.0f ? std::log(min_opacity / (1.0f - min_opacity)) : -std::numeric_limits<float>::infinity();
+
+    std::vector<SplatKernel> kernels(n);
+    long long used = 0, large = 0;
+    #pragma omp parallel for schedule(static) reduction(+:used, large)
+    for (int64_t i = 0; i < n; ++i) {
+        SplatKernel& k = kernels[i];
+        k.lo[0] = 1;
+        k.hi[0] = 0;
+        if (cloud.opacities[i] < min_logit) {
+            continue;
+        }
+        double cov[6];
+        splat_covariance(&cloud.rotations[i * 4], &cloud.scales[i * 3], cov);
+        cov[0] += widen;
+        cov[3] += widen;
+        cov[5] += widen;
+
+        bool inside_grid = true;
+        for (int a = 0; a < 3; ++a) {
+            const double variance = cov[a == 0 ? 0 : (a == 1 ? 3 : 5)];
+            const double reach = SPLAT_EXTENT_SIGMA * std::sqrt(variance) / voxel;
+            if (reach > MAX_FOOTPRINT_VOXELS) {
+                inside_grid = false;
+                ++large;
+                break;
+            }
+            const double centre = (cloud.positions[i * 3 + a] - grid.origin[a]) / voxel - 0.5;
+            k.lo[a] = std::max(1, static_cast<int>(std::ceil(centre - reach)));
+            k.hi[a] = std::min(grid.dims[a] - 2, static_cast<int>(std::floor(centre + reach)));
+            inside_grid &= k.lo[a] <= k.hi[a];
+        }
+        if (!inside_grid) {
+            k.lo[0] = 1;
+            k.hi[0] = 0;
+            continue;
+        }
+
+        // inverse by the adjugate; the widening keeps it well conditioned
+        const double a = cov[0], b = cov[1], c = cov[2], d = cov[3], e = cov[4], f = cov[5];
+        const double A = d * f - e * e, B = c * e - b * f, C = b * e - c * d;
+        const double det = a * A + b * B + c * C;
+        k.inverse[0] = static_cast<float>(A / det);
+        k.inverse[1] = static_cast<float>(B / det);
+        k.inverse[2] = static_cast<float>(C / det);
+        k.inverse[3] = static_cast<float>((a * f - c * c) / det);
+        k.inverse[4] = static_cast<float>((b * c - a * e) / det);
+        k.inverse[5] = static_cast<float>((a * d - b * b) / det);
+        for (int axis = 0; axis < 3; ++axis) {
+            k.mean[axis] = cloud.positions[i * 3 + axis];
+            k.color[axis] = std::clamp(0.5f + SH_C0 * cloud.sh_dc[i * 3 + axis], 0.0f, 1.0f);
+        }
+        k.opacity = 1.0f / (1.0f + std::exp(-cloud.opacities[i]));
+        ++used;
+    }
+    stats.splats_used = static_cast<size_t>(used);
+    stats.skipped_large = static_cast<size_t>(large);
+
+    // brick -> splat lists, csr
+    const size_t num_bricks = grid.brick_slot.size();
+    std::vector<uint32_t> brick_count(num_bricks, 0);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        const SplatKernel& k = kernels[i];
+        if (k.lo[0] > k.hi[0]) {
+            continue;
+        }
+        for (int bz = k.lo[2] >> 3; bz <= k.hi[2] >> 3; ++bz) {
+            for (int by = k.lo[1] >> 3; by <= k.hi[1] >> 3; ++by) {
+                for (int bx = k.lo[0] >> 3; bx <= k.hi[0] >> 3; ++bx) {
+                    #pragma omp atomic
+                    ++brick_count[grid.brick_index(bx, by, bz)];
+                }
+            }
+        }
+    }
+    std::vector<size_t> brick_offsets(num_bricks + 1, 0);
+    for (size_t b = 0; b < num_bricks; ++b) {
+        brick_offsets[b + 1] = brick_offsets[b] + brick_count[b];
+    }
+    std::vector<uint32_t> brick_splats(brick_offsets[num_bricks]);
+    std::fill(brick_count.begin(), brick_count.end(), 0);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        const SplatKernel& k = kernels[i];
+        if (k.lo[0] > k.hi[0]) {
+            continue;
+        }
+        for (int bz = k.lo[2] >> 3; bz <= k.hi[2] >> 3; ++bz) {
+            for (int by = k.lo[1] >> 3; by <= k.hi[1] >> 3; ++by) {
+                for (int bx = k.lo[0] >> 3; bx <= k.hi[0] >> 3; ++bx) {
+                    const size_t b = grid.brick_index(bx, by, bz);
+                    uint32_t slot;
+                    #pragma omp atomic capture
+                    slot = brick_count[b]++;
+                    brick_splats[brick_offsets[b] + slot] = static_cast<uint32_t>(i);
+                }
+            }
+        }
+    }
+
+    // live: touched by a splat and not provably outside the mask hull.
+    // lists are sorted so the float sums don't depend on thread timing
+    std::vector<BitMask> coarse;
+    if (views) {
+        coarse.resize(views->masks.size());
+        for (size_t i = 0; i < coarse.size(); ++i) {
+            if (views->cameras[i]) {
+                coarse[i] = views->masks[i].any_pool8();
+            }
+        }
+    }
+    const double brick_extent = MESH_BRICK_SIZE * voxel;
+    std::vector<uint8_t> live(num_bricks, 0);
+    long long carved = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:carved)
+    for (int64_t b = 0; b < static_cast<int64_t>(num_bricks); ++b) {
+        if (brick_offsets[b] == brick_offsets[b + 1]) {
+            continue;
+        }
+        if (views) {
+            const int bx = static_cast<int>(b % grid.bricks[0]);
+            const int by = static_cast<int>((b / grid.bricks[0]) % grid.bricks[1]);
+            const int bz = static_cast<int>(b / (static_cast<size_t>(grid.bricks[0]) * grid.bricks[1]));
+            const double lo[3] = {grid.origin[0] + bx * brick_extent,
+                                  grid.origin[1] + by * brick_extent,
+                                  grid.origin[2] + bz * brick_extent};
+            const double hi[3] = {lo[0] + brick_extent, lo[1] + brick_extent, lo[2] + brick_extent};
+            if (box_outside_masks(lo, hi, *views, coarse, model->images, max_misses)) {
+                ++carved;
+                continue;
+            }
+        }
+        std::sort(brick_splats.begin() + brick_offsets[b], brick_splats.begin() + brick_offsets[b + 1]);
+        live[b] = 1;
+    }
+    stats.carved_bricks = static_cast<size_t>(carved);
+
+    // store live bricks and the ones below them along any axis: a cube
+    // reaching into a live brick has its lower corner there
+    for (int bz = 0; bz < grid.bricks[2]; ++bz) {
+        for (int by = 0; by < grid.bricks[1]; ++by) {
+            for (int bx = 0; bx < grid.bricks[0]; ++bx) {
+                bool store = false;
+                for (int d = 0; d < 8 && !store; ++d) {
+                    const int x = bx + (d & 1), y = by + ((d >> 1) & 1), z = bz + (d >> 2);
+                    store = x < grid.bricks[0] && y < grid.bricks[1] && z < grid.bricks[2] && live[grid.brick_index(x, y, z)];
+                }
+                if (store) {
+                    grid.brick_slot[grid.brick_index(bx, by, bz)] = static_cast<int32_t>(grid.slot_brick.size());
+                    grid.slot_brick.push_back(static_cast<uint32_t>(grid.brick_index(bx, by, bz)));
+                }
+            }
+        }
+    }
+    stats.live_bricks = static_cast<size_t>(std::count(live.begin(), live.end(), 1));
+    grid.density.assign(grid.slot_brick.size() * MESH_BRICK_SAMPLES, 0.0f);
+    grid.color.assign(grid.slot_brick.size() * MESH_BRICK_SAMPLES * 4, 0.0f);
+
+    const int64_t num_slots = static_cast<int64_t>(grid.slot_brick.size());
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int64_t s = 0; s < num_slots; ++s) {
+        const size_t b = grid.slot_brick[s];
+        if (!live[b]) {
+            continue;
+        }
+        const int base[3] = {static_cast<int>(b % grid.bricks[0]) * MESH_BRICK_SIZE,
+                             static_cast<int>((b / grid.bricks[0]) % grid.bricks[1]) * MESH_BRICK_SIZE,
+                             static_cast<int>(b / (static_cast<size_t>(grid.bricks[0]) * grid.bricks[1])) * MESH_BRICK_SIZE};
+        float* density = &grid.density[static_cast<size_t>(s) * MESH_BRICK_SAMPLES];
+        float* color = &grid.color[static_cast<size_t>(s) * MESH_BRICK_SAMPLES * 4];
+
+        for (size_t j = brick_offsets[b]; j < brick_offsets[b + 1]; ++j) {
+            const SplatKernel& k = kernels[brick_splats[j]];
+            int lo[3], hi[3];
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::max(k.lo[a], base[a]);
+                hi[a] = std::min(k.hi[a], base[a] + MESH_BRICK_SIZE - 1);
+            }
+            for (int z = lo[2]; z <= hi[2]; ++z) {
+                const float dz = static_cast<float>(grid.origin[2] + (z + 0.5) * voxel) - k.mean[2];
+                for (int y = lo[1]; y <= hi[1]; ++y) {
+                    const float dy = static_cast<float>(grid.origin[1] + (y + 0.5) * voxel) - k.mean[1];
+                    // the quadratic form split into the part fixed for the row and the x terms
+                    const float row = k.inverse[3] * dy * dy + 2.0f * k.inverse[4] * dy * dz + k.inverse[5] * dz * dz;
+                    const float row_x = 2.0f * (k.inverse[1] * dy + k.inverse[2] * dz);
+                    for (int x = lo[0]; x <= hi[0]; ++x) {
+                        const float dx = static_cast<float>(grid.origin[0] + (x + 0.5) * voxel) - k.mean[0];
+                        const float power = k.inverse[0] * dx * dx + row_x * dx + row;
+                        if (power > SPLAT_EXTENT_SIGMA * SPLAT_EXTENT_SIGMA) {
+                            continue;
+                        }
+                        const float w = k.opacity * std::exp(-0.5f * power);
+                        const int local = DensityGrid::local_index(x, y, z);
+                        density[local] += w;
+                        color[local * 4 + 0] += w * k.color[0];
+                        color[local * 4 + 1] += w * k.color[1];
+                        color[local * 4 + 2] += w * k.color[2];
+                        color[local * 4 + 3] += w;
+                    }
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+/**
+ * a trained splat is a shell: left alone, the isosurface has an outer and
+ * an inner sheet. flood the empty samples from the grid border (6-connected)
+ * and make every empty sample it doesn't reach solid. returns the samples filled
+ */
+static size_t fill_cavities(DensityGrid& grid, float iso) {
+    grid.fill_value = 2.0f * iso;
+    const size_t nx = grid.dims[0], ny = grid.dims[1], nz = grid.dims[2];
+    std::vector<uint64_t> reached((nx * ny * nz + 63) / 64, 0);
+    std::vector<uint32_t> queue;
+
+    const auto visit = [&](int x, int y, int z) {
+        if (x < 0 || y < 0 || z < 0 || x >= grid.dims[0] || y >= grid.dims[1] || z >= grid.dims[2]) {
+            return;
+        }
+        const size_t index = (static_cast<size_t>(z) * ny + y) * nx + x;
+        if ((reached[index >> 6] >> (index & 63)) & 1u) {
+            return;
+        }
+        if (grid.value(x, y, z) >= iso) {
+            return;
+        }
+        reached[index >> 6] |= 1ull << (index & 63);
+        queue.push_back(static_cast<uint32_t>(index));
+    };
+
+    // the outer layer is never evaluated: empty, and connected all round
+    visit(0, 0, 0);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const size_t index = queue[head];
+        const int x = static_cast<int>(index % nx);
+        const int y = static_cast<int>((index / nx) % ny);
+        const int z = static_cast<int>(index / (nx * ny));
+        visit(x - 1, y, z);
+        visit(x + 1, y, z);
+        visit(x, y - 1, z);
+        visit(x, y + 1, z);
+        visit(x, y, z - 1);
+        visit(x, y, z + 1);
+    }
+    const auto was_reached = [&](int x, int y, int z) {
+        const size_t index = (static_cast<size_t>(z) * ny + y) * nx + x;
+        return (reached[index >> 6] >> (index & 63)) & 1u;
+    };
+
+    // unstored bricks are uniformly empty, so one sample tells
+    for (int bz = 0; bz < grid.bricks[2]; ++bz) {
+        for (int by = 0; by < grid.bricks[1]; ++by) {
+            for (int bx = 0; bx < grid.bricks[0]; ++bx) {
+                const size_t b = grid.brick_index(bx, by, bz);
+                if (grid.brick_slot[b] < 0) {
+                    grid.brick_inside[b] = !was_reached(bx * MESH_BRICK_SIZE, by * MESH_BRICK_SIZE, bz * MESH_BRICK_SIZE);
+                }
+            }
+        }
+    }
+
+    size_t filled = 0;
+    const int64_t num_slots = static_cast<int64_t>(grid.slot_brick.size());
+    #pragma omp parallel for schedule(static) reduction(+:filled)
+    for (int64_t s = 0; s < num_slots; ++s) {
+        const size_t b = grid.slot_brick[s];
+        const int bx = static_cast<int>(b % grid.bricks[0]) * MESH_BRICK_SIZE;
+        const int by = static_cast<int>((b / grid.bricks[0]) % grid.bricks[1]) * MESH_BRICK_SIZE;
+        const int bz = static_cast<int>(b / (static_cast<size_t>(grid.bricks[0]) * grid.bricks[1])) * MESH_BRICK_SIZE;
+        float* density = &grid.density[static_cast<size_t>(s) * MESH_BRICK_SAMPLES];
+        for (int local = 0; local < MESH_BRICK_SAMPLES; ++local) {
+            const int x = bx + (local & 7), y = by + ((local >> 3) & 7), z = bz + (local >> 6);
+            if (density[local] < iso && !was_reached(x, y, z)) {
+                density[local] = grid.fill_value;
+                ++filled;
+            }
+        }
+    }
+    return filled;
+}
+
+/**
+ * parallel marching cubes over the stored bricks. a vertex is made once per
+ * crossed sample edge, owned by the edge's lower sample, so cubes share
+ * vertices and the mesh comes out indexed and watertight. vertex colours
+ * are the density-weighted dc colours of the two samples, interpolated
+ */
+static TriangleMesh extract_isosurface(const DensityGrid& grid, float iso) {
+    const int64_t num_slots = static_cast<int64_t>(grid.slot_brick.size());
+    const auto brick_base = [&grid](size_t b, int base[3]) {
+        base[0] = static_cast<int>(b % grid.bricks[0]) * MESH_BRICK_SIZE;
+        base[1] = static_cast<int>((b / grid.bricks[0]) % grid.bricks[1]) * MESH_BRICK_SIZE;
+        base[2] = static_cast<int>(b / (static_cast<size_t>(grid.bricks[0]) * grid.bricks[1])) * MESH_BRICK_SIZE;
+    };
+
+    // pass 1: crossed edges per brick
+    std::vector<uint32_t> slot_vertices(num_slots + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int64_t s = 0; s < num_slots; ++s) {
+        int base[3];
+        brick_base(grid.slot_brick[s], base);
+        uint32_t count = 0;
+        for (int local = 0; local < MESH_BRICK_SAMPLES; ++local) {
+            const int x = base[0] + (local & 7), y = base[1] + ((local >> 3) & 7), z = base[2] + (local >> 6);
+            const bool in = grid.value(x, y, z) >= iso;
+            count += (grid.value(x + 1, y, z) >= iso) != in;
+            count += (grid.value(x, y + 1, z) >= iso) != in;
+            count += (grid.value(x, y, z + 1) >= iso) != in;
+        }
+        slot_vertices[s + 1] = count;
+    }
+    for (int64_t s = 0; s < num_slots; ++s) {
+        slot_vertices[s + 1] += slot_vertices[s];
+    }
+
+    // pass 2: vertices, and the edge -> vertex map the cubes read
+    TriangleMesh mesh;
+    const size_t num_vertices = slot_vertices[num_slots];
+    mesh.positions.resize(num_vertices * 3);
+    mesh.colors.resize(num_vertices * 3);
+    std::vector<int32_t> edge_vertex(static_cast<size_t>(num_slots) * MESH_BRICK_SAMPLES * 3, -1);
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int64_t s = 0; s < num_slots; ++s) {
+        int base[3];
+        brick_base(grid.slot_brick[s], base);
+        uint32_t vertex = slot_vertices[s];
+        for (int local = 0; local < MESH_BRICK_SAMPLES; ++local) {
+            const int x = base[0] + (local & 7), y = base[1] + ((local >> 3) & 7), z = base[2] + (local >> 6);
+            const float va = grid.value(x, y, z);
+            const size_t sa = static_cast<size_t>(s) * MESH_BRICK_SAMPLES + local;
+            for (int axis = 0; axis < 3; ++axis) {
+                const int nx = x + (axis == 0), ny = y + (axis == 1), nz = z + (axis == 2);
+                const float vb = grid.value(nx, ny, nz);
+                if ((va >= iso) == (vb >= iso)) {
+                    continue;
+                }
+                const float t = (iso - va) / (vb - va);
+                float* p = &mesh.positions[static_cast<size_t>(vertex) * 3];
+                p[0] = static_cast<float>(grid.origin[0] + (x + 0.5 + (axis == 0) * t) * grid.voxel_size);
+                p[1] = static_cast<float>(grid.origin[1] + (y + 0.5 + (axis == 1) * t) * grid.voxel_size);
+                p[2] = static_cast<float>(grid.origin[2] + (z + 0.5 + (axis == 2) * t) * grid.voxel_size);
+
+                float rgbw[4];
+                const float* ca = &grid.color[sa * 4];
+                const int64_t sb = grid.sample(nx, ny, nz);
+                for (int c = 0; c < 4; ++c) {
+                    rgbw[c] = (1.0f - t) * ca[c] + (sb < 0 ? 0.0f : t * grid.color[static_cast<size_t>(sb) * 4 + c]);
+                }
+                uint8_t* rgb = &mesh.colors[static_cast<size_t>(vertex) * 3];
+                for (int c = 0; c < 3; ++c) {
+                    const float value = rgbw[3] > 0.0f ? rgbw[c] / rgbw[3] : 0.5f;
+                    rgb[c] = static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                edge_vertex[sa * 3 + axis] = static_cast<int32_t>(vertex++);
+            }
+        }
+    }
+
+    // pass 3: triangles per brick, from each cube whose lower corner it holds
+    const auto& cases = cube_cases();
+    std::vector<std::vector<uint32_t>> slot_faces(num_slots);
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int64_t s = 0; s < num_slots; ++s) {
+        int base[3];
+        brick_base(grid.slot_brick[s], base);
+        std::vector<uint32_t>& faces = slot_faces[s];
+        for (int local = 0; local < MESH_BRICK_SAMPLES; ++local) {
+            const int x = base[0] + (local & 7), y = base[1] + ((local >> 3) & 7), z = base[2] + (local >> 6);
+            int config = 0;
+            for (int c = 0; c < 8; ++c) {
+                config |= (grid.value(x + (c & 1), y + ((c >> 1) & 1), z + (c >> 2)) >= iso) << c;
+            }
+            if (config == 0 || config == 255) {
+                continue;
+            }
+            const int8_t* edges = cases[config].edges;
+            for (int i = 0; edges[i] >= 0; i += 3) {
+                uint32_t tri[3];
+                bool valid = true;
+                for (int k = 0; k < 3; ++k) {
+                    const int e = edges[i + k];
+                    const int corner = edge_corner(e);
+                    const int64_t owner = grid.sample(x + (corner & 1), y + ((corner >> 1) & 1), z + (corner >> 2));
+                    const int32_t vertex = owner < 0 ? -1 : edge_vertex[static_cast<size_t>(owner) * 3 + e / 4];
+                    valid &= vertex >= 0;
+                    tri[k] = static_cast<uint32_t>(vertex);
+                }
+                if (valid) {
+                    faces.insert(faces.end(), tri, tri + 3);
+                }
+            }
+        }
+    }
+    for (const auto& faces : slot_faces) {
+        mesh.faces.insert(mesh.faces.end(), faces.begin(), faces.end());
+    }
+    return mesh;
+}
+
+// ---------------------------------------------------------------------------
+// quadric decimation
+
+/**
+ * symmetric 4x4 error quadric, upper triangle: xx xy xz xw yy yz yw zz zw ww
+ */
+struct Quadric {
+    double q[10] = {};
+
+    void add_plane(const double n[3], double d, double weight) {
+        const double p[4] = {n[0], n[1], n[2], d};
+        int k = 0;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = i; j < 4; ++j) {
+                q[k++] += weight * p[i] * p[j];
+            }
+        }
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        for (int k = 0; k < 10; ++k) {
+            q[k] += other.q[k];
+        }
+        return *this;
+    }
+
+    double error(const double p[3]) const {
+        const double x = p[0], y = p[1], z = p[2];
+        return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+               q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+               q[7] * z * z + 2.0 * q[8] * z + q[9];
+    }
+
+    // minimizer of the error, false when the 3x3 part is near singular (flat or linear patches)
+    bool optimum(double p[3]) const {
+        const double a = q[0], b = q[1], c = q[2], d = q[4], e = q[5], f = q[7];
+        const double A = d * f - e * e, B = c * e - b * f, C = b * e - c * d;
+        const double det = a * A + b * B + c * C;
+        const double trace = a + d + f;
+        if (!(std::abs(det) > 1e-9 * trace * trace * trace)) {
+            return false;
+        }
+        const double r[3] = {-q[3], -q[6], -q[8]};
+        p[0] = (A * r[0] + B * r[1] + C * r[2]) / det;
+        p[1] = (B * r[0] + (a * f - c * c) * r[1] + (b * c - a * e) * r[2]) / det;
+        p[2] = (C * r[0] + (b * c - a * e) * r[1] + (a * d - b * b) * r[2]) / det;
+        return true;
+    }
+};
+
+struct CollapseCandidate {
+    double cost;
+    uint32_t u, v;
+    uint32_t stamp_u, stamp_v;
+
+    bool operator>(const CollapseCandidate& other) const { return cost > other.cost; }
+};
+
+static inline void triangle_normal(const double* a, const double* b, const double* c, double n[3]) {
+    const double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    const double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+void decimate_mesh(TriangleMesh& mesh, size_t target_faces) {
+    const size_t num_vertices = mesh.vertex_count();
+    const size_t num_faces = mesh.face_count();
+    if (num_faces <= target_faces) {
+        return;
+    }
+    std::vector<uint32_t>& faces = mesh.faces;
+    std::vector<double> positions(mesh.positions.begin(), mesh.positions.end());
+    std::vector<float> colors(mesh.colors.begin(), mesh.colors.end());
+
+    std::vector<Quadric> quadrics(num_vertices);
+    std::vector<std::vector<uint32_t>> vertex_faces(num_vertices);
+    std::vector<uint8_t> face_alive(num_faces, 1);
+    size_t faces_left = 0;
+    for (size_t f = 0; f < num_faces; ++f) {
+        const uint32_t* v = &faces[f * 3];
+        double n[3];
+        triangle_normal(&positions[v[0] * 3], &positions[v[1] * 3], &positions[v[2] * 3], n);
+        const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length <= 0.0 || v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) {
+            face_alive[f] = 0;
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            n[k] /= length;
+        }
+        const double d = -(n[0] * positions[v[0] * 3] + n[1] * positions[v[0] * 3 + 1] + n[2] * positions[v[0] * 3 + 2]);
+        // area weighted, so large faces hold their plane harder
+        for (int k = 0; k < 3; ++k) {
+            quadrics[v[k]].add_plane(n, d, 0.5 * length);
+            vertex_faces[v[k]].push_back(static_cast<uint32_t>(f));
+        }
+        ++faces_left;
+    }
+
+    std::vector<uint8_t> vertex_alive(num_vertices, 1);
+    std::vector<uint32_t> stamps(num_vertices, 0);
+
+    const auto collapse_target = [&](uint32_t u, uint32_t v, double p[3]) {
+        Quadric q = quadrics[u];
+        q += quadrics[v];
+        if (q.optimum(p)) {
+            return q.error(p);
+        }
+        // fall back to the best of the endpoints and the midpoint
+        const double* pu = &positions[u * 3];
+        const double* pv = &positions[v * 3];
+        const double mid[3] = {0.5 * (pu[0] + pv[0]), 0.5 * (pu[1] + pv[1]), 0.5 * (pu[2] + pv[2])};
+        double best = std::numeric_limits<double>::max();
+        for (const double* candidate : {pu, pv, mid}) {
+            const double e = q.error(candidate);
+            if (e < best) {
+                best = e;
+                std::copy_n(candidate, 3, p);
+            }
+        }
+        return best;
+    };
+
+    std::priority_queue<CollapseCandidate, std::vector<CollapseCandidate>, std::greater<CollapseCandidate>> heap;
+    const auto push_edge = [&](uint32_t u, uint32_t v) {
+        double p[3];
+        heap.push({std::max(0.0, collapse_target(u, v, p)), u, v, stamps[u], stamps[v]});
+    };
+    // a closed mesh holds every edge once in each direction
+    for (size_t f = 0; f < num_faces; ++f) {
+        if (!face_alive[f]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t a = faces[f * 3 + k], b = faces[f * 3 + (k + 1) % 3];
+            if (a < b) {
+                push_edge(a, b);
+            }
+        }
+    }
+
+    const auto contains = [&faces](size_t f, uint32_t vertex) {
+        return faces[f * 3] == vertex || faces[f * 3 + 1] == vertex || faces[f * 3 + 2] == vertex;
+    };
+    const auto neighbours = [&](uint32_t vertex, std::vector<uint32_t>& out) {
+        out.clear();
+        for (uint32_t f : vertex_faces[vertex]) {
+            if (!face_alive[f]) {
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                if (faces[f * 3 + k] != vertex) {
+                    out.push_back(faces[f * 3 + k]);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    };
+    // moving `vertex` to p must not flip or squash its faces that survive
+    const auto keeps_orientation = [&](uint32_t vertex, uint32_t other, const double p[3]) {
+        for (uint32_t f : vertex_faces[vertex]) {
+            if (!face_alive[f] || contains(f, other)) {
+                continue;
+            }
+            const double* corners[3];
+            const double* moved[3];
+            for (int k = 0; k < 3; ++k) {
+                corners[k] = &positions[faces[f * 3 + k] * 3];
+                moved[k] = faces[f * 3 + k] == vertex ? p : corners[k];
+            }
+            double before[3], after[3];
+            triangle_normal(corners[0], corners[1], corners[2], before);
+            triangle_normal(moved[0], moved[1], moved[2], after);
+            const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+            const double lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+                                             (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+            if (!(dot > DECIMATE_MIN_NORMAL_COS * lengths)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<uint32_t> around_u, around_v;
+    while (faces_left > target_faces && !heap.empty()) {
+        const CollapseCandidate top = heap.top();
+        heap.pop();
+        const uint32_t u = top.u, v = top.v;
+        if (!vertex_alive[u] || !vertex_alive[v] || stamps[u] != top.stamp_u || stamps[v] != top.stamp_v) {
+            continue;
+        }
+
+        // link condition: u and v may only share the vertices opposite their common faces
+        size_t shared_faces = 0;
+        for (uint32_t f : vertex_faces[u]) {
+            shared_faces += face_alive[f] && contains(f, v);
+        }
+        if (shared_faces == 0) {
+            continue;
+        }
+        neighbours(u, around_u);
+        neighbours(v, around_v);
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < around_u.size() && j < around_v.size();) {
+            if (around_u[i] < around_v[j]) {
+                ++i;
+            } else if (around_v[j] < around_u[i]) {
+                ++j;
+            } else {
+                ++common;
+                ++i;
+                ++j;
+            }
+        }
+        if (common != shared_faces) {
+            continue;
+        }
+
+        double p[3];
+        collapse_target(u, v, p);
+        if (!keeps_orientation(u, v, p) || !keeps_orientation(v, u, p)) {
+            continue;
+        }
+
+        // colour follows where p lands along the edge
+        const double* pu = &positions[u * 3];
+        const double* pv = &positions[v * 3];
+        const double edge[3] = {pv[0] - pu[0], pv[1] - pu[1], pv[2] - pu[2]};
+        const double edge_sq = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+        const double t = edge_sq > 0.0
+            ? std::clamp(((p[0] - pu[0]) * edge[0] + (p[1] - pu[1]) * edge[1] + (p[2] - pu[2]) * edge[2]) / edge_sq, 0.0, 1.0)
+            : 0.5;
+        for (int c = 0; c < 3; ++c) {
+            colors[u * 3 + c] = static_cast<float>((1.0 - t) * colors[u * 3 + c] + t * colors[v * 3 + c]);
+        }
+
+        for (uint32_t f : vertex_faces[v]) {
+            if (!face_alive[f]) {
+                continue;
+            }
+            if (contains(f, u)) {
+                face_alive[f] = 0;
+                --faces_left;
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                if (faces[f * 3 + k] == v) {
+                    faces[f * 3 + k] = u;
+                }
+            }
+            vertex_faces[u].push_back(f);
+        }
+        std::vector<uint32_t>().swap(vertex_faces[v]);
+        auto& kept = vertex_faces[u];
+        kept.erase(std::remove_if(kept.begin(), kept.end(), [&face_alive](uint32_t f) { return !face_alive[f]; }), kept.end());
+
+        vertex_alive[v] = 0;
+        std::copy_n(p, 3, &positions[u * 3]);
+        quadrics[u] += quadrics[v];
+        ++stamps[u];
+
+        neighbours(u, around_u);
+        for (uint32_t w : around_u) {
+            push_edge(u, w);
+        }
+    }
+
+    // compact: surviving faces, and only the vertices they use
+    std::vector<int64_t> remap(num_vertices, -1);
+    TriangleMesh out;
+    out.faces.reserve(faces_left * 3);
+    for (size_t f = 0; f < num_faces; ++f) {
+        if (!face_alive[f]) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t vertex = faces[f * 3 + k];
+            if (remap[vertex] < 0) {
+                remap[vertex] = static_cast<int64_t>(out.positions.size() / 3);
+                for (int a = 0; a < 3; ++a) {
+                    out.positions.push_back(static_cast<float>(positions[vertex * 3 + a]));
+                    out.colors.push_back(static_cast<uint8_t>(std::clamp(colors[vertex * 3 + a], 0.0f, 255.0f) + 0.5f));
+                }
+            }
+            out.faces.push_back(static_cast<uint32_t>(remap[vertex]));
+        }
+    }
+    mesh = std::move(out);
+}
+
+// ---------------------------------------------------------------------------
+// output
+
+size_t TriangleMesh::unpaired_edges() const {
+    std::vector<uint64_t> edges(faces.size());
+    for (size_t f = 0; f < face_count(); ++f) {
+        for (int k = 0; k < 3; ++k) {
+            edges[f * 3 + k] = (static_cast<uint64_t>(faces[f * 3 + k]) << 32) | faces[f * 3 + (k + 1) % 3];
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    size_t unpaired = 0;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const uint64_t twin = (edges[i] << 32) | (edges[i] >> 32);
+        if ((i > 0 && edges[i - 1] == edges[i]) || (i + 1 < edges.size() && edges[i + 1] == edges[i]) ||
+            !std::binary_search(edges.begin(), edges.end(), twin)) {
+            ++unpaired;
+        }
+    }
+    return unpaired;
+}
+
+std::vector<float> TriangleMesh::vertex_normals() const {
+    std::vector<double> sums(positions.size(), 0.0);
+    for (size_t f = 0; f < face_count(); ++f) {
+        const uint32_t* v = &faces[f * 3];
+        const double a[3] = {positions[v[0] * 3], positions[v[0] * 3 + 1], positions[v[0] * 3 + 2]};
+        const double b[3] = {positions[v[1] * 3], positions[v[1] * 3 + 1], positions[v[1] * 3 + 2]};
+        const double c[3] = {positions[v[2] * 3], positions[v[2] * 3 + 1], positions[v[2] * 3 + 2]};
+        double n[3];
+        // unnormalized cross product: its length is twice the area
+        triangle_normal(a, b, c, n);
+        for (int k = 0; k < 3; ++k) {
+            for (int axis = 0; axis < 3; ++axis) {
+                sums[v[k] * 3 + axis] += n[axis];
+            }
+        }
+    }
+    std::vector<float> normals(positions.size(), 0.0f);
+    for (size_t i = 0; i < vertex_count(); ++i) {
+        const double* n = &sums[i * 3];
+        const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int axis = 0; axis < 3; ++axis) {
+            normals[i * 3 + axis] = length > 0.0 ? static_cast<float>(n[axis] / length) : (axis == 1 ? 1.0f : 0.0f);
+        }
+    }
+    return normals;
+}
+
+void TriangleMesh::write_obj(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    out << "# torque splat mesh: " << vertex_count() << " vertices, " << face_count() << " faces\n";
+    char line[160];
+    for (size_t i = 0; i < vertex_count(); ++i) {
+        const int length = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.4f %.4f %.4f\n",
+                                         positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2],
+                                         colors[i * 3] / 255.0, colors[i * 3 + 1] / 255.0, colors[i * 3 + 2] / 255.0);
+        out.write(line, length);
+    }
+    for (size_t f = 0; f < face_count(); ++f) {
+        const int length = std::snprintf(line, sizeof(line), "f %u %u %u\n",
+                                         faces[f * 3] + 1, faces[f * 3 + 1] + 1, faces[f * 3 + 2] + 1);
+        out.write(line, length);
+    }
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+void TriangleMesh::write_glb(const std::string& path) const {
+    // gltf accessors must have count >= 1
+    if (vertex_count() == 0 || face_count() == 0) {
+        throw std::runtime_error("Empty mesh, not writing " + path);
+    }
+    const size_t num_vertices = vertex_count();
+    const std::vector<float> normals = vertex_normals();
+    std::vector<uint8_t> rgba(num_vertices * 4, 255);
+    for (size_t i = 0; i < num_vertices; ++i) {
+        std::copy_n(&colors[i * 3], 3, &rgba[i * 4]);
+    }
+    float lo[3] = {0.0f, 0.0f, 0.0f}, hi[3] = {0.0f, 0.0f, 0.0f};
+    for (int a = 0; a < 3 && num_vertices > 0; ++a) {
+        lo[a] = hi[a] = positions[a];
+        for (size_t i = 1; i < num_vertices; ++i) {
+            lo[a] = std::min(lo[a], positions[i * 3 + a]);
+            hi[a] = std::max(hi[a], positions[i * 3 + a]);
+        }
+    }
+
+    // every view is a multiple of 4 bytes, so they pack without padding
+    const size_t position_bytes = positions.size() * sizeof(float);
+    const size_t normal_bytes = normals.size() * sizeof(float);
+    const size_t color_bytes = rgba.size();
+    const size_t index_bytes = faces.size() * sizeof(uint32_t);
+    const size_t bin_bytes = position_bytes + normal_bytes + color_bytes + index_bytes;
+
+    std::ostringstream json;
+    json.precision(9);
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"torque splat mesh\"},"
+         << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+         << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"COLOR_0\":2},\"indices\":3,\"mode\":4}]}],"
+         << "\"buffers\":[{\"byteLength\":" << bin_bytes << "}],"
+         << "\"bufferViews\":["
+         << "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << position_bytes << ",\"target\":34962},"
+         << "{\"buffer\":0,\"byteOffset\":" << position_bytes << ",\"byteLength\":" << normal_bytes << ",\"target\":34962},"
+         << "{\"buffer\":0,\"byteOffset\":" << position_bytes + normal_bytes << ",\"byteLength\":" << color_bytes << ",\"target\":34962},"
+         << "{\"buffer\":0,\"byteOffset\":" << position_bytes + normal_bytes + color_bytes << ",\"byteLength\":" << index_bytes << ",\"target\":34963}],"
+         << "\"accessors\":["
+         << "{\"bufferView\":0,\"componentType\":5126,\"count\":" << num_vertices << ",\"type\":\"VEC3\","
+         << "\"min\":[" << lo[0] << "," << lo[1] << "," << lo[2] << "],\"max\":[" << hi[0] << "," << hi[1] << "," << hi[2] << "]},"
+         << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << num_vertices << ",\"type\":\"VEC3\"},"
+         << "{\"bufferView\":2,\"componentType\":5121,\"normalized\":true,\"count\":" << num_vertices << ",\"type\":\"VEC4\"},"
+         << "{\"bufferView\":3,\"componentType\":5125,\"count\":" << faces.size() << ",\"type\":\"SCALAR\"}]}";
+    std::string json_text = json.str();
+    json_text.append((4 - json_text.size() % 4) % 4, ' ');
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    const uint32_t header[3] = {0x46546C67u, 2u, static_cast<uint32_t>(12 + 8 + json_text.size() + 8 + bin_bytes)};
+    const uint32_t json_chunk[2] = {static_cast<uint32_t>(json_text.size()), 0x4E4F534Au};
+    const uint32_t bin_chunk[2] = {static_cast<uint32_t>(bin_bytes), 0x004E4942u};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(json_chunk), sizeof(json_chunk));
+    out.write(json_text.data(), json_text.size());
+    out.write(reinterpret_cast<const char*>(bin_chunk), sizeof(bin_chunk));
+    out.write(reinterpret_cast<const char*>(positions.data()), position_bytes);
+    out.write(reinterpret_cast<const char*>(normals.data()), normal_bytes);
+    out.write(reinterpret_cast<const char*>(rgba.data()), color_bytes);
+    out.write(reinterpret_cast<const char*>(faces.data()), index_bytes);
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+/**
+ * mesh a trained splat: gaussian opacity density on a sparse voxel grid
+ * (resolution voxels along the longest side), evaluated only in bricks the
+ * mask visual hull keeps when sparse_dir and mask_dir are given; cavities
+ * are filled so the shell gives one surface; marching cubes at iso_level;
+ * quadric decimation to target_faces (0 keeps every face); vertex colours
+ * from sh degree 0. written as .glb or .obj by output_path's extension,
+ * turned from colmap's y-down world to y-up (180 degrees about x)
+ */
+static py::dict export_splat_mesh(
+    const std::string& ply_path,
+    const std::string& output_path,
+    const std::string& sparse_dir,
+    const std::string& mask_dir,
+    int resolution,
+    double iso_level,
+    int target_faces,
+    double min_opacity,
+    bool fill_interior,
+    int margin,
+    int max_misses
+) {
+    if (resolution < 16 || resolution > 1024) {
+        throw std::invalid_argument("resolution must be in [16, 1024]");
+    }
+    if (iso_level <= 0.0) {
+        throw std::invalid_argument("iso_level must be > 0");
+    }
+    if (target_faces < 0 || margin < 0 || max_misses < 0) {
+        throw std::invalid_argument("target_faces, margin and max_misses must be >= 0");
+    }
+    std::string extension = fs::path(output_path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension != ".glb" && extension != ".obj") {
+        throw std::invalid_argument("output_path must end in .glb or .obj");
+    }
+    const bool use_hull = !sparse_dir.empty() && !mask_dir.empty();
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    DensityStats stats;
+    int dims[3] = {0, 0, 0};
+    double voxel_size = 0.0;
+    size_t splats = 0, stored_bricks = 0, filled = 0, faces_before = 0, vertices = 0, faces = 0;
+    size_t unpaired_before = 0, unpaired = 0;
+    int images_without_mask = 0;
+    double density_time_ms = 0.0, surface_time_ms = 0.0, decimate_time_ms = 0.0;
+    {
+        py::gil_scoped_release release;
+
+        #ifdef _OPENMP
+        omp_set_num_threads(std::min(4, omp_get_max_threads()));
+        #endif
+
+        const SplatCloud cloud = SplatCloud::read(ply_path);
+        splats = cloud.count;
+        if (cloud.count == 0) {
+            throw std::runtime_error("splat has no gaussians: " + ply_path);
+        }
+        std::unique_ptr<ColmapModel> model;
+        std::unique_ptr<MaskedViews> views;
+        if (use_hull) {
+            model = std::make_unique<ColmapModel>(ColmapModel::read(sparse_dir));
+            views = std::make_unique<MaskedViews>(load_masked_views(*model, mask_dir, margin));
+            images_without_mask = views->missing;
+        }
+
+        auto density_start = std::chrono::high_resolution_clock::now();
+        DensityGrid grid = make_density_grid(cloud, resolution);
+        stats = splat_density(grid, cloud, static_cast<float>(min_opacity), model.get(), views.get(), max_misses);
+        std::copy_n(grid.dims, 3, dims);
+        voxel_size = grid.voxel_size;
+        stored_bricks = grid.slot_brick.size();
+        if (fill_interior) {
+            filled = fill_cavities(grid, static_cast<float>(iso_level));
+        }
+        auto surface_start = std::chrono::high_resolution_clock::now();
+        density_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(surface_start - density_start).count() / 1000.0;
+
+        TriangleMesh mesh = extract_isosurface(grid, static_cast<float>(iso_level));
+        faces_before = mesh.face_count();
+        if (faces_before == 0) {
+            throw std::runtime_error("No surface: no voxel reaches iso_level " + std::to_string(iso_level) + " in " + ply_path);
+        }
+        auto decimate_start = std::chrono::high_resolution_clock::now();
+        surface_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(decimate_start - surface_start).count() / 1000.0;
+
+        // decimation relies on a closed manifold; don't let it compound a broken surface
+        unpaired_before = mesh.unpaired_edges();
+        if (unpaired_before > 0) {
+            printf("WARNING: isosurface has %zu unpaired edges, skipping decimation\n", unpaired_before);
+        } else if (target_faces > 0) {
+            decimate_mesh(mesh, static_cast<size_t>(target_faces));
+        }
+        decimate_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - decimate_start).count() / 1000.0;
+
+        for (size_t i = 0; i < mesh.vertex_count(); ++i) {
+            mesh.positions[i * 3 + 1] = -mesh.positions[i * 3 + 1];
+            mesh.positions[i * 3 + 2] = -mesh.positions[i * 3 + 2];
+        }
+        vertices = mesh.vertex_count();
+        faces = mesh.face_count();
+        unpaired = unpaired_before > 0 ? unpaired_before : mesh.unpaired_edges();
+        if (extension == ".glb") {
+            mesh.write_glb(output_path);
+        } else {
+            mesh.write_obj(output_path);
+        }
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["splats"] = splats;
+    results["splats_used"] = stats.splats_used;
+    results["splats_too_large"] = stats.skipped_large;
+    results["grid"] = py::make_tuple(dims[0], dims[1], dims[2]);
+    results["voxel_size"] = voxel_size;
+    results["live_bricks"] = stats.live_bricks;
+    results["stored_bricks"] = stored_bricks;
+    results["hull_carved_bricks"] = stats.carved_bricks;
+    results["filled_samples"] = filled;
+    results["faces_before_decimation"] = faces_before;
+    results["vertices"] = vertices;
+    results["faces"] = faces;
+    results["unpaired_edges"] = unpaired;
+    results["images_without_mask"] = images_without_mask;
+    results["output_path"] = output_path;
+    results["density_time_ms"] = density_time_ms;
+    results["surface_time_ms"] = surface_time_ms;
+    results["decimate_time_ms"] = decimate_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat mesh results:\n");
+    printf("  splats: %zu, %zu splatted (%zu too large)\n", splats, stats.splats_used, stats.skipped_large);
+    printf("  grid: %dx%dx%d (voxel %.4g), bricks live %zu, stored %zu, hull carved %zu\n", dims[0], dims[1], dims[2],
+           voxel_size, stats.live_bricks, stored_bricks, stats.carved_bricks);
+    printf("  faces: %zu -> %zu, vertices %zu (filled %zu interior samples), %s\n", faces_before, faces, vertices, filled,
+           unpaired == 0 ? "closed manifold" : "NOT manifold");
+    printf("  total time: %.2f ms (density %.2f ms, marching cubes %.2f ms, decimation %.2f ms)\n",
+           processing_time_ms, density_time_ms, surface_time_ms, decimate_time_ms);
+    return results;
+}
+
+void register_splat_mesh(py::module_& m) {
+    m.def("export_splat_mesh", &export_splat_mesh,
+          "mesh a splat: sparse-grid gaussian density inside the mask hull, marching cubes, quadric decimation, .glb / .obj",
+          py::arg("ply_path"), py::arg("output_path"), py::arg("sparse_dir") = "", py::arg("mask_dir") = "",
+          py::arg("resolution") = 256, py::arg("iso_level") = 0.5, py::arg("target_faces") = 200000,
+          py::arg("min_opacity") = 0.05, py::arg("fill_interior") = true, py::arg("margin") = 2,
+          py::arg("max_misses") = 1);
+}
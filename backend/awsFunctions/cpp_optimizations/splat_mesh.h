@@ -0,0 +1,46 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * indexed triangle mesh with a colour per vertex. faces wind
+ * counter-clockwise seen from outside the surface
+ */
+struct TriangleMesh {
+    std::vector<float> positions;  // V x 3
+    std::vector<uint8_t> colors;   // V x 3, rgb
+    std::vector<uint32_t> faces;   // F x 3
+
+    size_t vertex_count() const { return positions.size() / 3; }
+    size_t face_count() const { return faces.size() / 3; }
+
+    // area-weighted vertex normals, V x 3
+    std::vector<float> vertex_normals() const;
+
+    /**
+     * directed edges that occur more than once or have no opposite twin:
+     * 0 iff the mesh is closed, edge-manifold and consistently wound
+     */
+    size_t unpaired_edges() const;
+
+    // wavefront obj, colours as the common "v x y z r g b" extension
+    void write_obj(const std::string& path) const;
+
+    // binary gltf 2.0: one primitive with POSITION, NORMAL, COLOR_0 and uint32 indices; throws on an empty mesh
+    void write_glb(const std::string& path) const;
+};
+
+/**
+ * quadric error metric edge collapse (garland & heckbert) down to at most
+ * target_faces: each collapse moves the kept vertex to the quadric-optimal
+ * point. collapses that would flip a face or break manifoldness (the link
+ * condition) are skipped; colours are interpolated along the edge. the
+ * mesh is compacted in place
+ */
+void decimate_mesh(TriangleMesh& mesh, size_t target_faces);
+
+void register_splat_mesh(pybind11::module_& m);
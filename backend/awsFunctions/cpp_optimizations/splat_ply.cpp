@@ -0,0 +1,528 @@
+#include "splat_ply.h"
+#include "mapped_file.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+
+// rows per block when interleaving for write: big enough to amortize the
+// parallel region, small enough that the staging buffer stays in L2 per thread
+static constexpr size_t WRITE_BLOCK_ROWS = 1 << 14;
+
+enum PlyType { PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 };
+
+struct PlyTypeName {
+    const char* name;
+    const char* alias;
+    PlyType type;
+    size_t size;
+};
+
+static const PlyTypeName PLY_TYPES[] = {
+    {"char", "int8", PLY_INT8, 1},
+    {"uchar", "uint8", PLY_UINT8, 1},
+    {"short", "int16", PLY_INT16, 2},
+    {"ushort", "uint16", PLY_UINT16, 2},
+    {"int", "int32", PLY_INT32, 4},
+    {"uint", "uint32", PLY_UINT32, 4},
+    {"float", "float32", PLY_FLOAT32, 4},
+    {"double", "float64", PLY_FLOAT64, 8},
+};
+
+static bool parse_ply_type(const std::string& name, PlyType& type, size_t& size) {
+    for (const auto& entry : PLY_TYPES) {
+        if (name == entry.name || name == entry.alias) {
+            type = entry.type;
+            size = entry.size;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+static inline float load_as_float(const uint8_t* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return static_cast<float>(value);
+}
+
+static inline float load_ply_value(const uint8_t* p, PlyType type) {
+    switch (type) {
+        case PLY_INT8: return load_as_float<int8_t>(p);
+        case PLY_UINT8: return load_as_float<uint8_t>(p);
+        case PLY_INT16: return load_as_float<int16_t>(p);
+        case PLY_UINT16: return load_as_float<uint16_t>(p);
+        case PLY_INT32: return load_as_float<int32_t>(p);
+        case PLY_UINT32: return load_as_float<uint32_t>(p);
+        case PLY_FLOAT32: return load_as_float<float>(p);
+        case PLY_FLOAT64: return load_as_float<double>(p);
+    }
+    return 0.0f;
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type;
+    size_t offset;
+};
+
+/**
+ * `length` properties starting at `offset` in the row -> dst[i * stride + k]
+ * adjacent float32 properties that land next to each other (x y z, the 45
+ * f_rest) merge into one run, so a brush row is a handful of memcpys
+ */
+struct SplatColumn {
+    size_t offset;
+    PlyType type;
+    float* dst;
+    size_t stride;
+    size_t length;
+};
+
+void SplatCloud::resize(size_t n, int degree) {
+    count = n;
+    sh_degree = degree;
+    positions.assign(n * 3, 0.0f);
+    scales.assign(n * 3, 0.0f);
+    rotations.assign(n * 4, 0.0f);
+    opacities.assign(n, 0.0f);
+    sh_dc.assign(n * 3, 0.0f);
+    sh_rest.assign(n * 3 * sh_rest_count(), 0.0f);
+}
+
+SplatCloud SplatCloud::gather(const std::vector<uint32_t>& indices) const {
+    SplatCloud out;
+    out.resize(indices.size(), sh_degree);
+    const size_t rest = static_cast<size_t>(3) * sh_rest_count();
+    const int64_t n = static_cast<int64_t>(indices.size());
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        const size_t s = indices[i];
+        std::copy_n(&positions[s * 3], 3, &out.positions[i * 3]);
+        std::copy_n(&scales[s * 3], 3, &out.scales[i * 3]);
+        std::copy_n(&rotations[s * 4], 4, &out.rotations[i * 4]);
+        out.opacities[i] = opacities[s];
+        std::copy_n(&sh_dc[s * 3], 3, &out.sh_dc[i * 3]);
+        std::copy_n(sh_rest.data() + s * rest, rest, out.sh_rest.data() + i * rest);
+    }
+    return out;
+}
+
+void quaternion_to_matrix(const float* q, double R[9]) {
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+    const double length = std::sqrt(w * w + x * x + y * y + z * z);
+    if (length > 0.0) {
+        w /= length;
+        x /= length;
+        y /= length;
+        z /= length;
+    } else {
+        w = 1.0;
+    }
+    R[0] = 1 - 2 * (y * y + z * z); R[1] = 2 * (x * y - w * z);     R[2] = 2 * (x * z + w * y);
+    R[3] = 2 * (x * y + w * z);     R[4] = 1 - 2 * (x * x + z * z); R[5] = 2 * (y * z - w * x);
+    R[6] = 2 * (x * z - w * y);     R[7] = 2 * (y * z + w * x);     R[8] = 1 - 2 * (x * x + y * y);
+}
+
+/**
+ * world covariance R S^2 R^T of a splat, packed xx xy xz yy yz zz
+ */
+void splat_covariance(const float* rotation, const float* log_scale, double cov[6]) {
+    double R[9];
+    quaternion_to_matrix(rotation, R);
+    const double s2[3] = {std::exp(2.0 * log_scale[0]), std::exp(2.0 * log_scale[1]), std::exp(2.0 * log_scale[2])};
+    static const int ROWS[6] = {0, 0, 0, 1, 1, 2};
+    static const int COLS[6] = {0, 1, 2, 1, 2, 2};
+    for (int e = 0; e < 6; ++e) {
+        const double* a = &R[ROWS[e] * 3];
+        const double* b = &R[COLS[e] * 3];
+        cov[e] = a[0] * s2[0] * b[0] + a[1] * s2[1] * b[1] + a[2] * s2[2] * b[2];
+    }
+}
+
+SplatCloud SplatCloud::read(const std::string& path) {
+    MappedFile file(path);
+    const char* text = reinterpret_cast<const char*>(file.data());
+
+    // header is ascii up to "end_header\n"
+    static const char END_HEADER[] = "end_header\n";
+    const size_t search = std::min(file.size(), static_cast<size_t>(1 << 16));
+    const std::string head(text, search);
+    const size_t end = head.find(END_HEADER);
+    if (head.compare(0, 4, "ply\n") != 0 || end == std::string::npos) {
+        throw std::runtime_error("Not a PLY file: " + path);
+    }
+    const size_t data_offset = end + sizeof(END_HEADER) - 1;
+
+    // only the vertex element is read; elements ahead of it are skipped by size
+    std::istringstream header(head.substr(0, end));
+    std::string line;
+    std::vector<PlyProperty> properties;
+    size_t vertex_count = 0, row_size = 0, skip_bytes = 0;
+    bool in_vertex = false, seen_vertex = false;
+    size_t element_count = 0, element_row = 0;
+
+    while (std::getline(header, line)) {
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            tokens >> format;
+            if (format != "binary_little_endian") {
+                throw std::runtime_error("Only binary_little_endian PLY is supported: " + path);
+            }
+        } else if (keyword == "element") {
+            if (!seen_vertex) {
+                skip_bytes += element_count * element_row;
+            }
+            std::string name;
+            tokens >> name >> element_count;
+            element_row = 0;
+            in_vertex = name == "vertex";
+            if (in_vertex) {
+                seen_vertex = true;
+                vertex_count = element_count;
+            }
+        } else if (keyword == "property") {
+            std::string type_name, name;
+            tokens >> type_name;
+            if (type_name == "list") {
+                if (in_vertex || !seen_vertex) {
+                    throw std::runtime_error("List properties before or in the vertex element are not supported: " + path);
+                }
+                continue;
+            }
+            tokens >> name;
+            PlyType type;
+            size_t size;
+            if (!parse_ply_type(type_name, type, size)) {
+                throw std::runtime_error("Unknown PLY property type '" + type_name + "' in " + path);
+            }
+            if (in_vertex) {
+                properties.push_back({name, type, row_size});
+                row_size += size;
+            }
+            element_row += size;
+        }
+    }
+    if (!seen_vertex || row_size == 0) {
+        throw std::runtime_error("PLY has no vertex element: " + path);
+    }
+    const size_t vertex_offset = data_offset + skip_bytes;
+    if (file.size() < vertex_offset + vertex_count * row_size) {
+        throw std::runtime_error("Truncated PLY file: " + path);
+    }
+
+    int rest_total = 0;
+    for (const auto& property : properties) {
+        rest_total += property.name.rfind("f_rest_", 0) == 0;
+    }
+    int degree = 0;
+    while (degree < 4 && 3 * ((degree + 1) * (degree + 1) - 1) < rest_total) {
+        ++degree;
+    }
+    if (3 * ((degree + 1) * (degree + 1) - 1) != rest_total) {
+        throw std::runtime_error("PLY has " + std::to_string(rest_total) + " f_rest properties, not a full SH degree: " + path);
+    }
+
+    SplatCloud cloud;
+    cloud.resize(vertex_count, degree);
+    // identity rotation for files without rot_*
+    for (size_t i = 0; i < vertex_count; ++i) {
+        cloud.rotations[i * 4] = 1.0f;
+    }
+
+    std::vector<SplatColumn> columns;
+    bool has_position[3] = {false, false, false};
+    const int rest = cloud.sh_rest_count();
+    for (const auto& property : properties) {
+        const std::string& name = property.name;
+        float* dst = nullptr;
+        size_t stride = 0;
+        auto indexed = [&](const char* prefix, int limit) {
+            const size_t len = std::strlen(prefix);
+            if (name.compare(0, len, prefix) != 0) {
+                return -1;
+            }
+            const int k = std::atoi(name.c_str() + len);
+            return (k >= 0 && k < limit) ? k : -1;
+        };
+        int k;
+        if (name == "x" || name == "y" || name == "z") {
+            const int axis = name[0] - 'x';
+            has_position[axis] = true;
+            dst = cloud.positions.data() + axis;
+            stride = 3;
+        } else if ((k = indexed("scale_", 3)) >= 0) {
+            dst = cloud.scales.data() + k;
+            stride = 3;
+        } else if ((k = indexed("rot_", 4)) >= 0) {
+            dst = cloud.rotations.data() + k;
+            stride = 4;
+        } else if (name == "opacity") {
+            dst = cloud.opacities.data();
+            stride = 1;
+        } else if ((k = indexed("f_dc_", 3)) >= 0) {
+            dst = cloud.sh_dc.data() + k;
+            stride = 3;
+        } else if ((k = indexed("f_rest_", 3 * rest)) >= 0) {
+            dst = cloud.sh_rest.data() + k;
+            stride = 3 * rest;
+        }
+        if (dst) {
+            SplatColumn* last = columns.empty() ? nullptr : &columns.back();
+            if (last && property.type == PLY_FLOAT32 && last->type == PLY_FLOAT32 && last->stride == stride &&
+                last->dst + last->length == dst && last->offset + last->length * sizeof(float) == property.offset) {
+                ++last->length;
+            } else {
+                columns.push_back({property.offset, property.type, dst, stride, 1});
+            }
+        }
+    }
+    if (!has_position[0] || !has_position[1] || !has_position[2]) {
+        throw std::runtime_error("PLY vertex element has no x / y / z: " + path);
+    }
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    // rows are read front to back per thread; columns scatter into the SoA arrays
+    const uint8_t* base = file.data() + vertex_offset;
+    const int64_t n = static_cast<int64_t>(vertex_count);
+    const SplatColumn* cols = columns.data();
+    const size_t num_cols = columns.size();
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        const uint8_t* row = base + static_cast<size_t>(i) * row_size;
+        for (size_t c = 0; c < num_cols; ++c) {
+            float* dst = cols[c].dst + static_cast<size_t>(i) * cols[c].stride;
+            if (cols[c].type == PLY_FLOAT32) {
+                std::memcpy(dst, row + cols[c].offset, cols[c].length * sizeof(float));
+            } else {
+                *dst = load_ply_value(row + cols[c].offset, cols[c].type);
+            }
+        }
+    }
+    return cloud;
+}
+
+void SplatCloud::write(const std::string& path) const {
+    const int rest = 3 * sh_rest_count();
+    const size_t floats_per_row = 3 + 3 + rest + 1 + 3 + 4;
+
+    std::ostringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n";
+    header << "element vertex " << count << "\n";
+    for (const char* axis : {"x", "y", "z"}) {
+        header << "property float " << axis << "\n";
+    }
+    for (int k = 0; k < 3; ++k) {
+        header << "property float f_dc_" << k << "\n";
+    }
+    for (int k = 0; k < rest; ++k) {
+        header << "property float f_rest_" << k << "\n";
+    }
+    header << "property float opacity\n";
+    for (int k = 0; k < 3; ++k) {
+        header << "property float scale_" << k << "\n";
+    }
+    for (int k = 0; k < 4; ++k) {
+        header << "property float rot_" << k << "\n";
+    }
+    header << "end_header\n";
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    const std::string header_text = header.str();
+    out.write(header_text.data(), header_text.size());
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    std::vector<float> block(WRITE_BLOCK_ROWS * floats_per_row);
+    for (size_t start = 0; start < count; start += WRITE_BLOCK_ROWS) {
+        const int64_t rows = static_cast<int64_t>(std::min(WRITE_BLOCK_ROWS, count - start));
+
+        #pragma omp parallel for schedule(static)
+        for (int64_t r = 0; r < rows; ++r) {
+            const size_t i = start + r;
+            float* dst = block.data() + static_cast<size_t>(r) * floats_per_row;
+            dst = std::copy_n(&positions[i * 3], 3, dst);
+            dst = std::copy_n(&sh_dc[i * 3], 3, dst);
+            dst = std::copy_n(sh_rest.data() + i * rest, rest, dst);
+            *dst++ = opacities[i];
+            dst = std::copy_n(&scales[i * 3], 3, dst);
+            std::copy_n(&rotations[i * 4], 4, dst);
+        }
+        out.write(reinterpret_cast<const char*>(block.data()), rows * floats_per_row * sizeof(float));
+    }
+    // close here so a failed flush throws instead of passing silently
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+/**
+ * c-contiguous float view over a cloud vector, kept alive by the python owner
+ */
+static py::array float_view(std::vector<float>& values, std::vector<ssize_t> shape, py::handle owner) {
+    std::vector<ssize_t> strides(shape.size());
+    ssize_t stride = static_cast<ssize_t>(sizeof(float));
+    for (size_t d = shape.size(); d-- > 0;) {
+        strides[d] = stride;
+        stride *= shape[d];
+    }
+    return py::array_t<float>(shape, strides, values.data(), owner);
+}
+
+/**
+ * index array or boolean mask -> validated splat indices
+ */
+static std::vector<uint32_t> indices_from_object(const SplatCloud& cloud, const py::array& selection) {
+    std::vector<uint32_t> indices;
+    if (selection.dtype().kind() == 'b') {
+        auto mask = py::array_t<bool, py::array::c_style | py::array::forcecast>::ensure(selection);
+        if (!mask || mask.ndim() != 1 || static_cast<size_t>(mask.shape(0)) != cloud.count) {
+            throw std::invalid_argument("mask must be a 1-d boolean array with one entry per splat");
+        }
+        const bool* m = mask.data();
+        for (size_t i = 0; i < cloud.count; ++i) {
+            if (m[i]) {
+                indices.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return indices;
+    }
+    auto index = py::array_t<int64_t, py::array::c_style | py::array::forcecast>::ensure(selection);
+    if (!index || index.ndim() != 1) {
+        throw std::invalid_argument("indices must be a 1-d integer array");
+    }
+    const int64_t* idx = index.data();
+    indices.resize(index.shape(0));
+    for (ssize_t i = 0; i < index.shape(0); ++i) {
+        if (idx[i] < 0 || static_cast<size_t>(idx[i]) >= cloud.count) {
+            throw std::invalid_argument("splat index out of range");
+        }
+        indices[i] = static_cast<uint32_t>(idx[i]);
+    }
+    return indices;
+}
+
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+static void copy_rows(const FloatArray& src, std::vector<float>& dst, size_t count, size_t width, const char* name) {
+    if (static_cast<size_t>(src.size()) != count * width || (src.ndim() > 0 && static_cast<size_t>(src.shape(0)) != count)) {
+        throw std::invalid_argument(std::string(name) + " must have shape (N, " + std::to_string(width) + ")");
+    }
+    std::copy_n(src.data(), count * width, dst.data());
+}
+
+static SplatCloud cloud_from_arrays(
+    const FloatArray& positions,
+    const FloatArray& scales,
+    const FloatArray& rotations,
+    const FloatArray& opacities,
+    const FloatArray& sh_dc,
+    const py::object& sh_rest
+) {
+    if (positions.ndim() != 2 || positions.shape(1) != 3) {
+        throw std::invalid_argument("positions must have shape (N, 3)");
+    }
+    const size_t n = static_cast<size_t>(positions.shape(0));
+
+    int degree = 0;
+    FloatArray rest;
+    if (!sh_rest.is_none()) {
+        rest = FloatArray::ensure(sh_rest);
+        if (!rest || rest.ndim() < 2 || static_cast<size_t>(rest.shape(0)) != n) {
+            throw std::invalid_argument("sh_rest must have shape (N, 3, K) or (N, 3K)");
+        }
+        const ssize_t per_splat = n > 0 ? rest.size() / static_cast<ssize_t>(n) : 0;
+        while (degree < 4 && 3 * ((degree + 1) * (degree + 1) - 1) < per_splat) {
+            ++degree;
+        }
+        if (3 * ((degree + 1) * (degree + 1) - 1) != per_splat) {
+            throw std::invalid_argument("sh_rest must hold a full SH degree (9, 24 or 45 values per splat)");
+        }
+    }
+
+    SplatCloud cloud;
+    cloud.resize(n, degree);
+    copy_rows(positions, cloud.positions, n, 3, "positions");
+    copy_rows(scales, cloud.scales, n, 3, "scales");
+    copy_rows(rotations, cloud.rotations, n, 4, "rotations");
+    copy_rows(opacities, cloud.opacities, n, 1, "opacities");
+    copy_rows(sh_dc, cloud.sh_dc, n, 3, "sh_dc");
+    if (degree > 0) {
+        std::copy_n(rest.data(), cloud.sh_rest.size(), cloud.sh_rest.data());
+    }
+    return cloud;
+}
+
+void register_splat_ply(py::module_& m) {
+    py::class_<SplatCloud>(m, "SplatCloud",
+        "gaussian splats as structure-of-arrays; attribute arrays are writable numpy views")
+        .def(py::init<>())
+        .def_static("read", &SplatCloud::read, "read a binary little-endian splat ply", py::arg("path"))
+        .def_static("from_arrays", &cloud_from_arrays,
+                    "build a cloud from numpy arrays (copied), sh_rest (N, 3, K) optional",
+                    py::arg("positions"), py::arg("scales"), py::arg("rotations"), py::arg("opacities"),
+                    py::arg("sh_dc"), py::arg("sh_rest") = py::none())
+        .def("write", &SplatCloud::write, "write float32 x y z f_dc f_rest opacity scale rot", py::arg("path"))
+        .def("subset", [](const SplatCloud& cloud, const py::array& selection) {
+            const std::vector<uint32_t> indices = indices_from_object(cloud, selection);
+            py::gil_scoped_release release;
+            return cloud.gather(indices);
+        }, "new cloud from a boolean mask or index array", py::arg("selection"))
+        .def("__len__", [](const SplatCloud& cloud) { return cloud.count; })
+        .def_property_readonly("count", [](const SplatCloud& cloud) { return cloud.count; })
+        .def_property_readonly("sh_degree", [](const SplatCloud& cloud) { return cloud.sh_degree; })
+        .def_property_readonly("positions", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.positions, {static_cast<ssize_t>(cloud.count), 3}, self);
+        })
+        .def_property_readonly("scales", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.scales, {static_cast<ssize_t>(cloud.count), 3}, self);
+        })
+        .def_property_readonly("rotations", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.rotations, {static_cast<ssize_t>(cloud.count), 4}, self);
+        })
+        .def_property_readonly("opacities", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.opacities, {static_cast<ssize_t>(cloud.count)}, self);
+        })
+        .def_property_readonly("sh_dc", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.sh_dc, {static_cast<ssize_t>(cloud.count), 3}, self);
+        })
+        .def_property_readonly("sh_rest", [](py::object self) {
+            SplatCloud& cloud = self.cast<SplatCloud&>();
+            return float_view(cloud.sh_rest, {static_cast<ssize_t>(cloud.count), 3, cloud.sh_rest_count()}, self);
+        });
+
+    m.def("read_splat_ply", &SplatCloud::read, "read a gaussian splat ply (brush export_*.ply)", py::arg("path"));
+}
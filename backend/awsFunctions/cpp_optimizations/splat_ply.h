@@ -0,0 +1,51 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * gaussian splats in the 3dgs / brush ply layout, as structure of arrays
+ * values are kept exactly as stored: log scales, logit opacity, unnormalized
+ * w x y z quaternions, sh coefficients with f_rest channel-major
+ * (all red coefficients, then green, then blue)
+ */
+struct SplatCloud {
+    size_t count = 0;
+    int sh_degree = 0;
+    std::vector<float> positions;  // N x 3
+    std::vector<float> scales;     // N x 3
+    std::vector<float> rotations;  // N x 4
+    std::vector<float> opacities;  // N
+    std::vector<float> sh_dc;      // N x 3
+    std::vector<float> sh_rest;    // N x 3 x sh_rest_count()
+
+    // higher-order coefficients per colour channel: 0, 3, 8, 15
+    int sh_rest_count() const { return (sh_degree + 1) * (sh_degree + 1) - 1; }
+
+    void resize(size_t n, int degree);
+
+    // new cloud holding splats[indices] in that order
+    SplatCloud gather(const std::vector<uint32_t>& indices) const;
+
+    /**
+     * binary little-endian ply, vertex element with any scalar property types;
+     * properties other than the gaussian attributes (normals etc.) are skipped
+     */
+    static SplatCloud read(const std::string& path);
+
+    // float32 x y z f_dc_* f_rest_* opacity scale_* rot_*, the layout brush exports
+    void write(const std::string& path) const;
+};
+
+// row-major rotation of a w x y z quaternion (normalized first; zero -> identity)
+void quaternion_to_matrix(const float* q, double R[9]);
+
+/**
+ * world covariance R S^2 R^T of a splat, packed xx xy xz yy yz zz
+ */
+void splat_covariance(const float* rotation, const float* log_scale, double cov[6]);
+
+void register_splat_ply(pybind11::module_& m);
@@ -0,0 +1,791 @@
+#include "splat_render.h"
+#include "colmap_model.h"
+#include "splat_sort.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+static constexpr int TILE_PIXELS = RENDER_TILE_SIZE * RENDER_TILE_SIZE;
+
+// splats closer than this (scene units) are dropped rather than blown up
+static constexpr double NEAR_PLANE = 0.01;
+
+// screen-space low-pass: every footprint is at least about a pixel wide
+static constexpr double DILATION = 0.3;
+
+// 3dgs compositing constants
+static constexpr float MIN_ALPHA = 1.0f / 255.0f;
+static constexpr float MAX_ALPHA = 0.99f;
+static constexpr float MIN_TRANSMITTANCE = 1e-4f;
+
+// splats composited between "is the tile opaque yet" checks
+static constexpr int TERMINATION_INTERVAL = 32;
+
+static constexpr float SH_C0 = 0.28209479177387814f;
+static constexpr float SH_C1 = 0.4886025119029199f;
+static constexpr float SH_C2[5] = {1.0925484305920792f, -1.0925484305920792f, 0.31539156525252005f,
+                                   -1.0925484305920792f, 0.5462742152960396f};
+static constexpr float SH_C3[7] = {-0.5900435899266435f, 2.890611442640554f, -0.4570457994644658f, 0.3731763325901154f,
+                                   -0.4570457994644658f, 1.445305721320277f, -0.5900435899266435f};
+
+/**
+ * rgb of one splat seen along the unit direction dir (camera -> splat),
+ * the 3dgs basis and +0.5 offset, clamped at zero. rest is channel-major
+ * with rest_count coefficients per channel, of which degree's are used
+ */
+static inline void evaluate_sh(const float* dc, const float* rest, int rest_count, int degree, const float dir[3], float rgb[3]) {
+    const float x = dir[0], y = dir[1], z = dir[2];
+    float basis[15];
+    if (degree >= 1) {
+        basis[0] = -SH_C1 * y;
+        basis[1] = SH_C1 * z;
+        basis[2] = -SH_C1 * x;
+    }
+    if (degree >= 2) {
+        const float xx = x * x, yy = y * y, zz = z * z;
+        basis[3] = SH_C2[0] * x * y;
+        basis[4] = SH_C2[1] * y * z;
+        basis[5] = SH_C2[2] * (2.0f * zz - xx - yy);
+        basis[6] = SH_C2[3] * x * z;
+        basis[7] = SH_C2[4] * (xx - yy);
+        if (degree >= 3) {
+            basis[8] = SH_C3[0] * y * (3.0f * xx - yy);
+            basis[9] = SH_C3[1] * x * y * z;
+            basis[10] = SH_C3[2] * y * (4.0f * zz - xx - yy);
+            basis[11] = SH_C3[3] * z * (2.0f * zz - 3.0f * xx - 3.0f * yy);
+            basis[12] = SH_C3[4] * x * (4.0f * zz - xx - yy);
+            basis[13] = SH_C3[5] * z * (xx - yy);
+            basis[14] = SH_C3[6] * x * (xx - 3.0f * yy);
+        }
+    }
+    const int used = (degree + 1) * (degree + 1) - 1;
+    for (int c = 0; c < 3; ++c) {
+        const float* coefficients = rest + c * rest_count;
+        float value = SH_C0 * dc[c] + 0.5f;
+        for (int k = 0; k < used; ++k) {
+            value += basis[k] * coefficients[k];
+        }
+        rgb[c] = std::max(value, 0.0f);
+    }
+}
+
+static inline uint8_t to_byte(float value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+SplatRenderer::SplatRenderer(const SplatCloud& cloud) : cloud_(&cloud) {
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    auto data = std::make_shared<CloudData>();
+    std::vector<float>& covariances = data->covariances;
+    std::vector<float>& opacities = data->opacities;
+    covariances.resize(n * 6);
+    opacities.resize(n);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        double cov[6];
+        splat_covariance(&cloud.rotations[i * 4], &cloud.scales[i * 3], cov);
+        for (int e = 0; e < 6; ++e) {
+            covariances[i * 6 + e] = static_cast<float>(cov[e]);
+        }
+        opacities[i] = 1.0f / (1.0f + std::exp(-cloud.opacities[i]));
+    }
+    data_ = std::move(data);
+}
+
+void SplatRenderer::project(const RenderCamera& camera) {
+    const double* R = camera.R;
+    const double* t = camera.t;
+    // camera centre -R^T t, origin of the sh view directions
+    double centre[3];
+    for (int k = 0; k < 3; ++k) {
+        centre[k] = -(R[k] * t[0] + R[3 + k] * t[1] + R[6 + k] * t[2]);
+    }
+    const int tiles_x = (camera.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    const int tiles_y = (camera.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    // the jacobian is taken at most 30% past the frustum, as in 3dgs, so
+    // splats far off-screen don't get huge footprints
+    const double limit_x = 1.3 * 0.5 * camera.width / camera.fx;
+    const double limit_y = 1.3 * 0.5 * camera.height / camera.fy;
+    const int degree = std::min(cloud_->sh_degree, 3);
+    const int rest_count = cloud_->sh_rest_count();
+
+    const int64_t n = static_cast<int64_t>(cloud_->count);
+    projected_.resize(n);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        ProjectedSplat& s = projected_[i];
+        s.tiles[0] = 1;
+        s.tiles[2] = 0;
+
+        const float* p = &cloud_->positions[i * 3];
+        const double xc = R[0] * p[0] + R[1] * p[1] + R[2] * p[2] + t[0];
+        const double yc = R[3] * p[0] + R[4] * p[1] + R[5] * p[2] + t[1];
+        const double zc = R[6] * p[0] + R[7] * p[1] + R[8] * p[2] + t[2];
+        if (zc < NEAR_PLANE) {
+            continue;
+        }
+
+        // T = J R: perspective jacobian at the centre times the view rotation
+        const double tx = std::min(std::max(xc / zc, -limit_x), limit_x) * zc;
+        const double ty = std::min(std::max(yc / zc, -limit_y), limit_y) * zc;
+        const double j00 = camera.fx / zc, j02 = -camera.fx * tx / (zc * zc);
+        const double j11 = camera.fy / zc, j12 = -camera.fy * ty / (zc * zc);
+        const double T0[3] = {j00 * R[0] + j02 * R[6], j00 * R[1] + j02 * R[7], j00 * R[2] + j02 * R[8]};
+        const double T1[3] = {j11 * R[3] + j12 * R[6], j11 * R[4] + j12 * R[7], j11 * R[5] + j12 * R[8]};
+
+        const float* c = &data_->covariances[i * 6];
+        const double S[3][3] = {{c[0], c[1], c[2]}, {c[1], c[3], c[4]}, {c[2], c[4], c[5]}};
+        double ST0[3], ST1[3];
+        for (int r = 0; r < 3; ++r) {
+            ST0[r] = S[r][0] * T0[0] + S[r][1] * T0[1] + S[r][2] * T0[2];
+            ST1[r] = S[r][0] * T1[0] + S[r][1] * T1[1] + S[r][2] * T1[2];
+        }
+        const double a = T0[0] * ST0[0] + T0[1] * ST0[1] + T0[2] * ST0[2] + DILATION;
+        const double b = T0[0] * ST1[0] + T0[1] * ST1[1] + T0[2] * ST1[2];
+        const double d = T1[0] * ST1[0] + T1[1] * ST1[1] + T1[2] * ST1[2] + DILATION;
+        const double det = a * d - b * b;
+        if (!(det > 0.0)) {
+            continue;
+        }
+
+        const double mid = 0.5 * (a + d);
+        const double lambda = mid + std::sqrt(std::max(0.1, mid * mid - det));
+        const double radius = std::ceil(3.0 * std::sqrt(lambda));
+        const double u = camera.fx * xc / zc + camera.cx;
+        const double v = camera.fy * yc / zc + camera.cy;
+        // clamp in double first: a splat near the plane can land far off-screen
+        const int x0 = static_cast<int>(std::max(0.0, std::floor((u - radius) / RENDER_TILE_SIZE)));
+        const int y0 = static_cast<int>(std::max(0.0, std::floor((v - radius) / RENDER_TILE_SIZE)));
+        const int x1 = static_cast<int>(std::min(tiles_x - 1.0, std::floor((u + radius) / RENDER_TILE_SIZE)));
+        const int y1 = static_cast<int>(std::min(tiles_y - 1.0, std::floor((v + radius) / RENDER_TILE_SIZE)));
+        if (x0 > x1 || y0 > y1) {
+            continue;
+        }
+
+        s.x = static_cast<float>(u);
+        s.y = static_cast<float>(v);
+        s.conic[0] = static_cast<float>(d / det);
+        s.conic[1] = static_cast<float>(-b / det);
+        s.conic[2] = static_cast<float>(a / det);
+        s.opacity = data_->opacities[i];
+        s.depth = static_cast<float>(zc);
+        s.radius = static_cast<float>(radius);
+        s.tiles[0] = x0;
+        s.tiles[1] = y0;
+        s.tiles[2] = x1;
+        s.tiles[3] = y1;
+
+        float dir[3] = {
+            static_cast<float>(p[0] - centre[0]),
+            static_cast<float>(p[1] - centre[1]),
+            static_cast<float>(p[2] - centre[2]),
+        };
+        const float length = std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+        for (int k = 0; k < 3; ++k) {
+            dir[k] /= length;
+        }
+        evaluate_sh(&cloud_->sh_dc[i * 3], cloud_->sh_rest.data() + i * 3 * rest_count, rest_count, degree, dir, s.color);
+    }
+}
+
+void SplatRenderer::sort_by_depth() {
+    order_.clear();
+    for (size_t i = 0; i < projected_.size(); ++i) {
+        if (projected_[i].tiles[0] <= projected_[i].tiles[2]) {
+            order_.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    // depths are positive, and positive floats order like their bit patterns
+    depth_keys_.resize(order_.size());
+    for (size_t j = 0; j < order_.size(); ++j) {
+        uint32_t bits;
+        std::memcpy(&bits, &projected_[order_[j]].depth, sizeof(bits));
+        depth_keys_[j] = bits;
+    }
+    radix_sort(depth_keys_, order_, 32);
+}
+
+/**
+ * bucket the depth-sorted splats by tile. each thread counts its own run of
+ * order_, offsets go tile-major then thread-minor, and the scatter keeps
+ * the input order: every tile's list comes out front to back without a
+ * per-tile sort
+ */
+void SplatRenderer::bin_tiles(int tiles_x, int tiles_y) {
+    const size_t num_tiles = static_cast<size_t>(tiles_x) * tiles_y;
+    const int64_t n = static_cast<int64_t>(order_.size());
+    int blocks = 1;
+    #ifdef _OPENMP
+    blocks = omp_get_max_threads();
+    #endif
+    const int64_t block_size = (n + blocks - 1) / blocks;
+    std::vector<uint32_t>& counts = bin_counts_;
+    counts.assign(num_tiles * blocks, 0);
+
+    auto for_block_tiles = [&](int block, auto&& visit) {
+        const int64_t end = std::min(n, (block + 1) * block_size);
+        for (int64_t j = block * block_size; j < end; ++j) {
+            const ProjectedSplat& s = projected_[order_[j]];
+            for (int ty = s.tiles[1]; ty <= s.tiles[3]; ++ty) {
+                for (int tx = s.tiles[0]; tx <= s.tiles[2]; ++tx) {
+                    visit(static_cast<size_t>(ty) * tiles_x + tx, order_[j]);
+                }
+            }
+        }
+    };
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int block = 0; block < blocks; ++block) {
+        uint32_t* count = &counts[block * num_tiles];
+        for_block_tiles(block, [&](size_t tile, uint32_t) { ++count[tile]; });
+    }
+
+    tile_offsets_.assign(num_tiles + 1, 0);
+    size_t total = 0;
+    for (size_t tile = 0; tile < num_tiles; ++tile) {
+        tile_offsets_[tile] = static_cast<uint32_t>(total);
+        for (int block = 0; block < blocks; ++block) {
+            const uint32_t count = counts[block * num_tiles + tile];
+            counts[block * num_tiles + tile] = static_cast<uint32_t>(total);
+            total += count;
+        }
+    }
+    if (total > UINT32_MAX) {
+        throw std::runtime_error("Too many splat x tile pairs to render");
+    }
+    tile_offsets_[num_tiles] = static_cast<uint32_t>(total);
+    tile_splats_.resize(total);
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int block = 0; block < blocks; ++block) {
+        uint32_t* next = &counts[block * num_tiles];
+        for_block_tiles(block, [&](size_t tile, uint32_t splat) { tile_splats_[next[tile]++] = splat; });
+    }
+}
+
+void SplatRenderer::rasterize(const RenderCamera& camera, int tiles_x, int tiles_y, const float background[3], cv::Mat& image) const {
+    const int num_tiles = tiles_x * tiles_y;
+
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int tile = 0; tile < num_tiles; ++tile) {
+        const int tile_x = (tile % tiles_x) * RENDER_TILE_SIZE;
+        const int tile_y = (tile / tiles_x) * RENDER_TILE_SIZE;
+
+        alignas(32) float px[TILE_PIXELS], py[TILE_PIXELS];
+        alignas(32) float transmittance[TILE_PIXELS], red[TILE_PIXELS], green[TILE_PIXELS], blue[TILE_PIXELS];
+        for (int p = 0; p < TILE_PIXELS; ++p) {
+            px[p] = tile_x + p % RENDER_TILE_SIZE + 0.5f;
+            py[p] = tile_y + p / RENDER_TILE_SIZE + 0.5f;
+            transmittance[p] = 1.0f;
+            red[p] = green[p] = blue[p] = 0.0f;
+        }
+
+        const uint32_t begin = tile_offsets_[tile];
+        const uint32_t end = tile_offsets_[tile + 1];
+        for (uint32_t k = begin; k < end; ++k) {
+            const ProjectedSplat& s = projected_[tile_splats_[k]];
+            const float sx = s.x, sy = s.y;
+            const float ca = s.conic[0], cb = s.conic[1], cc = s.conic[2];
+            const float opacity = s.opacity;
+            const float r = s.color[0], g = s.color[1], b = s.color[2];
+
+            // most splats are a few pixels wide: only the rows whose centres
+            // fall inside the footprint, each a full 16-wide simd row
+            const int row_begin = std::max(0, static_cast<int>(std::ceil(sy - s.radius - 0.5f)) - tile_y);
+            const int row_end = std::min(RENDER_TILE_SIZE - 1, static_cast<int>(std::floor(sy + s.radius - 0.5f)) - tile_y);
+            for (int row = row_begin; row <= row_end; ++row) {
+                const int first = row * RENDER_TILE_SIZE;
+                #pragma omp simd aligned(px, py, transmittance, red, green, blue : 32)
+                for (int p = first; p < first + RENDER_TILE_SIZE; ++p) {
+                    const float dx = px[p] - sx;
+                    const float dy = py[p] - sy;
+                    const float power = -0.5f * (ca * dx * dx + cc * dy * dy) - cb * dx * dy;
+                    float alpha = std::min(MAX_ALPHA, opacity * std::exp(power));
+                    alpha = alpha >= MIN_ALPHA ? alpha : 0.0f;
+                    const float weight = alpha * transmittance[p];
+                    red[p] += r * weight;
+                    green[p] += g * weight;
+                    blue[p] += b * weight;
+                    transmittance[p] -= weight;
+                }
+            }
+
+            if ((k - begin) % TERMINATION_INTERVAL == TERMINATION_INTERVAL - 1) {
+                float remaining = 0.0f;
+                #pragma omp simd reduction(max : remaining)
+                for (int p = 0; p < TILE_PIXELS; ++p) {
+                    remaining = std::max(remaining, transmittance[p]);
+                }
+                if (remaining < MIN_TRANSMITTANCE) {
+                    break;
+                }
+            }
+        }
+
+        const int rows = std::min(RENDER_TILE_SIZE, camera.height - tile_y);
+        const int cols = std::min(RENDER_TILE_SIZE, camera.width - tile_x);
+        for (int row = 0; row < rows; ++row) {
+            uint8_t* out = image.ptr<uint8_t>(tile_y + row) + tile_x * 3;
+            for (int col = 0; col < cols; ++col) {
+                const int p = row * RENDER_TILE_SIZE + col;
+                out[col * 3 + 0] = to_byte(blue[p] + transmittance[p] * background[2]);
+                out[col * 3 + 1] = to_byte(green[p] + transmittance[p] * background[1]);
+                out[col * 3 + 2] = to_byte(red[p] + transmittance[p] * background[0]);
+            }
+        }
+    }
+}
+
+cv::Mat SplatRenderer::render(const RenderCamera& camera, const float background[3]) {
+    if (camera.width <= 0 || camera.height <= 0 || !(camera.fx > 0.0) || !(camera.fy > 0.0)) {
+        throw std::invalid_argument("render camera needs a positive size and focal length");
+    }
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    const int tiles_x = (camera.width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    const int tiles_y = (camera.height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    project(camera);
+    sort_by_depth();
+    bin_tiles(tiles_x, tiles_y);
+
+    cv::Mat image(camera.height, camera.width, CV_8UC3);
+    rasterize(camera, tiles_x, tiles_y, background, image);
+    return image;
+}
+
+RenderCamera colmap_render_camera(const ColmapCamera& colmap_camera, const ColmapImage& image, int max_size) {
+    const double longest = static_cast<double>(std::max(colmap_camera.width, colmap_camera.height));
+    const double scale = std::min(1.0, max_size / longest);
+    RenderCamera camera;
+    camera.width = std::max(1, static_cast<int>(std::lround(colmap_camera.width * scale)));
+    camera.height = std::max(1, static_cast<int>(std::lround(colmap_camera.height * scale)));
+    double fx, fy, cx, cy;
+    camera_intrinsics(colmap_camera, fx, fy, cx, cy);
+    const double sx = static_cast<double>(camera.width) / colmap_camera.width;
+    const double sy = static_cast<double>(camera.height) / colmap_camera.height;
+    camera.fx = fx * sx;
+    camera.fy = fy * sy;
+    camera.cx = cx * sx;
+    camera.cy = cy * sy;
+    image_rotation(image, camera.R);
+    std::copy_n(image.tvec, 3, camera.t);
+    return camera;
+}
+
+/**
+ * render a trained splat from one of its colmap views to a jpeg, the job
+ * thumbnail. image_index picks the view in images.bin order
+ */
+static py::dict render_splat_thumbnail(
+    const std::string& ply_path,
+    const std::string& sparse_dir,
+    const std::string& output_path,
+    int image_index,
+    int max_size,
+    int background,
+    int quality
+) {
+    if (max_size < 1) {
+        throw std::invalid_argument("max_size must be >= 1");
+    }
+    if (background < 0 || background > 255) {
+        throw std::invalid_argument("background must be in [0, 255]");
+    }
+    if (quality < 1 || quality > 100) {
+        throw std::invalid_argument("quality must be in [1, 100]");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    RenderCamera camera;
+    std::string image_name;
+    size_t count = 0, visible = 0, tile_entries = 0;
+    double render_time_ms = 0.0;
+    {
+        py::gil_scoped_release release;
+
+        const ColmapModel model = ColmapModel::read(sparse_dir);
+        if (image_index < 0 || image_index >= static_cast<int>(model.images.size())) {
+            throw std::invalid_argument("image_index " + std::to_string(image_index) + " out of range for " +
+                                        std::to_string(model.images.size()) + " images in " + sparse_dir);
+        }
+        const ColmapImage& image = model.images[image_index];
+        const ColmapCamera* colmap_camera = model.find_camera(image.camera_id);
+        if (!colmap_camera || colmap_camera->width == 0 || colmap_camera->height == 0) {
+            throw std::runtime_error("No usable camera for image " + model.image_names[image_index]);
+        }
+        camera = colmap_render_camera(*colmap_camera, image, max_size);
+        image_name = model.image_names[image_index];
+
+        const SplatCloud cloud = SplatCloud::read(ply_path);
+        auto render_start = std::chrono::high_resolution_clock::now();
+        SplatRenderer renderer(cloud);
+        const float level = background / 255.0f;
+        const float rgb[3] = {level, level, level};
+        const cv::Mat frame = renderer.render(camera, rgb);
+        render_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - render_start).count() / 1000.0;
+
+        const fs::path parent = fs::path(output_path).parent_path();
+        if (!parent.empty()) {
+            fs::create_directories(parent);
+        }
+        if (!cv::imwrite(output_path, frame, {cv::IMWRITE_JPEG_QUALITY, quality})) {
+            throw std::runtime_error("Failed writing " + output_path);
+        }
+        count = cloud.count;
+        visible = renderer.visible();
+        tile_entries = renderer.tile_entries();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["output_path"] = output_path;
+    results["image_name"] = image_name;
+    results["width"] = camera.width;
+    results["height"] = camera.height;
+    results["splats"] = count;
+    results["visible"] = visible;
+    results["tile_entries"] = tile_entries;
+    results["render_time_ms"] = render_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat thumbnail results:\n");
+    printf("  view: %s at %dx%d\n", image_name.c_str(), camera.width, camera.height);
+    printf("  splats: %zu visible of %zu, %zu tile entries\n", visible, count, tile_entries);
+    printf("  total time: %.2f ms (render %.2f ms)\n", processing_time_ms, render_time_ms);
+    return results;
+}
+
+// turntable framing: vertical field of view, the share of splats (by
+// distance from the median centre) the bounding sphere must hold, and the
+// room left around it
+static constexpr double TURNTABLE_FOV_DEG = 40.0;
+static constexpr double TURNTABLE_SPHERE_QUANTILE = 0.95;
+static constexpr double TURNTABLE_MARGIN = 1.15;
+
+static inline void normalize3(double v[3]) {
+    const double length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length > 0.0) {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+}
+
+static inline void cross3(const double a[3], const double b[3], double out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/**
+ * circle the camera travels: around the splat's bounding sphere (per-axis
+ * median centre, TURNTABLE_SPHERE_QUANTILE radius, so leftover floaters
+ * don't zoom the object out), in the plane of the capture orbit
+ */
+struct TurntableOrbit {
+    double centre[3] = {0, 0, 0};
+    double radius = 1.0;
+    double up[3] = {0, -1, 0};   // colmap cameras are y-down
+    double start[3] = {0, 0, -1};  // unit, perpendicular to up: where frame 0 looks from
+};
+
+static TurntableOrbit turntable_orbit(const SplatCloud& cloud, const ColmapModel* model) {
+    TurntableOrbit orbit;
+    const size_t n = cloud.count;
+    std::vector<float> values(n);
+    for (int k = 0; k < 3; ++k) {
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = cloud.positions[i * 3 + k];
+        }
+        std::nth_element(values.begin(), values.begin() + n / 2, values.end());
+        orbit.centre[k] = values[n / 2];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = cloud.positions[i * 3 + 0] - orbit.centre[0];
+        const double dy = cloud.positions[i * 3 + 1] - orbit.centre[1];
+        const double dz = cloud.positions[i * 3 + 2] - orbit.centre[2];
+        values[i] = static_cast<float>(std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+    const size_t quantile = std::min(n - 1, static_cast<size_t>(TURNTABLE_SPHERE_QUANTILE * n));
+    std::nth_element(values.begin(), values.begin() + quantile, values.end());
+    orbit.radius = std::max(static_cast<double>(values[quantile]), 1e-6);
+
+    double start[3] = {0, 0, 0};
+    if (model && !model->images.empty()) {
+        // the capture cameras are held upright: their mean up is the scene's
+        double up[3] = {0, 0, 0};
+        for (const ColmapImage& image : model->images) {
+            double R[9];
+            image_rotation(image, R);
+            for (int k = 0; k < 3; ++k) {
+                up[k] -= R[3 + k];
+            }
+        }
+        normalize3(up);
+        std::copy_n(up, 3, orbit.up);
+        double first[3];
+        image_center(model->images[0], first);
+        for (int k = 0; k < 3; ++k) {
+            start[k] = first[k] - orbit.centre[k];
+        }
+    } else {
+        std::copy_n(orbit.start, 3, start);
+    }
+    // start direction projected into the orbit plane (any perpendicular if degenerate)
+    const double along = start[0] * orbit.up[0] + start[1] * orbit.up[1] + start[2] * orbit.up[2];
+    for (int k = 0; k < 3; ++k) {
+        start[k] -= along * orbit.up[k];
+    }
+    if (start[0] * start[0] + start[1] * start[1] + start[2] * start[2] < 1e-12) {
+        const double axis[3] = {std::fabs(orbit.up[0]) < 0.9 ? 1.0 : 0.0, std::fabs(orbit.up[0]) < 0.9 ? 0.0 : 1.0, 0.0};
+        cross3(orbit.up, axis, start);
+    }
+    normalize3(start);
+    std::copy_n(start, 3, orbit.start);
+    return orbit;
+}
+
+/**
+ * frame of frames around the orbit at elevation_deg above its plane, the
+ * bounding sphere (plus margin) filling a size x size view
+ */
+static RenderCamera turntable_camera(const TurntableOrbit& orbit, int frame, int frames, double elevation_deg, int size) {
+    const double half_fov = 0.5 * TURNTABLE_FOV_DEG * M_PI / 180.0;
+    const double distance = TURNTABLE_MARGIN * orbit.radius / std::sin(half_fov);
+    const double azimuth = 2.0 * M_PI * frame / frames;
+    const double elevation = elevation_deg * M_PI / 180.0;
+
+    double side[3];
+    cross3(orbit.up, orbit.start, side);
+    double eye[3];
+    for (int k = 0; k < 3; ++k) {
+        const double ring = std::cos(azimuth) * orbit.start[k] + std::sin(azimuth) * side[k];
+        eye[k] = orbit.centre[k] + distance * (std::cos(elevation) * ring + std::sin(elevation) * orbit.up[k]);
+    }
+
+    // camera axes as rows of R: x right, y down, z forward (colmap)
+    double z[3] = {orbit.centre[0] - eye[0], orbit.centre[1] - eye[1], orbit.centre[2] - eye[2]};
+    normalize3(z);
+    const double up_along = orbit.up[0] * z[0] + orbit.up[1] * z[1] + orbit.up[2] * z[2];
+    double y[3] = {-(orbit.up[0] - up_along * z[0]), -(orbit.up[1] - up_along * z[1]), -(orbit.up[2] - up_along * z[2])};
+    normalize3(y);
+    double x[3];
+    cross3(y, z, x);
+
+    RenderCamera camera;
+    camera.width = camera.height = size;
+    camera.fx = camera.fy = 0.5 * size / std::tan(half_fov);
+    camera.cx = camera.cy = 0.5 * size;
+    for (int k = 0; k < 3; ++k) {
+        camera.R[k] = x[k];
+        camera.R[3 + k] = y[k];
+        camera.R[6 + k] = z[k];
+    }
+    for (int r = 0; r < 3; ++r) {
+        camera.t[r] = -(camera.R[r * 3 + 0] * eye[0] + camera.R[r * 3 + 1] * eye[1] + camera.R[r * 3 + 2] * eye[2]);
+    }
+    return camera;
+}
+
+/**
+ * raw bgr24 frames piped into an ffmpeg child (h.264, yuv420p, faststart),
+ * so no intermediate images touch the disk
+ */
+class VideoPipe {
+public:
+    VideoPipe(const std::string& path, int width, int height, int fps, int crf) : path_(path) {
+        // single-quote the path for the shell, closing and escaping embedded quotes
+        std::string quoted = "'";
+        for (char c : path) {
+            quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+        }
+        quoted += "'";
+        const std::string command = "ffmpeg -y -loglevel error -f rawvideo -pix_fmt bgr24 -s " +
+                                    std::to_string(width) + "x" + std::to_string(height) + " -r " + std::to_string(fps) +
+                                    " -i - -c:v libx264 -preset veryfast -crf " + std::to_string(crf) +
+                                    " -pix_fmt yuv420p -movflags +faststart " + quoted;
+        pipe_ = popen(command.c_str(), "w");
+        if (!pipe_) {
+            throw std::runtime_error("Could not start ffmpeg for " + path);
+        }
+    }
+
+    ~VideoPipe() {
+        if (pipe_) {
+            pclose(pipe_);
+        }
+    }
+
+    void write(const cv::Mat& frame) {
+        for (int y = 0; y < frame.rows; ++y) {
+            const size_t row_bytes = static_cast<size_t>(frame.cols) * 3;
+            if (fwrite(frame.ptr<uint8_t>(y), 1, row_bytes, pipe_) != row_bytes) {
+                throw std::runtime_error("ffmpeg stopped accepting frames for " + path_);
+            }
+        }
+    }
+
+    void close() {
+        const int status = pclose(pipe_);
+        pipe_ = nullptr;
+        if (status != 0) {
+            throw std::runtime_error("ffmpeg failed writing " + path_);
+        }
+    }
+
+private:
+    std::string path_;
+    FILE* pipe_ = nullptr;
+};
+
+/**
+ * orbit video of a trained splat, the job's preview. frames render in
+ * parallel, each thread with its own renderer over the shared per-cloud
+ * data (so thread k draws frames k, k + threads, ...), and go to ffmpeg in
+ * order after every batch. sparse_dir (optional) sets the orbit's up axis
+ * and start from the capture cameras
+ */
+static py::dict render_splat_turntable(
+    const std::string& ply_path,
+    const std::string& output_path,
+    const std::string& sparse_dir,
+    int frames,
+    int size,
+    int fps,
+    double elevation,
+    int background,
+    int crf
+) {
+    if (frames < 1 || fps < 1) {
+        throw std::invalid_argument("frames and fps must be >= 1");
+    }
+    if (size < 16) {
+        throw std::invalid_argument("size must be >= 16");
+    }
+    if (elevation <= -90.0 || elevation >= 90.0) {
+        throw std::invalid_argument("elevation must be in (-90, 90) degrees");
+    }
+    if (background < 0 || background > 255) {
+        throw std::invalid_argument("background must be in [0, 255]");
+    }
+    if (crf < 0 || crf > 51) {
+        throw std::invalid_argument("crf must be in [0, 51]");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    // yuv420p needs even dimensions
+    const int frame_size = size + (size & 1);
+    size_t count = 0;
+    double render_time_ms = 0.0;
+    {
+        py::gil_scoped_release release;
+
+        const SplatCloud cloud = SplatCloud::read(ply_path);
+        if (cloud.count == 0) {
+            throw std::runtime_error("No splats in " + ply_path);
+        }
+        count = cloud.count;
+        ColmapModel model;
+        if (!sparse_dir.empty()) {
+            model = ColmapModel::read(sparse_dir);
+        }
+        const TurntableOrbit orbit = turntable_orbit(cloud, sparse_dir.empty() ? nullptr : &model);
+
+        const fs::path parent = fs::path(output_path).parent_path();
+        if (!parent.empty()) {
+            fs::create_directories(parent);
+        }
+        VideoPipe video(output_path, frame_size, frame_size, fps, crf);
+
+        int threads = 1;
+        #ifdef _OPENMP
+        threads = std::min(4, omp_get_max_threads());
+        #endif
+        auto render_start = std::chrono::high_resolution_clock::now();
+        const SplatRenderer renderer(cloud);
+        std::vector<SplatRenderer> renderers(threads, renderer);
+        std::vector<cv::Mat> batch(threads);
+        const float level = background / 255.0f;
+        const float rgb[3] = {level, level, level};
+
+        for (int first = 0; first < frames; first += threads) {
+            const int batch_size = std::min(threads, frames - first);
+            // an exception can't leave an omp region (it would terminate the
+            // worker): keep the first one and rethrow once the batch is done
+            std::exception_ptr failure;
+            // static, 1: thread k always takes renderers[k]
+            #pragma omp parallel for schedule(static, 1) num_threads(threads)
+            for (int k = 0; k < batch_size; ++k) {
+                try {
+                    batch[k] = renderers[k].render(turntable_camera(orbit, first + k, frames, elevation, frame_size), rgb);
+                } catch (...) {
+                    #pragma omp critical(turntable_failure)
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                }
+            }
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+            for (int k = 0; k < batch_size; ++k) {
+                video.write(batch[k]);
+            }
+        }
+        render_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - render_start).count() / 1000.0;
+        video.close();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["output_path"] = output_path;
+    results["frames"] = frames;
+    results["width"] = frame_size;
+    results["height"] = frame_size;
+    results["fps"] = fps;
+    results["splats"] = count;
+    results["render_time_ms"] = render_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat turntable results:\n");
+    printf("  frames: %d at %dx%d, %d fps, %zu splats\n", frames, frame_size, frame_size, fps, count);
+    printf("  render: %.2f ms per frame\n", render_time_ms / frames);
+    printf("  total time: %.2f ms (render + encode %.2f ms)\n", processing_time_ms, render_time_ms);
+    return results;
+}
+
+void register_splat_render(py::module_& m) {
+    m.def("render_splat_thumbnail", &render_splat_thumbnail,
+          "rasterize a splat ply on the cpu from one of its colmap views and write a jpeg",
+          py::arg("ply_path"), py::arg("sparse_dir"), py::arg("output_path"), py::arg("image_index") = 0,
+          py::arg("max_size") = 512, py::arg("background") = 255, py::arg("quality") = 90);
+    m.def("render_splat_turntable", &render_splat_turntable,
+          "render an orbit around a splat ply on the cpu and encode it with ffmpeg (h.264 mp4)",
+          py::arg("ply_path"), py::arg("output_path"), py::arg("sparse_dir") = "", py::arg("frames") = 120,
+          py::arg("size") = 512, py::arg("fps") = 30, py::arg("elevation") = 20.0, py::arg("background") = 255,
+          py::arg("crf") = 23);
+}
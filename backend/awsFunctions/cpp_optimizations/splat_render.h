@@ -0,0 +1,97 @@
+#pragma once
+
+#include "splat_ply.h"
+
+#include <opencv2/opencv.hpp>
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// screen tiles are 16 x 16 pixels, one compositing job each
+static constexpr int RENDER_TILE_SIZE = 16;
+
+/**
+ * pinhole view to render: world -> camera rotation (row-major) and
+ * translation as colmap stores them, pixel centres at +0.5
+ */
+struct RenderCamera {
+    int width = 0;
+    int height = 0;
+    double fx = 0.0, fy = 0.0, cx = 0.0, cy = 0.0;
+    double R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    double t[3] = {0, 0, 0};
+};
+
+/**
+ * a splat after projection: pixel centre, inverse 2d covariance (conic),
+ * view-dependent colour and the tiles its 3 sigma footprint touches
+ */
+struct ProjectedSplat {
+    float x, y;
+    float conic[3];  // xx xy yy
+    float opacity;
+    float color[3];  // rgb, sh evaluated towards the camera
+    float depth;
+    float radius;    // 3 sigma of the major axis, pixels
+    int tiles[4];    // x0 y0 x1 y1 inclusive, x0 > x1 when culled
+};
+
+/**
+ * cpu gaussian-splat rasterizer (the 3dgs forward pass): ewa projection of
+ * the 3d covariances, sh up to degree 3, front-to-back depth order, tile
+ * binning, then per tile a simd alpha-compositing loop over the tile rows
+ * each splat's footprint covers, with early termination once every pixel
+ * is opaque
+ *
+ * world covariances and sigmoid opacities are computed once, so rendering
+ * several views of the same cloud only pays for projection and compositing.
+ * the per-view buffers (projections, depth order, tile lists) are kept and
+ * reused by the next render. copies share the per-cloud data but not the
+ * buffers: one copy per thread renders views in parallel. the cloud must
+ * outlive the renderer
+ */
+class SplatRenderer {
+public:
+    explicit SplatRenderer(const SplatCloud& cloud);
+
+    // 8-bit bgr image, composited over the rgb background (0..1)
+    cv::Mat render(const RenderCamera& camera, const float background[3]);
+
+    // splats inside the frustum in the last render
+    size_t visible() const { return order_.size(); }
+    // splat x tile pairs composited in the last render
+    size_t tile_entries() const { return tile_splats_.size(); }
+
+private:
+    void project(const RenderCamera& camera);
+    void sort_by_depth();
+    void bin_tiles(int tiles_x, int tiles_y);
+    void rasterize(const RenderCamera& camera, int tiles_x, int tiles_y, const float background[3], cv::Mat& image) const;
+
+    struct CloudData {
+        std::vector<float> covariances;  // N x 6 world covariance, xx xy xz yy yz zz
+        std::vector<float> opacities;    // N, after the sigmoid
+    };
+
+    const SplatCloud* cloud_;
+    std::shared_ptr<const CloudData> data_;
+    std::vector<ProjectedSplat> projected_;  // N, per render
+    std::vector<uint32_t> order_;            // visible splats, front to back
+    std::vector<uint64_t> depth_keys_;       // radix sort keys for order_
+    std::vector<uint32_t> bin_counts_;       // per thread block x tile
+    std::vector<uint32_t> tile_offsets_;     // tile t owns tile_splats_[offsets[t], offsets[t + 1])
+    std::vector<uint32_t> tile_splats_;      // splat indices, front to back within a tile
+};
+
+struct ColmapCamera;
+struct ColmapImage;
+
+/**
+ * the pinhole part of a colmap view, scaled so the longer side is at most
+ * max_size. lens distortion is ignored: fine for a preview
+ */
+RenderCamera colmap_render_camera(const ColmapCamera& colmap_camera, const ColmapImage& image, int max_size);
+
+void register_splat_render(pybind11::module_& m);
@@ -0,0 +1,267 @@
+#include "splat_sort.h"
+#include "splat_compress.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+static constexpr int RADIX_BITS = 8;
+static constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
+
+static inline uint64_t spread_bits_21(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | (v << 32)) & 0x001f00000000ffffull;
+    v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+    v = (v | (v << 8)) & 0x100f00f00f00f00full;
+    v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+uint64_t morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+    return (spread_bits_21(x) << 2) | (spread_bits_21(y) << 1) | spread_bits_21(z);
+}
+
+std::vector<uint64_t> morton_codes(const SplatCloud& cloud) {
+    const int64_t n = static_cast<int64_t>(cloud.count);
+    const float* p = cloud.positions.data();
+
+    float lo[3], hi[3];
+    for (int a = 0; a < 3; ++a) {
+        float axis_lo = std::numeric_limits<float>::max();
+        float axis_hi = std::numeric_limits<float>::lowest();
+        #pragma omp parallel for simd reduction(min:axis_lo) reduction(max:axis_hi)
+        for (int64_t i = 0; i < n; ++i) {
+            axis_lo = std::min(axis_lo, p[i * 3 + a]);
+            axis_hi = std::max(axis_hi, p[i * 3 + a]);
+        }
+        lo[a] = axis_lo;
+        hi[a] = axis_hi;
+    }
+
+    const double cells = static_cast<double>((1u << MORTON_AXIS_BITS) - 1);
+    double scale[3];
+    for (int a = 0; a < 3; ++a) {
+        scale[a] = hi[a] > lo[a] ? cells / (static_cast<double>(hi[a]) - lo[a]) : 0.0;
+    }
+
+    std::vector<uint64_t> codes(n);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < n; ++i) {
+        uint32_t cell[3];
+        for (int a = 0; a < 3; ++a) {
+            cell[a] = static_cast<uint32_t>(std::clamp((p[i * 3 + a] - lo[a]) * scale[a], 0.0, cells));
+        }
+        codes[i] = morton_encode(cell[0], cell[1], cell[2]);
+    }
+    return codes;
+}
+
+void radix_sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int key_bits) {
+    const size_t n = keys.size();
+    std::vector<uint64_t> keys_out(n);
+    std::vector<uint32_t> values_out(n);
+
+    #ifdef _OPENMP
+    const int num_blocks = std::min(4, omp_get_max_threads());
+    #else
+    const int num_blocks = 1;
+    #endif
+    // histogram[block][digit] -> scatter offset of that block's first key with the digit
+    std::vector<size_t> histogram(static_cast<size_t>(num_blocks) * RADIX_BUCKETS);
+
+    for (int shift = 0; shift < key_bits; shift += RADIX_BITS) {
+        std::fill(histogram.begin(), histogram.end(), 0);
+
+        #pragma omp parallel for schedule(static, 1) num_threads(num_blocks)
+        for (int b = 0; b < num_blocks; ++b) {
+            size_t* counts = histogram.data() + static_cast<size_t>(b) * RADIX_BUCKETS;
+            const size_t begin = n * b / num_blocks, end = n * (b + 1) / num_blocks;
+            for (size_t i = begin; i < end; ++i) {
+                ++counts[(keys[i] >> shift) & (RADIX_BUCKETS - 1)];
+            }
+        }
+
+        // digit-major, block-minor prefix sum keeps the sort stable
+        size_t offset = 0;
+        bool constant_digit = false;
+        for (int d = 0; d < RADIX_BUCKETS; ++d) {
+            size_t digit_total = 0;
+            for (int b = 0; b < num_blocks; ++b) {
+                size_t& slot = histogram[static_cast<size_t>(b) * RADIX_BUCKETS + d];
+                const size_t count = slot;
+                slot = offset;
+                offset += count;
+                digit_total += count;
+            }
+            constant_digit |= digit_total == n;
+        }
+        if (constant_digit) {
+            continue;
+        }
+
+        #pragma omp parallel for schedule(static, 1) num_threads(num_blocks)
+        for (int b = 0; b < num_blocks; ++b) {
+            size_t* next = histogram.data() + static_cast<size_t>(b) * RADIX_BUCKETS;
+            const size_t begin = n * b / num_blocks, end = n * (b + 1) / num_blocks;
+            for (size_t i = begin; i < end; ++i) {
+                const size_t slot = next[(keys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                keys_out[slot] = keys[i];
+                values_out[slot] = values[i];
+            }
+        }
+        keys.swap(keys_out);
+        values.swap(values_out);
+    }
+}
+
+std::vector<uint32_t> morton_order(const SplatCloud& cloud) {
+    std::vector<uint64_t> codes = morton_codes(cloud);
+    std::vector<uint32_t> order(cloud.count);
+    for (size_t i = 0; i < cloud.count; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    radix_sort(codes, order, 3 * MORTON_AXIS_BITS);
+    return order;
+}
+
+std::vector<float> chunk_bounds(const SplatCloud& cloud, size_t chunk_size) {
+    const int64_t num_chunks = static_cast<int64_t>((cloud.count + chunk_size - 1) / chunk_size);
+    std::vector<float> bounds(num_chunks * 6);
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+        float hi[3] = {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+        const size_t end = std::min(cloud.count, static_cast<size_t>(c + 1) * chunk_size);
+        for (size_t i = static_cast<size_t>(c) * chunk_size; i < end; ++i) {
+            const float* log_scale = &cloud.scales[i * 3];
+            const float extent = 3.0f * std::exp(std::max({log_scale[0], log_scale[1], log_scale[2]}));
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], cloud.positions[i * 3 + a] - extent);
+                hi[a] = std::max(hi[a], cloud.positions[i * 3 + a] + extent);
+            }
+        }
+        std::copy_n(lo, 3, &bounds[c * 6]);
+        std::copy_n(hi, 3, &bounds[c * 6 + 3]);
+    }
+    return bounds;
+}
+
+/**
+ * <name>.chunks.bin: "SPCB", uint32 version, chunk size, chunk count, then
+ * float32 min xyz, max xyz per chunk (little-endian)
+ */
+static void write_chunk_bounds(const std::string& path, const std::vector<float>& bounds, size_t chunk_size) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open " + path + " for writing");
+    }
+    const uint32_t header[3] = {1, static_cast<uint32_t>(chunk_size), static_cast<uint32_t>(bounds.size() / 6)};
+    out.write("SPCB", 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(bounds.data()), bounds.size() * sizeof(float));
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path);
+    }
+}
+
+/**
+ * rewrite a splat in morton order (every attribute array moves together)
+ * plus per-chunk bounds, so neighbouring splats sit next to each other in
+ * the file: tighter chunk ranges for the compressed format, better gzip on
+ * the raw ply and chunk-level frustum culling in the viewer. with
+ * compressed=true the output is compressed.ply, whose 256-splat chunks line
+ * up with the bounds when chunk_size is 256
+ */
+static py::dict reorder_splat_ply(
+    const std::string& input_path,
+    const std::string& output_path,
+    int chunk_size,
+    bool compressed,
+    const std::string& bounds_path
+) {
+    if (chunk_size < 1) {
+        throw std::invalid_argument("chunk_size must be >= 1");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const std::string out = output_path.empty() ? input_path : output_path;
+    const std::string bounds_out = bounds_path.empty() ? fs::path(out).replace_extension(".chunks.bin").string() : bounds_path;
+    size_t count = 0, num_chunks = 0;
+    double sort_time_ms = 0.0;
+    {
+        py::gil_scoped_release release;
+
+        #ifdef _OPENMP
+        omp_set_num_threads(std::min(4, omp_get_max_threads()));
+        #endif
+
+        const SplatCloud source = SplatCloud::read(input_path);
+        auto read_time = std::chrono::high_resolution_clock::now();
+        const SplatCloud sorted = source.gather(morton_order(source));
+        sort_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - read_time).count() / 1000.0;
+
+        // out is often the input itself: write beside it and rename only once
+        // the whole file is on disk, so a failed write leaves the original intact
+        const std::string tmp_path = out + ".tmp";
+        try {
+            if (compressed) {
+                write_compressed_ply(sorted, tmp_path, -1, 0);
+            } else {
+                sorted.write(tmp_path);
+            }
+        } catch (...) {
+            std::remove(tmp_path.c_str());
+            throw;
+        }
+        if (std::rename(tmp_path.c_str(), out.c_str()) != 0) {
+            const std::string reason = std::strerror(errno);
+            std::remove(tmp_path.c_str());
+            throw std::runtime_error("Could not replace " + out + ": " + reason);
+        }
+        const std::vector<float> bounds = chunk_bounds(sorted, static_cast<size_t>(chunk_size));
+        write_chunk_bounds(bounds_out, bounds, static_cast<size_t>(chunk_size));
+        count = sorted.count;
+        num_chunks = bounds.size() / 6;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["splats"] = count;
+    results["chunks"] = num_chunks;
+    results["chunk_size"] = chunk_size;
+    results["output_path"] = out;
+    results["bounds_path"] = bounds_out;
+    results["sort_time_ms"] = sort_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ splat reorder results:\n");
+    printf("  splats: %zu in %zu chunks of %d\n", count, num_chunks, chunk_size);
+    printf("  total time: %.2f ms (morton sort + gather %.2f ms)\n", processing_time_ms, sort_time_ms);
+    return results;
+}
+
+void register_splat_sort(py::module_& m) {
+    m.def("reorder_splat_ply", &reorder_splat_ply,
+          "rewrite a splat ply in 63-bit morton order and write per-chunk bounds (<output>.chunks.bin)",
+          py::arg("input_path"), py::arg("output_path") = "", py::arg("chunk_size") = 256,
+          py::arg("compressed") = false, py::arg("bounds_path") = "");
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "splat_ply.h"
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// bits per axis in a 63-bit morton code
+static constexpr int MORTON_AXIS_BITS = 21;
+
+/**
+ * 63-bit morton code per splat: each axis quantized to 21 bits over the
+ * cloud's bounding box and interleaved x, y, z from the top. a code's top
+ * 3d bits name its depth-d octree cell
+ */
+std::vector<uint64_t> morton_codes(const SplatCloud& cloud);
+
+// interleave three 21-bit cell coordinates, x in the top bit of each triple
+uint64_t morton_encode(uint32_t x, uint32_t y, uint32_t z);
+
+/**
+ * stable parallel lsd radix sort of keys, carrying values along, 8-bit
+ * digits over the low key_bits bits. each thread histograms and scatters
+ * its own block; digits every key shares are skipped
+ */
+void radix_sort(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int key_bits);
+
+/**
+ * splat indices in morton order (ties keep input order)
+ */
+std::vector<uint32_t> morton_order(const SplatCloud& cloud);
+
+/**
+ * conservative world box of each run of chunk_size consecutive splats, as
+ * min xyz, max xyz: centres grown by 3 sigma of their largest axis, so a
+ * chunk whose box is outside the frustum can be skipped whole
+ */
+std::vector<float> chunk_bounds(const SplatCloud& cloud, size_t chunk_size);
+
+void register_splat_sort(pybind11::module_& m);
@@ -0,0 +1,258 @@
+#include "undistort.h"
+#include "colmap_model.h"
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+/**
+ * fixed-point remap tables for one camera: map_xy holds the integer source
+ * pixel (CV_16SC2), map_frac the 5-bit sub-pixel index (CV_16UC1). remap
+ * then skips the float -> int conversion per pixel and walks the output in
+ * blocks, so the only per-frame cost is the gather itself
+ */
+struct UndistortMaps {
+    cv::Mat map_xy;
+    cv::Mat map_frac;
+};
+
+/**
+ * for every output (pinhole) pixel, where it lands in the distorted frame
+ * the undistorted camera keeps the size, focal length and principal point,
+ * pixels that map outside the source come out transparent
+ */
+static UndistortMaps build_undistort_maps(const ColmapCamera& camera) {
+    const int width = static_cast<int>(camera.width);
+    const int height = static_cast<int>(camera.height);
+    double fx, fy, cx, cy;
+    camera_intrinsics(camera, fx, fy, cx, cy);
+
+    cv::Mat map_x(height, width, CV_32FC1);
+    cv::Mat map_y(height, width, CV_32FC1);
+
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < height; ++y) {
+        float* __restrict__ mx = map_x.ptr<float>(y);
+        float* __restrict__ my = map_y.ptr<float>(y);
+        // colmap pixel centres sit at +0.5, opencv's at integers
+        const double v = (y + 0.5 - cy) / fy;
+        for (int x = 0; x < width; ++x) {
+            const double u = (x + 0.5 - cx) / fx;
+            double du, dv;
+            camera_distortion(camera, u, v, du, dv);
+            mx[x] = static_cast<float>(fx * (u + du) + cx - 0.5);
+            my[x] = static_cast<float>(fy * (v + dv) + cy - 0.5);
+        }
+    }
+
+    UndistortMaps maps;
+    cv::convertMaps(map_x, map_y, maps.map_xy, maps.map_frac, CV_16SC2);
+    return maps;
+}
+
+static ColmapCamera pinhole_camera(const ColmapCamera& camera) {
+    ColmapCamera out;
+    out.camera_id = camera.camera_id;
+    out.model_id = COLMAP_MODEL_PINHOLE;
+    out.width = camera.width;
+    out.height = camera.height;
+    double fx, fy, cx, cy;
+    camera_intrinsics(camera, fx, fy, cx, cy);
+    out.params[0] = fx;
+    out.params[1] = fy;
+    out.params[2] = cx;
+    out.params[3] = cy;
+    return out;
+}
+
+/**
+ * native replacement for `colmap image_undistorter --output_type COLMAP`
+ * reads <sparse_dir>/{cameras,images,points3D}.bin and writes
+ *   <output_dir>/images/<name>         undistorted frames (alpha kept)
+ *   <output_dir>/masks/<name>.png      undistorted colmap masks, if mask_dir is set
+ *   <output_dir>/sparse/{cameras,images,points3D}.bin  PINHOLE cameras, undistorted 2d points
+ * everything is written to <output_dir>.partial first and only renamed into
+ * place when every frame made it; on any error output_dir is removed, so a
+ * present output_dir is always complete and from this model
+ */
+static py::dict undistort_images(
+    const std::string& sparse_dir,
+    const std::string& image_dir,
+    const std::string& output_dir,
+    const std::string& mask_dir
+) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    ColmapModel model = ColmapModel::read(sparse_dir);
+    const std::vector<ColmapCamera>& cameras = model.cameras;
+
+    fs::path target(output_dir);
+    if (!target.has_filename()) {
+        target = target.parent_path();
+    }
+    const std::string staging_dir = target.string() + ".partial";
+    fs::remove_all(staging_dir);
+
+    const bool undistort_masks = !mask_dir.empty();
+    fs::create_directories(staging_dir + "/images");
+    fs::create_directories(staging_dir + "/sparse");
+    if (undistort_masks) {
+        fs::create_directories(staging_dir + "/masks");
+    }
+
+    // one table per camera, shared by every frame it took
+    std::map<uint32_t, const ColmapCamera*> camera_by_id;
+    std::map<uint32_t, UndistortMaps> maps_by_id;
+    std::vector<ColmapCamera> pinhole_cameras;
+    for (const auto& camera : cameras) {
+        camera_by_id[camera.camera_id] = &camera;
+        maps_by_id[camera.camera_id] = build_undistort_maps(camera);
+        pinhole_cameras.push_back(pinhole_camera(camera));
+    }
+
+    auto maps_time = std::chrono::high_resolution_clock::now();
+
+    const int num_images = static_cast<int>(model.images.size());
+    std::atomic<int> processed{0};
+    std::atomic<int> errors{0};
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_images; ++i) {
+        const ColmapImage& image = model.images[i];
+        const std::string& name = model.image_names[i];
+        try {
+            auto cam_it = camera_by_id.find(image.camera_id);
+            if (cam_it == camera_by_id.end()) {
+                printf("ERROR: Image %s references unknown camera %u\n", name.c_str(), image.camera_id);
+                errors.fetch_add(1);
+                continue;
+            }
+            const ColmapCamera& camera = *cam_it->second;
+            const UndistortMaps& maps = maps_by_id.at(image.camera_id);
+
+            // 2d observations move with the pixels
+            double fx, fy, cx, cy;
+            camera_intrinsics(camera, fx, fy, cx, cy);
+            double* xy = model.points2D_xy.data();
+            for (uint64_t p = model.points2D_offsets[i]; p < model.points2D_offsets[i + 1]; ++p) {
+                double u = (xy[p * 2 + 0] - cx) / fx;
+                double v = (xy[p * 2 + 1] - cy) / fy;
+                camera_undistort_normalized(camera, u, v);
+                xy[p * 2 + 0] = fx * u + cx;
+                xy[p * 2 + 1] = fy * v + cy;
+            }
+
+            // keep the alpha channel, it carries the sam2 mask for brush
+            cv::Mat frame = cv::imread(image_dir + "/" + name, cv::IMREAD_UNCHANGED);
+            if (frame.empty()) {
+                printf("ERROR: Could not load image: %s/%s\n", image_dir.c_str(), name.c_str());
+                errors.fetch_add(1);
+                continue;
+            }
+            if (static_cast<uint64_t>(frame.cols) != camera.width || static_cast<uint64_t>(frame.rows) != camera.height) {
+                printf("ERROR: Image %s is %dx%d but camera %u is %llux%llu\n", name.c_str(),
+                       frame.cols, frame.rows, camera.camera_id,
+                       static_cast<unsigned long long>(camera.width), static_cast<unsigned long long>(camera.height));
+                errors.fetch_add(1);
+                continue;
+            }
+
+            thread_local cv::Mat undistorted;
+            cv::remap(frame, undistorted, maps.map_xy, maps.map_frac, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar());
+            std::vector<int> png_params = {cv::IMWRITE_PNG_COMPRESSION, 6};
+            if (!cv::imwrite(staging_dir + "/images/" + name, undistorted, png_params)) {
+                printf("ERROR: Could not save undistorted image: %s\n", name.c_str());
+                errors.fetch_add(1);
+                continue;
+            }
+
+            if (undistort_masks) {
+                // nearest keeps the mask binary; a frame without its mask makes masks/ incomplete
+                const std::string mask_name = name + ".png";
+                cv::Mat mask = cv::imread(mask_dir + "/" + mask_name, cv::IMREAD_GRAYSCALE);
+                if (mask.empty()) {
+                    printf("ERROR: Could not load mask: %s/%s\n", mask_dir.c_str(), mask_name.c_str());
+                    errors.fetch_add(1);
+                    continue;
+                }
+                thread_local cv::Mat undistorted_mask;
+                cv::remap(mask, undistorted_mask, maps.map_xy, cv::Mat(), cv::INTER_NEAREST, cv::BORDER_CONSTANT, cv::Scalar());
+                std::vector<int> mask_params = {cv::IMWRITE_PNG_COMPRESSION, 3};
+                if (!cv::imwrite(staging_dir + "/masks/" + mask_name, undistorted_mask, mask_params)) {
+                    printf("ERROR: Could not save undistorted mask: %s\n", mask_name.c_str());
+                    errors.fetch_add(1);
+                    continue;
+                }
+            }
+            processed.fetch_add(1);
+
+        } catch (const std::exception& e) {
+            printf("ERROR: Exception undistorting image %s: %s\n", name.c_str(), e.what());
+            errors.fetch_add(1);
+        }
+    }
+
+    // a model with missing frames must never reach brush: publish all or nothing
+    const bool complete = errors.load() == 0;
+    try {
+        fs::remove_all(target);
+        if (complete) {
+            // 3d points don't depend on the lens model, only cameras and 2d points change
+            model.cameras = std::move(pinhole_cameras);
+            model.write(staging_dir + "/sparse");
+            fs::rename(staging_dir, target);
+        } else {
+            fs::remove_all(staging_dir);
+        }
+    } catch (...) {
+        std::error_code ignored;
+        fs::remove_all(staging_dir, ignored);
+        throw;
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double map_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(maps_time - start_time).count() / 1000.0;
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["processed"] = processed.load();
+    results["errors"] = errors.load();
+    results["complete"] = complete;
+    results["cameras"] = static_cast<int>(cameras.size());
+    results["output_dir"] = output_dir;
+    results["map_time_ms"] = map_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ undistortion results:\n");
+    printf("  processed: %d/%d images, %zu camera(s)\n", processed.load(), num_images, cameras.size());
+    printf("  errors: %d%s\n", errors.load(), complete ? "" : ", nothing written");
+    printf("  total time: %.2f ms (remap tables %.2f ms)\n", processing_time_ms, map_time_ms);
+    return results;
+}
+
+void register_undistort(py::module_& m) {
+    m.def("undistort_images", &undistort_images,
+          "undistort a colmap sparse model's frames (and masks) to PINHOLE with cached fixed-point remap tables",
+          py::arg("sparse_dir"), py::arg("image_dir"), py::arg("output_dir"), py::arg("mask_dir") = "");
+}
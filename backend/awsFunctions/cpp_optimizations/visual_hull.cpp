@@ -0,0 +1,640 @@
+#include "visual_hull.h"
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace py = pybind11;
+namespace fs = std::filesystem;
+
+/**
+ * object mask for one registered image, in the camera's own pixel grid
+ * <mask_dir>/<name>.png (colmap masks, 0/255) wins; otherwise the alpha
+ * channel of <mask_dir>/<name> (the rgba frames). empty if neither exists
+ */
+static cv::Mat load_object_mask(const std::string& mask_dir, const std::string& name) {
+    const std::string colmap_mask = mask_dir + "/" + name + ".png";
+    if (fs::exists(colmap_mask)) {
+        return cv::imread(colmap_mask, cv::IMREAD_GRAYSCALE);
+    }
+    cv::Mat frame = cv::imread(mask_dir + "/" + name, cv::IMREAD_UNCHANGED);
+    if (frame.empty() || frame.channels() != 4) {
+        return cv::Mat();
+    }
+    cv::Mat alpha;
+    cv::extractChannel(frame, alpha, 3);
+    return alpha;
+}
+
+MaskedViews load_masked_views(const ColmapModel& model, const std::string& mask_dir, int margin) {
+    const int num_images = static_cast<int>(model.images.size());
+    MaskedViews views;
+    views.cameras.assign(num_images, nullptr);
+    views.masks.resize(num_images);
+    std::atomic<int> missing_masks{0};
+
+    #ifdef _OPENMP
+    omp_set_num_threads(std::min(4, omp_get_max_threads()));
+    #endif
+
+    const cv::Mat kernel = margin > 0
+        ? cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(2 * margin + 1, 2 * margin + 1))
+        : cv::Mat();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_images; ++i) {
+        const std::string& name = model.image_names[i];
+        try {
+            const ColmapCamera* camera = model.find_camera(model.images[i].camera_id);
+            cv::Mat mask = load_object_mask(mask_dir, name);
+            if (!camera || mask.empty()) {
+                missing_masks.fetch_add(1);
+                continue;
+            }
+            if (static_cast<uint64_t>(mask.cols) != camera->width || static_cast<uint64_t>(mask.rows) != camera->height) {
+                printf("ERROR: Mask for %s is %dx%d but camera %u is %llux%llu\n", name.c_str(),
+                       mask.cols, mask.rows, camera->camera_id,
+                       static_cast<unsigned long long>(camera->width), static_cast<unsigned long long>(camera->height));
+                missing_masks.fetch_add(1);
+                continue;
+            }
+            if (margin > 0) {
+                cv::dilate(mask, mask, kernel);
+            }
+            views.cameras[i] = camera;
+            views.masks[i] = BitMask::from_mat(mask);
+        } catch (const std::exception& e) {
+            printf("ERROR: Exception loading mask for %s: %s\n", name.c_str(), e.what());
+            missing_masks.fetch_add(1);
+        }
+    }
+    views.missing = missing_masks.load();
+    return views;
+}
+
+/**
+ * keep the sparse points that project inside the object mask in at least
+ * `min_views` registered images, then write the model with tracks and 2d
+ * references cleaned up. masks are grown by `margin` pixels first so
+ * reprojection error and mask edges don't shave the object's silhouette
+ */
+static py::dict carve_visual_hull(
+    const std::string& sparse_dir,
+    const std::string& mask_dir,
+    const std::string& output_dir,
+    int min_views,
+    int margin
+) {
+    if (min_views < 1) {
+        throw std::invalid_argument("min_views must be >= 1");
+    }
+    if (margin < 0) {
+        throw std::invalid_argument("margin must be >= 0");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    ColmapModel model = ColmapModel::read(sparse_dir);
+    const int num_images = static_cast<int>(model.images.size());
+    const int num_points = static_cast<int>(model.points.size());
+
+    const MaskedViews views = load_masked_views(model, mask_dir, margin);
+    const std::vector<const ColmapCamera*>& cameras = views.cameras;
+    const std::vector<BitMask>& masks = views.masks;
+
+    auto masks_time = std::chrono::high_resolution_clock::now();
+
+    // every point against every masked view, stopping as soon as it has enough votes
+    std::vector<uint8_t> keep(num_points, 0);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int j = 0; j < num_points; ++j) {
+        const double* xyz = model.points[j].xyz;
+        int votes = 0;
+        for (int i = 0; i < num_images && votes < min_views; ++i) {
+            if (!cameras[i]) {
+                continue;
+            }
+            double x, y;
+            if (!project_point(*cameras[i], model.images[i], xyz, x, y)) {
+                continue;
+            }
+            // colmap pixel centres sit at +0.5, so floor gives the pixel index
+            votes += masks[i].test(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)));
+        }
+        keep[j] = votes >= min_views;
+    }
+
+    int kept = static_cast<int>(std::count(keep.begin(), keep.end(), 1));
+    const bool write_model = kept > 0;
+    size_t removed = 0;
+    if (write_model) {
+        // filter also drops points whose track falls below two views
+        removed = model.filter(keep, {}).first;
+        kept = static_cast<int>(model.points.size());
+        const std::string out = output_dir.empty() ? sparse_dir : output_dir;
+        fs::create_directories(out);
+        model.write(out);
+    } else {
+        printf("ERROR: No sparse point falls inside %d mask(s), leaving the model untouched\n", min_views);
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double mask_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(masks_time - start_time).count() / 1000.0;
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+
+    py::dict results;
+    results["success"] = write_model;
+    results["points_before"] = num_points;
+    results["points_after"] = write_model ? kept : num_points;
+    results["points_removed"] = removed;
+    results["images"] = num_images;
+    results["images_without_mask"] = views.missing;
+    results["mask_time_ms"] = mask_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ visual hull results:\n");
+    printf("  points: %d -> %d (min %d views, margin %d px)\n", num_points, write_model ? kept : num_points, min_views, margin);
+    printf("  images without mask: %d/%d\n", views.missing, num_images);
+    printf("  total time: %.2f ms (masks %.2f ms)\n", processing_time_ms, mask_time_ms);
+    return results;
+}
+
+// bricks of 8^3 voxels, one 64-bit word per z layer (bit = y * 8 + x)
+static constexpr int BRICK_SIZE = 8;
+static constexpr int BRICK_WORDS = 8;
+
+// per surface point, colour is averaged over at most this many facing views
+static constexpr int COLOUR_VIEWS = 3;
+
+// views more grazing than this (cosine to the surface normal) don't colour a point
+static constexpr double MIN_VIEW_COSINE = 0.2;
+
+/**
+ * two-level bitset octree: a top-level live flag per brick and 512 bits
+ * per brick. carved bricks are skipped without touching their bits
+ */
+struct VoxelGrid {
+    double origin[3] = {0.0, 0.0, 0.0};
+    double voxel_size = 0.0;
+    int dims[3] = {0, 0, 0};
+    int bricks[3] = {0, 0, 0};
+    std::vector<uint8_t> brick_live;
+    std::vector<uint64_t> bits;
+
+    size_t brick_index(int bx, int by, int bz) const {
+        return (static_cast<size_t>(bz) * bricks[1] + by) * bricks[0] + bx;
+    }
+
+    bool occupied(int x, int y, int z) const {
+        if (x < 0 || y < 0 || z < 0 || x >= dims[0] || y >= dims[1] || z >= dims[2]) {
+            return false;
+        }
+        const size_t b = brick_index(x >> 3, y >> 3, z >> 3);
+        return brick_live[b] && ((bits[b * BRICK_WORDS + (z & 7)] >> ((y & 7) * 8 + (x & 7))) & 1u);
+    }
+
+    void centre(int x, int y, int z, double out[3]) const {
+        out[0] = origin[0] + (x + 0.5) * voxel_size;
+        out[1] = origin[1] + (y + 0.5) * voxel_size;
+        out[2] = origin[2] + (z + 0.5) * voxel_size;
+    }
+};
+
+/**
+ * grid over the sparse cloud's 2nd-98th percentile box, padded by `padding`
+ * of the extent per side; `resolution` voxels along the longest axis,
+ * every axis rounded up to whole bricks
+ */
+static VoxelGrid make_voxel_grid(const ColmapModel& model, int resolution, double padding) {
+    double lo[3], hi[3];
+    std::vector<double> values(model.points.size());
+    for (int k = 0; k < 3; ++k) {
+        for (size_t j = 0; j < model.points.size(); ++j) {
+            values[j] = model.points[j].xyz[k];
+        }
+        const size_t low = values.size() * 2 / 100;
+        const size_t high = values.size() - 1 - low;
+        std::nth_element(values.begin(), values.begin() + low, values.end());
+        lo[k] = values[low];
+        std::nth_element(values.begin(), values.begin() + high, values.end());
+        hi[k] = values[high];
+    }
+
+    double max_extent = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        const double pad = (hi[k] - lo[k]) * padding;
+        lo[k] -= pad;
+        hi[k] += pad;
+        max_extent = std::max(max_extent, hi[k] - lo[k]);
+    }
+    if (max_extent <= 0.0) {
+        throw std::runtime_error("sparse cloud has no extent to carve");
+    }
+
+    VoxelGrid grid;
+    grid.voxel_size = max_extent / resolution;
+    for (int k = 0; k < 3; ++k) {
+        const int voxels = std::max(1, static_cast<int>(std::ceil((hi[k] - lo[k]) / grid.voxel_size)));
+        grid.bricks[k] = (voxels + BRICK_SIZE - 1) / BRICK_SIZE;
+        grid.dims[k] = grid.bricks[k] * BRICK_SIZE;
+        // centre the rounded-up grid on the box
+        grid.origin[k] = 0.5 * (lo[k] + hi[k]) - 0.5 * grid.dims[k] * grid.voxel_size;
+    }
+    const size_t num_bricks = static_cast<size_t>(grid.bricks[0]) * grid.bricks[1] * grid.bricks[2];
+    grid.brick_live.assign(num_bricks, 0);
+    grid.bits.assign(num_bricks * BRICK_WORDS, 0);
+    return grid;
+}
+
+bool box_outside_masks(
+    const double lo[3],
+    const double hi[3],
+    const MaskedViews& views,
+    const std::vector<BitMask>& coarse,
+    const std::vector<ColmapImage>& images,
+    int max_misses
+) {
+    int misses = 0;
+    for (size_t i = 0; i < images.size(); ++i) {
+        const ColmapCamera* camera = views.cameras[i];
+        if (!camera) {
+            continue;
+        }
+        double min_x = 1e300, min_y = 1e300, max_x = -1e300, max_y = -1e300;
+        bool in_front = true;
+        for (int c = 0; c < 8 && in_front; ++c) {
+            const double corner[3] = {(c & 1) ? hi[0] : lo[0], (c & 2) ? hi[1] : lo[1], (c & 4) ? hi[2] : lo[2]};
+            double x, y;
+            in_front = project_point(*camera, images[i], corner, x, y);
+            min_x = std::min(min_x, x);
+            min_y = std::min(min_y, y);
+            max_x = std::max(max_x, x);
+            max_y = std::max(max_y, y);
+        }
+        if (!in_front || min_x < 0.0 || min_y < 0.0 ||
+            max_x >= static_cast<double>(camera->width) || max_y >= static_cast<double>(camera->height)) {
+            continue;
+        }
+        const int x0 = (static_cast<int>(min_x) - 1) / 8, x1 = (static_cast<int>(max_x) + 1) / 8;
+        const int y0 = (static_cast<int>(min_y) - 1) / 8, y1 = (static_cast<int>(max_y) + 1) / 8;
+        if (!coarse[i].any_in_rect(std::max(x0, 0), std::max(y0, 0), x1, y1) && ++misses > max_misses) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct SurfacePoint {
+    double xyz[3];
+    double normal[3];
+};
+
+/**
+ * denser initialization cloud for brush: carve a voxel volume against every
+ * object mask using the colmap poses, keep the surface voxels, colour them
+ * from the frames that face them most directly and append them to
+ * points3D.bin (tracks empty, error 0)
+ *
+ * a voxel survives if it is seen (in front, in frame) by at least min_views
+ * masked views and falls outside the mask in at most max_misses of them.
+ * bricks and voxels are carved per z slab in parallel; colouring is
+ * normal-facing only, without an occlusion test
+ */
+static py::dict carve_dense_points(
+    const std::string& sparse_dir,
+    const std::string& mask_dir,
+    const std::string& image_dir,
+    const std::string& output_dir,
+    int resolution,
+    int min_views,
+    int max_misses,
+    int margin,
+    int max_points,
+    bool keep_sparse
+) {
+    if (resolution < BRICK_SIZE || resolution > 1024) {
+        throw std::invalid_argument("resolution must be in [8, 1024]");
+    }
+    if (min_views < 1) {
+        throw std::invalid_argument("min_views must be >= 1");
+    }
+    if (max_misses < 0 || margin < 0) {
+        throw std::invalid_argument("max_misses and margin must be >= 0");
+    }
+    if (max_points < 1) {
+        throw std::invalid_argument("max_points must be >= 1");
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    ColmapModel model = ColmapModel::read(sparse_dir);
+    const int num_images = static_cast<int>(model.images.size());
+    const size_t sparse_points = model.points.size();
+    if (sparse_points < 16) {
+        throw std::runtime_error("too few sparse points to bound the object");
+    }
+
+    const MaskedViews views = load_masked_views(model, mask_dir, margin);
+    std::vector<BitMask> coarse(num_images);
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_images; ++i) {
+        if (views.cameras[i]) {
+            coarse[i] = views.masks[i].any_pool8();
+        }
+    }
+
+    auto masks_time = std::chrono::high_resolution_clock::now();
+
+    VoxelGrid grid = make_voxel_grid(model, resolution, 0.1);
+    const double brick_extent = BRICK_SIZE * grid.voxel_size;
+    std::atomic<long long> bricks_carved{0};
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int bz = 0; bz < grid.bricks[2]; ++bz) {
+        for (int by = 0; by < grid.bricks[1]; ++by) {
+            for (int bx = 0; bx < grid.bricks[0]; ++bx) {
+                const double lo[3] = {grid.origin[0] + bx * brick_extent,
+                                      grid.origin[1] + by * brick_extent,
+                                      grid.origin[2] + bz * brick_extent};
+                const double hi[3] = {lo[0] + brick_extent, lo[1] + brick_extent, lo[2] + brick_extent};
+                if (box_outside_masks(lo, hi, views, coarse, model.images, max_misses)) {
+                    bricks_carved.fetch_add(1);
+                    continue;
+                }
+
+                const size_t b = grid.brick_index(bx, by, bz);
+                uint64_t* words = grid.bits.data() + b * BRICK_WORDS;
+                for (int v = 0; v < BRICK_SIZE * BRICK_SIZE * BRICK_SIZE; ++v) {
+                    const int x = bx * BRICK_SIZE + (v & 7);
+                    const int y = by * BRICK_SIZE + ((v >> 3) & 7);
+                    const int z = bz * BRICK_SIZE + (v >> 6);
+                    double centre[3];
+                    grid.centre(x, y, z, centre);
+
+                    int seen = 0, misses = 0;
+                    for (int i = 0; i < num_images && misses <= max_misses; ++i) {
+                        if (!views.cameras[i]) {
+                            continue;
+                        }
+                        double px, py;
+                        if (!project_point(*views.cameras[i], model.images[i], centre, px, py)) {
+                            continue;
+                        }
+                        const int ix = static_cast<int>(std::floor(px));
+                        const int iy = static_cast<int>(std::floor(py));
+                        if (ix < 0 || iy < 0 || ix >= views.masks[i].width || iy >= views.masks[i].height) {
+                            continue;
+                        }
+                        ++seen;
+                        misses += !views.masks[i].test(ix, iy);
+                    }
+                    if (seen >= min_views && misses <= max_misses) {
+                        words[v >> 6] |= 1ull << (v & 63);
+                    }
+                }
+                for (int w = 0; w < BRICK_WORDS; ++w) {
+                    grid.brick_live[b] |= words[w] != 0;
+                }
+            }
+        }
+    }
+
+    // surface = occupied with an empty 6-neighbour; the normal points at the empty side
+    static const int NEIGHBOURS[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    std::vector<std::vector<SurfacePoint>> slab_surface(grid.dims[2]);
+    std::atomic<long long> occupied_voxels{0};
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int z = 0; z < grid.dims[2]; ++z) {
+        long long occupied = 0;
+        for (int y = 0; y < grid.dims[1]; ++y) {
+            for (int x = 0; x < grid.dims[0]; ++x) {
+                if (!grid.occupied(x, y, z)) {
+                    continue;
+                }
+                ++occupied;
+                SurfacePoint point = {};
+                bool surface = false;
+                for (const auto& n : NEIGHBOURS) {
+                    if (!grid.occupied(x + n[0], y + n[1], z + n[2])) {
+                        surface = true;
+                        for (int k = 0; k < 3; ++k) {
+                            point.normal[k] += n[k];
+                        }
+                    }
+                }
+                if (!surface) {
+                    continue;
+                }
+                const double len = std::sqrt(point.normal[0] * point.normal[0] + point.normal[1] * point.normal[1] +
+                                             point.normal[2] * point.normal[2]);
+                for (int k = 0; k < 3; ++k) {
+                    point.normal[k] = len > 0.0 ? point.normal[k] / len : 0.0;
+                }
+                grid.centre(x, y, z, point.xyz);
+                slab_surface[z].push_back(point);
+            }
+        }
+        occupied_voxels.fetch_add(occupied);
+    }
+
+    std::vector<SurfacePoint> surface;
+    for (auto& slab : slab_surface) {
+        surface.insert(surface.end(), slab.begin(), slab.end());
+    }
+    const size_t surface_voxels = surface.size();
+    if (surface.size() > static_cast<size_t>(max_points)) {
+        // even stride keeps the coverage uniform
+        const double step = static_cast<double>(surface.size()) / max_points;
+        std::vector<SurfacePoint> thinned(max_points);
+        for (int j = 0; j < max_points; ++j) {
+            thinned[j] = surface[static_cast<size_t>(j * step)];
+        }
+        surface.swap(thinned);
+    }
+
+    auto carve_time = std::chrono::high_resolution_clock::now();
+
+    // pick up to COLOUR_VIEWS masked views facing each point
+    const int num_surface = static_cast<int>(surface.size());
+    std::vector<double> centres(static_cast<size_t>(num_images) * 3);
+    for (int i = 0; i < num_images; ++i) {
+        image_center(model.images[i], &centres[static_cast<size_t>(i) * 3]);
+    }
+    std::vector<int> colour_view(static_cast<size_t>(num_surface) * COLOUR_VIEWS, -1);
+    std::vector<float> colour_xy(static_cast<size_t>(num_surface) * COLOUR_VIEWS * 2, 0.0f);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int j = 0; j < num_surface; ++j) {
+        const SurfacePoint& point = surface[j];
+        double best_cos[COLOUR_VIEWS];
+        std::fill(best_cos, best_cos + COLOUR_VIEWS, MIN_VIEW_COSINE);
+        int* slot_view = &colour_view[static_cast<size_t>(j) * COLOUR_VIEWS];
+        float* slot_xy = &colour_xy[static_cast<size_t>(j) * COLOUR_VIEWS * 2];
+        for (int i = 0; i < num_images; ++i) {
+            if (!views.cameras[i]) {
+                continue;
+            }
+            const double* c = &centres[static_cast<size_t>(i) * 3];
+            const double dx = c[0] - point.xyz[0], dy = c[1] - point.xyz[1], dz = c[2] - point.xyz[2];
+            const double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const double cosine = (dx * point.normal[0] + dy * point.normal[1] + dz * point.normal[2]) / dist;
+            if (cosine <= best_cos[COLOUR_VIEWS - 1]) {
+                continue;
+            }
+            double px, py;
+            if (!project_point(*views.cameras[i], model.images[i], point.xyz, px, py) ||
+                !views.masks[i].test(static_cast<int>(std::floor(px)), static_cast<int>(std::floor(py)))) {
+                continue;
+            }
+            // insertion into the small sorted slot list
+            int k = COLOUR_VIEWS - 1;
+            while (k > 0 && best_cos[k - 1] < cosine) {
+                best_cos[k] = best_cos[k - 1];
+                slot_view[k] = slot_view[k - 1];
+                slot_xy[k * 2 + 0] = slot_xy[(k - 1) * 2 + 0];
+                slot_xy[k * 2 + 1] = slot_xy[(k - 1) * 2 + 1];
+                --k;
+            }
+            best_cos[k] = cosine;
+            slot_view[k] = i;
+            slot_xy[k * 2 + 0] = static_cast<float>(px);
+            slot_xy[k * 2 + 1] = static_cast<float>(py);
+        }
+    }
+
+    // invert to per-image lists so each frame is decoded exactly once
+    std::vector<std::vector<int>> image_slots(num_images);
+    for (size_t s = 0; s < colour_view.size(); ++s) {
+        if (colour_view[s] >= 0) {
+            image_slots[colour_view[s]].push_back(static_cast<int>(s));
+        }
+    }
+    std::vector<uint8_t> slot_bgr(colour_view.size() * 3, 0);
+    std::vector<uint8_t> slot_valid(colour_view.size(), 0);
+    std::atomic<int> errors{0};
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < num_images; ++i) {
+        if (image_slots[i].empty()) {
+            continue;
+        }
+        const std::string& name = model.image_names[i];
+        cv::Mat frame = cv::imread(image_dir + "/" + name, cv::IMREAD_COLOR);
+        if (frame.empty()) {
+            printf("ERROR: Could not load image: %s/%s\n", image_dir.c_str(), name.c_str());
+            errors.fetch_add(1);
+            continue;
+        }
+        for (const int s : image_slots[i]) {
+            const int x = static_cast<int>(colour_xy[static_cast<size_t>(s) * 2 + 0]);
+            const int y = static_cast<int>(colour_xy[static_cast<size_t>(s) * 2 + 1]);
+            if (x < 0 || y < 0 || x >= frame.cols || y >= frame.rows) {
+                continue;
+            }
+            const uint8_t* px = frame.ptr<uint8_t>(y) + x * 3;
+            slot_bgr[static_cast<size_t>(s) * 3 + 0] = px[0];
+            slot_bgr[static_cast<size_t>(s) * 3 + 1] = px[1];
+            slot_bgr[static_cast<size_t>(s) * 3 + 2] = px[2];
+            slot_valid[s] = 1;
+        }
+    }
+
+    if (!keep_sparse) {
+        // drops every point and resets the 2d references that pointed at them
+        model.filter(std::vector<uint8_t>(model.points.size(), 0), {});
+    }
+
+    int64_t next_id = 1;
+    for (const auto& point : model.points) {
+        next_id = std::max(next_id, point.point3D_id + 1);
+    }
+    model.points.reserve(model.points.size() + num_surface);
+    int uncoloured = 0;
+    for (int j = 0; j < num_surface; ++j) {
+        ColmapPoint3D point;
+        point.point3D_id = next_id++;
+        std::copy(surface[j].xyz, surface[j].xyz + 3, point.xyz);
+
+        int sum[3] = {0, 0, 0}, count = 0;
+        for (int k = 0; k < COLOUR_VIEWS; ++k) {
+            const size_t s = static_cast<size_t>(j) * COLOUR_VIEWS + k;
+            if (slot_valid[s]) {
+                for (int c = 0; c < 3; ++c) {
+                    sum[c] += slot_bgr[s * 3 + c];
+                }
+                ++count;
+            }
+        }
+        if (count == 0) {
+            ++uncoloured;
+        }
+        // bgr -> rgb, mid grey when no frame faces the point
+        for (int c = 0; c < 3; ++c) {
+            point.rgb[c] = count > 0 ? static_cast<uint8_t>((sum[2 - c] + count / 2) / count) : 128;
+        }
+        model.points.push_back(point);
+        model.track_offsets.push_back(model.track_image_ids.size());
+    }
+
+    const std::string out = output_dir.empty() ? sparse_dir : output_dir;
+    fs::create_directories(out);
+    model.write(out);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double mask_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(masks_time - start_time).count() / 1000.0;
+    double carve_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(carve_time - masks_time).count() / 1000.0;
+    double processing_time_ms = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count() / 1000.0;
+    const long long total_bricks = static_cast<long long>(grid.brick_live.size());
+
+    py::dict results;
+    results["success"] = num_surface > 0;
+    results["grid"] = py::make_tuple(grid.dims[0], grid.dims[1], grid.dims[2]);
+    results["voxel_size"] = grid.voxel_size;
+    results["bricks_carved"] = bricks_carved.load();
+    results["occupied_voxels"] = occupied_voxels.load();
+    results["surface_voxels"] = static_cast<long long>(surface_voxels);
+    results["sparse_points"] = static_cast<long long>(keep_sparse ? sparse_points : 0);
+    results["points_added"] = num_surface;
+    results["uncoloured_points"] = uncoloured;
+    results["images_without_mask"] = views.missing;
+    results["errors"] = errors.load();
+    results["carve_time_ms"] = carve_time_ms;
+    results["processing_time_ms"] = processing_time_ms;
+
+    printf("c++ dense carving results:\n");
+    printf("  grid: %dx%dx%d (voxel %.4g), bricks carved %lld/%lld\n", grid.dims[0], grid.dims[1], grid.dims[2],
+           grid.voxel_size, bricks_carved.load(), total_bricks);
+    printf("  voxels: %lld occupied, %zu surface, %d points added (%d uncoloured)\n",
+           occupied_voxels.load(), surface_voxels, num_surface, uncoloured);
+    printf("  images without mask: %d/%d, errors: %d\n", views.missing, num_images, errors.load());
+    printf("  total time: %.2f ms (masks %.2f ms, carving %.2f ms)\n", processing_time_ms, mask_time_ms, carve_time_ms);
+    return results;
+}
+
+void register_visual_hull(py::module_& m) {
+    m.def("carve_visual_hull", &carve_visual_hull,
+          "drop sparse points that fall inside fewer than min_views object masks (bit-packed, parallel over points)",
+          py::arg("sparse_dir"), py::arg("mask_dir"), py::arg("output_dir") = "",
+          py::arg("min_views") = 3, py::arg("margin") = 2);
+
+    m.def("carve_dense_points", &carve_dense_points,
+          "voxel-carve the masks into a bitset octree and append coloured surface points to points3D.bin",
+          py::arg("sparse_dir"), py::arg("mask_dir"), py::arg("image_dir"), py::arg("output_dir") = "",
+          py::arg("resolution") = 160, py::arg("min_views") = 3, py::arg("max_misses") = 1,
+          py::arg("margin") = 2, py::arg("max_points") = 200000, py::arg("keep_sparse") = true);
+}
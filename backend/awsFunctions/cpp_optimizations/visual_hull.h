@@ -0,0 +1,41 @@
+#pragma once
+
+#include "bit_mask.h"
+#include "colmap_model.h"
+
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+/**
+ * per registered image: its camera and dilated bit-packed object mask
+ * images without a usable mask keep a null camera and never vote
+ */
+struct MaskedViews {
+    std::vector<const ColmapCamera*> cameras;
+    std::vector<BitMask> masks;
+    int missing = 0;
+};
+
+/**
+ * object mask per image of the model, from <mask_dir>/<name>.png or else the
+ * alpha of <mask_dir>/<name>, grown by `margin` pixels
+ */
+MaskedViews load_masked_views(const ColmapModel& model, const std::string& mask_dir, int margin);
+
+/**
+ * true if more than max_misses views prove the whole box lies outside the
+ * mask: every corner in front, the projected rect fully in frame, and no
+ * set pixel in the (1px padded) rect of the 8x8 pooled mask. coarse holds
+ * any_pool8() of each view's mask
+ */
+bool box_outside_masks(
+    const double lo[3],
+    const double hi[3],
+    const MaskedViews& views,
+    const std::vector<BitMask>& coarse,
+    const std::vector<ColmapImage>& images,
+    int max_misses
+);
+
+void register_visual_hull(pybind11::module_& m);
@@ -7,6 +7,12 @@ from aws_utils import (
 )
 from sam2_service import Sam2Service
 
+try:
+    import torque_cpp
+    CPP_AVAILABLE = True
+except ImportError:
+    CPP_AVAILABLE = False
+
 # actual job initialization
 
 def resize_images_to_max_dimension(images_dir: str, max_dimension: int = 1024):
@@ -52,7 +58,77 @@ def resize_images_to_max_dimension(images_dir: str, max_dimension: int = 1024):
     print(f"Resized {resized_count}/{len(image_files)} images to max {max_dimension}px")
     return resized_count
 
-def init_job(job_id: str, bucket: str, fastapi_url: str, token: str):
+def select_sharp_frames(images_dir: str, window: int = 0, dedup_distance: int = -1,
+                        reduce: int = 2, max_clipped: float = 0.25):
+    """
+    Collapse runs of near-identical frames (dhash + phash within dedup_distance bits,
+    -1 = off) to their sharpest frame, then keep the sharpest well-exposed frame in
+    each window of `window` frames (< 2 = off). Both use one scoring decode.
+    Rejected frames are deleted and the rest renumbered to a contiguous %04d
+    sequence, since ffmpeg's image2 demuxer stops at the first gap. Frames the
+    scorer can't decode (e.g. HEIC) are never rejected, and if none decode the
+    directory is left untouched.
+    """
+    if not CPP_AVAILABLE:
+        print("c++ frame scoring not available, keeping all frames")
+        return 0
+    
+    image_files = get_image_files(images_dir)
+    image_paths = [os.path.join(images_dir, f) for f in image_files]
+    
+    scores = torque_cpp.score_frames(image_paths, reduce=reduce)
+    kept = list(range(len(image_files)))
+    
+    # undecodable here doesn't mean unusable downstream, so never delete on it
+    undecodable = [i for i, valid in enumerate(scores["valid"]) if not valid]
+    if len(undecodable) == len(image_files):
+        print("Frame selection: no frame could be decoded for scoring, keeping all frames")
+        return 0
+    
+    if dedup_distance >= 0:
+        kept = torque_cpp.dedup_frames(scores, max_distance=dedup_distance)
+        print(f"Near-duplicate removal: {len(image_files) - len(kept)} frames within {dedup_distance} bits")
+    
+    if window > 1:
+        # select over the survivors only, so windows span distinct views
+        subset = {key: scores[key][kept] for key in
+                  ("sharpness", "clipped_fraction", "mean_luma", "dhash", "phash", "valid")}
+        kept = [kept[i] for i in torque_cpp.select_frames(subset, window=window, max_clipped=max_clipped)]
+    
+    kept = sorted(set(kept).union(undecodable))
+    if undecodable:
+        print(f"Frame selection: keeping {len(undecodable)} frames that could not be decoded for scoring")
+    
+    kept_set = set(kept)
+    for i in range(len(image_files)):
+        if i not in kept_set:
+            os.remove(image_paths[i])
+    
+    # two passes through unique temporary names: a target can be any kept frame's
+    # current name (0000.jpg, gaps, non-numeric names), so renaming directly could overwrite one
+    renames = []
+    for new_index, old_index in enumerate(kept, start=1):
+        ext = os.path.splitext(image_files[old_index])[1]
+        new_path = os.path.join(images_dir, f"{new_index:04d}{ext}")
+        if image_paths[old_index] != new_path:
+            renames.append((image_paths[old_index], new_path))
+    staged = []
+    for i, (old_path, new_path) in enumerate(renames):
+        tmp_path = os.path.join(images_dir, f".renumber-{i}.tmp")
+        os.rename(old_path, tmp_path)
+        staged.append((tmp_path, new_path))
+    for tmp_path, new_path in staged:
+        if os.path.exists(new_path):
+            raise FileExistsError(f"Frame renumbering would overwrite {new_path}")
+        os.rename(tmp_path, new_path)
+    
+    dropped = len(image_files) - len(kept)
+    print(f"Frame selection: kept {len(kept)}/{len(image_files)} frames "
+          f"({scores['processing_time_ms']:.1f} ms scoring)")
+    return dropped
+
+def init_job(job_id: str, bucket: str, fastapi_url: str, token: str, select_window: int = 0,
+             dedup_distance: int = -1):
     paths = JobPaths(job_id)
     paths.ensure_dirs("images", "preview")
     
@@ -67,6 +143,10 @@ def init_job(job_id: str, bucket: str, fastapi_url: str, token: str):
     # Resize images to 1024px max dimension for pipeline optimization
     # resize_images_to_max_dimension(paths.images, max_dimension=1024)  # TEMPORARILY DISABLED
 
+    # drop duplicate / blurred / badly exposed frames before sam2 and colmap see them
+    if select_window > 1 or dedup_distance >= 0:
+        select_sharp_frames(paths.images, window=select_window, dedup_distance=dedup_distance)
+
     # SAM2 needs video, so imgs -> video
     # Auto-detect input format (jpg or png)
     sample_files = [f for f in os.listdir(paths.images) if f.startswith('0001.')]
@@ -125,6 +205,10 @@ def main():
     parser.add_argument("--bucket", default="torque-jobs", help="S3 bucket name")
     parser.add_argument("--fastapi_url", required=True, help="FastAPI Base URL (no trailing slash)")
     parser.add_argument("--fastapi_token", required=True, help="FastAPI Auth Token")  # Fixed argument name
+    parser.add_argument("--select_window", type=int, default=0,
+                        help="Keep the sharpest well-exposed frame per N frames (0 = keep all)")
+    parser.add_argument("--dedup_distance", type=int, default=-1,
+                        help="Drop near-duplicate frames within this many hash bits, e.g. 8 (-1 = off)")
 
     args = parser.parse_args()
     
@@ -132,7 +216,9 @@ def main():
         job_id=args.job_id,
         bucket=args.bucket,
         fastapi_url=args.fastapi_url,
-        token=args.fastapi_token
+        token=args.fastapi_token,
+        select_window=args.select_window,
+        dedup_distance=args.dedup_distance
     )
 
 if __name__ == "__main__":
@@ -4,7 +4,7 @@ run_brush.py
 EC2 worker script to:
 1. Assess correct dirs for RGBA + COLMAP + new outputs.
 2. Run Brush (3D Gaussian Splatting) training with transparent inputs
-2.5 Routinely upload pngs of said object to S3 for preview.
+2.5 Upload small WebP previews of new exports to S3 as they appear.
 3. Generate final 3D model files
 4. Upload trained model to S3
 5. Notify FastAPI of completion
@@ -14,15 +14,49 @@ import os
 import shutil
 import threading
 import time
+import glob
+import boto3
 from aws_utils import (
-    run, patch_status, ensure_dir, s3_upload_dir,
+    run, patch_status, ensure_dir, s3_upload_dir, s3_upload_file,
     JobPaths, print_job_summary
 )
 
+try:
+    import torque_cpp
+    CPP_AVAILABLE = True
+except ImportError:
+    CPP_AVAILABLE = False
+
+
+def brush_sources(paths: JobPaths):
+    """
+    (images dir, sparse model dir) Brush trains on: the undistorted PINHOLE
+    model when run_colmap --undistort produced one, else rgba + sparse/0.
+    colmap/undistorted only exists after an undistortion where every frame
+    succeeded (it is published by rename and removed on failure or when
+    run_colmap runs without --undistort), so the full model is the gate.
+    """
+    sparse_dir = os.path.join(paths.undistorted, "sparse")
+    if all(os.path.isfile(os.path.join(sparse_dir, f)) for f in ("cameras.bin", "images.bin", "points3D.bin")):
+        print(f"Using undistorted PINHOLE model: {paths.undistorted}")
+        return os.path.join(paths.undistorted, "images"), os.path.join(paths.undistorted, "sparse")
+    return paths.rgba, os.path.join(paths.colmap, "sparse", "0")
+
+def brush_masks(paths: JobPaths):
+    """
+    Mask dir matching brush_sources' cameras: the undistorted masks when they
+    line up with the undistorted model, otherwise the rgba alpha is the mask.
+    """
+    images_source, _ = brush_sources(paths)
+    mask_dir = os.path.join(paths.undistorted, "masks")
+    if not os.path.isdir(mask_dir) or images_source == paths.rgba:
+        return images_source
+    return mask_dir
 
 def setup_brush_inputs(paths: JobPaths):
     """
     set up Brush w/ symlinks for /rgba + /colmap/sparse/0
+    (or colmap/undistorted/{images,sparse} when run_colmap --undistort produced them)
     """
     brush_input_dir = os.path.join(paths.workspace, "brush_input")
     brush_images_link = os.path.join(brush_input_dir, "images")
@@ -38,7 +72,8 @@ def setup_brush_inputs(paths: JobPaths):
     if not os.path.exists(paths.rgba):
         raise FileNotFoundError(f"RGBA directory not found: {paths.rgba}")
     
-    colmap_sparse_source = os.path.join(paths.colmap, "sparse", "0")
+    images_source, colmap_sparse_source = brush_sources(paths)
+    
     if not os.path.exists(colmap_sparse_source):
         raise FileNotFoundError(f"COLMAP sparse directory not found: {colmap_sparse_source}")
     
@@ -53,31 +88,29 @@ def setup_brush_inputs(paths: JobPaths):
         os.unlink(brush_sparse_link)
     
     # symlinks
-    os.symlink(paths.rgba, brush_images_link)
+    os.symlink(images_source, brush_images_link)
     os.symlink(colmap_sparse_source, brush_sparse_link)
     
     print("Brush data structure created with symlinks")
     return brush_input_dir
 
-def upload_progress_images(progress_dir: str, bucket: str, job_id: str, stop_event: threading.Event):
+def upload_progress_previews(watcher, bucket: str, job_id: str):
     """
-    Background thread to upload progress images every 5 minutes.
+    Upload each preview the native watcher hands back until it is stopped.
+    watcher.get() blocks with the GIL released, so nothing polls the directory.
     """
-    while not stop_event.is_set():
+    s3 = boto3.client("s3")
+    while True:
+        item = watcher.get()
+        if item is None:
+            break
+        name, data = item
         try:
-            if os.path.exists(progress_dir):
-                # Find latest rendered images
-                image_files = [f for f in os.listdir(progress_dir) if f.lower().endswith(('.png', '.jpg', '.jpeg'))]
-                if image_files:
-                    # Upload latest images to S3 progress folder
-                    s3_progress_prefix = f"s3://{bucket}/{job_id}/progress/"
-                    s3_upload_dir(progress_dir, s3_progress_prefix)
-                    print(f"Uploaded {len(image_files)} progress images to S3")
+            content_type = "image/webp" if name.endswith(".webp") else "image/jpeg"
+            s3.put_object(Bucket=bucket, Key=f"{job_id}/progress/{name}", Body=data, ContentType=content_type)
+            print(f"Uploaded progress preview {name} ({len(data) // 1024} KB)")
         except Exception as e:
             print(f"Progress upload error: {e}")
-        
-        # Wait 5 minutes or until stop signal
-        stop_event.wait(300)  # 300 seconds = 5 minutes
 
 def run_brush_training(brush_data_dir: str, total_steps: str = "10000", bucket: str = None, job_id: str = None):
     """
@@ -91,18 +124,19 @@ def run_brush_training(brush_data_dir: str, total_steps: str = "10000", bucket:
     ensure_dir(export_dir)
     ensure_dir(progress_dir)
     
-    # Start background thread for progress uploads
-    stop_upload = threading.Event()
+    # new exports (and eval frames, if enabled) come back from the native
+    # inotify watcher as small WebP renders and go straight to S3
+    watcher = None
     upload_thread = None
-    # DISABLED UPLOAD THREAD
-    # if bucket and job_id:
-    #     upload_thread = threading.Thread(
-    #         target=upload_progress_images,
-    #         args=(progress_dir, bucket, job_id, stop_upload)
-    #     )
-    #     upload_thread.daemon = True
-    #     upload_thread.start()
-    #     print("Started progress image upload thread")
+    if CPP_AVAILABLE and bucket and job_id:
+        try:
+            watcher = torque_cpp.ProgressWatcher(export_dir, sparse_dir=os.path.join(brush_data_dir, "sparse", "0"))
+            upload_thread = threading.Thread(target=upload_progress_previews, args=(watcher, bucket, job_id))
+            upload_thread.daemon = True
+            upload_thread.start()
+            print("Started progress preview watcher")
+        except Exception as e:
+            print(f"WARNING: Progress previews disabled: {e}")
     
     # Brush training command with correct CLI arguments
     brush_cmd = [
@@ -133,13 +167,12 @@ def run_brush_training(brush_data_dir: str, total_steps: str = "10000", bucket:
         print("Brush training completed successfully")
         
     finally:
-        # Stop progress upload thread
-        # DISABLED - NO UPLOAD THREAD RUNNING
-        # if upload_thread:
-        #     stop_upload.set()
-        #     upload_thread.join(timeout=5)
-        #     print("Stopped progress upload thread")
-        pass
+        # stop() still encodes the events already queued (the final export)
+        if watcher:
+            watcher.stop()
+        if upload_thread:
+            upload_thread.join(timeout=60)
+            print("Stopped progress preview watcher")
     
     # Check for exported PLY files
     ply_files = [f for f in os.listdir(export_dir) if f.endswith('.ply')]
@@ -156,6 +189,108 @@ def run_brush_training(brush_data_dir: str, total_steps: str = "10000", bucket:
 
 
 
+def latest_export(output_dir: str):
+    """
+    Highest-iteration export_{iter}.ply in the Brush output dir, or None.
+    """
+    # skip our own .clean.ply / .sorted.ply / .compressed.ply siblings
+    exports = [p for p in glob.glob(os.path.join(output_dir, "export_*.ply"))
+               if os.path.basename(p)[len("export_"):-len(".ply")].isdigit()]
+    def iteration(path):
+        return int(os.path.basename(path)[len("export_"):-len(".ply")])
+    return max(exports, key=iteration) if exports else None
+
+def report_splat_model(ply_path: str):
+    """
+    Parse the final export natively so a truncated or empty PLY is caught before upload.
+    """
+    if not CPP_AVAILABLE:
+        return
+    try:
+        cloud = torque_cpp.read_splat_ply(ply_path)
+        print(f"Final model {os.path.basename(ply_path)}: {cloud.count} splats, SH degree {cloud.sh_degree}")
+    except Exception as e:
+        print(f"ERROR: Could not parse {ply_path}: {e}")
+
+def remove_floaters(paths: JobPaths, ply_path: str, min_inside_ratio: float):
+    """
+    Write <export>.clean.ply without the Gaussians that fall outside the SAM2
+    masks in most training views. Returns its path, or None if skipped/failed.
+    """
+    if not CPP_AVAILABLE or min_inside_ratio <= 0:
+        return None
+    _, sparse_source = brush_sources(paths)
+    mask_dir = brush_masks(paths)
+    clean_path = os.path.splitext(ply_path)[0] + ".clean.ply"
+    try:
+        result = torque_cpp.remove_splat_floaters(ply_path, sparse_source, mask_dir, clean_path,
+                                                  min_inside_ratio=min_inside_ratio)
+        return clean_path if result["success"] else None
+    except Exception as e:
+        print(f"WARNING: Floater removal failed, keeping the raw export: {e}")
+        return None
+
+def render_thumbnail(paths: JobPaths, ply_path: str, bucket: str, job_id: str):
+    """
+    Render the splat from the first training view and upload it where
+    get_job_preview looks: s3://{bucket}/jobs/{job_id}/results/thumbnail.jpg
+    """
+    if not CPP_AVAILABLE:
+        return None
+    _, sparse_source = brush_sources(paths)
+    thumbnail_path = os.path.join(paths.workspace, "thumbnail.jpg")
+    try:
+        torque_cpp.render_splat_thumbnail(ply_path, sparse_source, thumbnail_path)
+        s3_upload_file(thumbnail_path, f"s3://{bucket}/jobs/{job_id}/results/thumbnail.jpg")
+        return thumbnail_path
+    except Exception as e:
+        print(f"WARNING: Thumbnail rendering failed, the job will have no preview image: {e}")
+        return None
+
+def reorder_splat_model(ply_path: str, output_path: str = ""):
+    """
+    Write the PLY in Morton order to output_path (in place when empty) plus
+    <stem>.chunks.bin bounds for viewer culling. Returns the reordered PLY,
+    or ply_path if the reorder was skipped/failed.
+    """
+    if not CPP_AVAILABLE:
+        return ply_path
+    try:
+        torque_cpp.reorder_splat_ply(ply_path, output_path)
+        return output_path or ply_path
+    except Exception as e:
+        print(f"WARNING: Splat reorder failed, keeping training order: {e}")
+        return ply_path
+
+def compress_splat_model(ply_path: str, compressed_path: str, sh_degree: int = -1, sh_palette_size: int = 0):
+    """
+    Write the compressed web model next to the final export.
+    It lands in the same S3 prefix as the raw PLY, which stays the source of truth.
+    """
+    if not CPP_AVAILABLE:
+        return None
+    try:
+        torque_cpp.compress_splat_ply(ply_path, compressed_path,
+                                      sh_degree=sh_degree, sh_palette_size=sh_palette_size)
+        return compressed_path
+    except Exception as e:
+        print(f"WARNING: Splat compression failed, only the raw PLY will be uploaded: {e}")
+        return None
+
+def build_splat_lod(ply_path: str, lod_dir: str, min_splats: int, sh_degree: int = -1, sh_palette_size: int = 0):
+    """
+    Write the streaming LOD levels (lod_<k>.compressed.ply, coarsest first) and lod.json into lod_dir.
+    """
+    if not CPP_AVAILABLE or min_splats <= 0:
+        return None
+    try:
+        torque_cpp.build_splat_lod(ply_path, lod_dir, min_splats=min_splats,
+                                   sh_degree=sh_degree, sh_palette_size=sh_palette_size)
+        return lod_dir
+    except Exception as e:
+        print(f"WARNING: LOD generation failed, the viewer will load the full model: {e}")
+        return None
+
 def cleanup_intermediate_files(paths: JobPaths, output_dir: str):
     """
     Clean up intermediate symlink directories.
@@ -185,7 +320,17 @@ def main():
     parser.add_argument("--fastapi_url", required=True, help="FastAPI URL")
     parser.add_argument("--fastapi_token", required=True, help="FastAPI auth token")
     parser.add_argument("--steps", default="10000", help="Training steps")
+    parser.add_argument("--dense_init_steps", default="5000",
+                       help="Training steps when run_colmap --dense_resolution densified the init cloud")
     parser.add_argument("--resolution", default="1024", help="Output resolution")
+    parser.add_argument("--floater_min_inside", type=float, default=0.5,
+                       help="Drop Gaussians inside the SAM2 masks in fewer than this fraction of views (0 disables)")
+    parser.add_argument("--lod_min_splats", type=int, default=16384,
+                       help="Splat count the coarsest streaming LOD level gets down to (0 disables LOD)")
+    parser.add_argument("--web_sh_degree", type=int, default=-1,
+                       help="Max SH degree kept in the compressed web model (-1 keeps all)")
+    parser.add_argument("--web_sh_palette", type=int, default=4096,
+                       help="SH palette entries in the compressed web model (0 stores 8-bit SH per splat)")
     
     args = parser.parse_args()
     
@@ -201,12 +346,31 @@ def main():
         brush_data_dir = setup_brush_inputs(paths)
         
         # Step 2: run brush training
-        output_dir = run_brush_training(brush_data_dir, args.steps, args.bucket, args.job_id)
+        # a carved surface init converges in fewer steps than the thin sparse cloud
+        steps = args.steps
+        if os.path.exists(paths.dense_init):
+            steps = args.dense_init_steps
+            print(f"Dense init cloud found, training for {steps} steps")
+        output_dir = run_brush_training(brush_data_dir, steps, args.bucket, args.job_id)
         
         # Step 3: clean up + finalize out
         final_model_dir = cleanup_intermediate_files(paths, output_dir)
         
         if final_model_dir:
+            ply_path = latest_export(final_model_dir)
+            if ply_path:
+                report_splat_model(ply_path)
+                # the web model is built from the cleaned splat when floater removal ran
+                web_source = remove_floaters(paths, ply_path, args.floater_min_inside) or ply_path
+                render_thumbnail(paths, web_source, args.bucket, args.job_id)
+                # our .clean.ply can be sorted in place, the raw export stays the source of truth
+                web_source = reorder_splat_model(web_source, "" if web_source != ply_path
+                                                 else os.path.splitext(ply_path)[0] + ".sorted.ply")
+                compress_splat_model(web_source, os.path.splitext(ply_path)[0] + ".compressed.ply",
+                                     args.web_sh_degree, args.web_sh_palette)
+                build_splat_lod(web_source, os.path.join(final_model_dir, "lod"), args.lod_min_splats,
+                                args.web_sh_degree, args.web_sh_palette)
+            
             # Step 4: upload final model to S3
             print("Uploading final 3D model to S3...")
             s3_model_prefix = f"s3://{args.bucket}/{args.job_id}/gaussian_splat/"
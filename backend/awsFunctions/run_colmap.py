@@ -9,13 +9,135 @@ EC2 worker script to:
 5. Notify FastAPI of completion
 """
 import argparse
+import json
 import os
+import shutil
+import sqlite3
 from aws_utils import (
     run, patch_status, ensure_dir, get_image_files,
     JobPaths, print_job_summary
 )
 
-def run_colmap_pipeline(paths: JobPaths, matching_type: str = "Sequential"):
+try:
+    import torque_cpp
+    CPP_AVAILABLE = True
+except ImportError:
+    CPP_AVAILABLE = False
+
+def native_features_ready(db_path: str, num_images: int) -> bool:
+    """
+    True if the rgba batch already wrote keypoints for every image into database.db.
+    """
+    if not os.path.exists(db_path):
+        return False
+    try:
+        with sqlite3.connect(db_path) as conn:
+            num_keypoints = conn.execute("SELECT COUNT(*) FROM keypoints").fetchone()[0]
+            num_descriptors = conn.execute("SELECT COUNT(*) FROM descriptors").fetchone()[0]
+        return num_keypoints == num_images and num_descriptors == num_images
+    except sqlite3.Error as e:
+        print(f"Ignoring unreadable database {db_path}: {e}")
+        return False
+
+def undistort_model(paths: JobPaths) -> bool:
+    """
+    Undistort the RGBA frames (and COLMAP masks) of sparse/0 to a PINHOLE model in
+    colmap/undistorted/{images,masks,sparse}. Native only: colmap image_undistorter
+    would drop the alpha channel Brush trains on, so without torque_cpp Brush keeps
+    using the distorted frames.
+    """
+    # undistort_images only leaves colmap/undistorted behind on full success,
+    # which is what brush_sources keys on
+    if not CPP_AVAILABLE:
+        print("c++ undistortion not available, Brush will use the distorted frames")
+        return False
+    
+    sparse_dir = os.path.join(paths.colmap, "sparse", "0")
+    mask_dir = paths.colmap_masks if os.path.isdir(paths.colmap_masks) else ""
+    try:
+        results = torque_cpp.undistort_images(sparse_dir, paths.rgba, paths.undistorted, mask_dir)
+    except Exception as e:
+        print(f"ERROR: Undistortion failed: {e}")
+        remove_undistorted(paths)
+        return False
+    if not results['complete']:
+        print(f"ERROR: Undistortion failed for {results['errors']} images")
+        return False
+    return True
+
+def remove_undistorted(paths: JobPaths):
+    """
+    Drop colmap/undistorted (and a leftover staging dir) so Brush can't pick up
+    a model from an earlier run that no longer matches sparse/0.
+    """
+    for path in (paths.undistorted, paths.undistorted + ".partial"):
+        if os.path.isdir(path):
+            shutil.rmtree(path, ignore_errors=True)
+
+def report_model_quality(sparse_dir: str, num_input_images: int):
+    """
+    Print registration / reprojection stats for a sparse model. Informational only,
+    a weak model still goes to Brush.
+    """
+    if not CPP_AVAILABLE:
+        return
+    try:
+        stats = torque_cpp.ColmapModel.read(sparse_dir).stats(num_input_images)
+    except Exception as e:
+        print(f"Could not read sparse model for stats: {e}")
+        return
+
+    print(f"Registered {stats['num_images']}/{num_input_images} images ({stats['registered_ratio']:.0%}), "
+          f"{stats['num_points']} points")
+    print(f"Mean reprojection error: {stats['mean_reprojection_error']:.3f} px, "
+          f"mean track length: {stats['mean_track_length']:.2f}")
+    if stats['registered_ratio'] < 0.5:
+        print("WARNING: Less than half of the frames registered, check the capture")
+
+def carve_sparse_points(paths: JobPaths, min_views: int) -> bool:
+    """
+    Drop sparse/0 points that don't land inside the SAM2 mask in at least min_views
+    registered frames, in place, so Brush initializes from the object alone. Uses the
+    COLMAP masks when they were written, else the alpha of the RGBA frames.
+    """
+    if not CPP_AVAILABLE:
+        print("c++ visual hull not available, keeping all sparse points")
+        return False
+    
+    sparse_dir = os.path.join(paths.colmap, "sparse", "0")
+    mask_dir = paths.colmap_masks if os.path.isdir(paths.colmap_masks) else paths.rgba
+    try:
+        results = torque_cpp.carve_visual_hull(sparse_dir, mask_dir, min_views=min_views)
+    except Exception as e:
+        print(f"ERROR: Visual hull carving failed, keeping all sparse points: {e}")
+        return False
+    return results['success']
+
+def densify_sparse_points(paths: JobPaths, resolution: int) -> bool:
+    """
+    Voxel-carve the masks with the COLMAP poses and append coloured surface points to
+    sparse/0/points3D.bin. Writes paths.dense_init so run_brush can train for fewer steps.
+    """
+    if not CPP_AVAILABLE:
+        print("c++ dense carving not available, Brush initializes from the sparse points")
+        return False
+    
+    sparse_dir = os.path.join(paths.colmap, "sparse", "0")
+    mask_dir = paths.colmap_masks if os.path.isdir(paths.colmap_masks) else paths.rgba
+    try:
+        results = torque_cpp.carve_dense_points(sparse_dir, mask_dir, paths.rgba, resolution=resolution)
+    except Exception as e:
+        print(f"ERROR: Dense carving failed: {e}")
+        return False
+    if not results['success']:
+        return False
+    
+    with open(paths.dense_init, "w") as f:
+        json.dump({k: results[k] for k in ("points_added", "surface_voxels", "voxel_size")}, f)
+    return True
+
+def run_colmap_pipeline(paths: JobPaths, matching_type: str = "Sequential", undistort: bool = False,
+                        carve_min_views: int = 0, dense_resolution: int = 0):
     """
     Runs COLMAP pipeline on RGBA images.
     """
@@ -24,9 +146,12 @@ def run_colmap_pipeline(paths: JobPaths, matching_type: str = "Sequential"):
     
     db_path = os.path.join(paths.colmap, "database.db")
     sparse_path = os.path.join(paths.colmap, "sparse")
+    match_list_path = os.path.join(paths.colmap, "match_list.txt")
     
     # Create sparse directory
     ensure_dir(sparse_path)
+    # sparse/0 is about to be rebuilt; only this run's undistortion may follow it
+    remove_undistorted(paths)
     
     print(f"Running COLMAP pipeline")
     print(f"RGBA images: {paths.rgba}")
@@ -45,14 +170,33 @@ def run_colmap_pipeline(paths: JobPaths, matching_type: str = "Sequential"):
         print(f"ERROR: Need at least 3 images, found {len(rgba_files)}")
         return False
     
+    # binary masks from the rgba batch keep keypoints off the background
+    mask_args = ""
+    if os.path.isdir(paths.colmap_masks) and os.listdir(paths.colmap_masks):
+        print(f"Using COLMAP masks: {paths.colmap_masks}")
+        mask_args = f" --ImageReader.mask_path {paths.colmap_masks}"
+    
     # COLMAP pipeline
-    commands = [
-        ("Creating database", f"colmap database_creator --database_path {db_path}"),
-        ("Extracting features", f"colmap feature_extractor --database_path {db_path} --image_path {paths.rgba}"),
+    if native_features_ready(db_path, len(rgba_files)):
+        # features were extracted by torque_cpp while compositing rgba
+        print(f"Using native SIFT features from {db_path}")
+        commands = []
+    else:
+        commands = [
+            ("Creating database", f"colmap database_creator --database_path {db_path}"),
+            ("Extracting features", f"colmap feature_extractor --database_path {db_path} --image_path {paths.rgba}{mask_args}"),
+        ]
+    # retrieval pairs come from the rgba batch (k-nn over global descriptors)
+    if matching_type == "Retrieval" and not os.path.exists(match_list_path):
+        print(f"No match list at {match_list_path}, falling back to sequential matching")
+        matching_type = "Sequential"
+    
+    commands += [
         (f"Running {matching_type} matching", {
             "Exhaustive": f"colmap exhaustive_matcher --database_path {db_path}",
             "Sequential": f"colmap sequential_matcher --database_path {db_path}",
-            "Spatial": f"colmap spatial_matcher --database_path {db_path}"
+            "Spatial": f"colmap spatial_matcher --database_path {db_path}",
+            "Retrieval": f"colmap matches_importer --database_path {db_path} --match_list_path {match_list_path} --match_type pairs"
         }.get(matching_type, f"colmap sequential_matcher --database_path {db_path}")),
         ("Sparse reconstruction", f"colmap mapper --database_path {db_path} --image_path {paths.rgba} --output_path {sparse_path}")
     ]
@@ -78,6 +222,19 @@ def run_colmap_pipeline(paths: JobPaths, matching_type: str = "Sequential"):
     
     print("SUCCESS: COLMAP completed successfully!")
     print(f"Results: {result_dir}")
+    report_model_quality(result_dir, len(rgba_files))
+    
+    # best effort: an uncarved model still trains, just with more floaters early on
+    if carve_min_views > 0:
+        carve_sparse_points(paths, carve_min_views)
+    if os.path.exists(paths.dense_init):
+        os.remove(paths.dense_init)
+    if dense_resolution > 0:
+        densify_sparse_points(paths, dense_resolution)
+    
+    # best effort: brush falls back to the distorted frames if this fails
+    if undistort and undistort_model(paths):
+        print(f"Undistorted model: {paths.undistorted}")
     return True
 
 def main():
@@ -87,8 +244,14 @@ def main():
     parser.add_argument("--fastapi_url", required=True, help="FastAPI URL")
     parser.add_argument("--fastapi_token", required=True, help="FastAPI auth token")
     parser.add_argument("--matching_type", default="Sequential", 
-                       choices=["Sequential", "Exhaustive", "Spatial"],
+                       choices=["Sequential", "Exhaustive", "Spatial", "Retrieval"],
                        help="COLMAP feature matching type")
+    parser.add_argument("--undistort", action="store_true",
+                       help="Undistort frames to a PINHOLE model for Brush (colmap/undistorted)")
+    parser.add_argument("--carve_min_views", type=int, default=0,
+                       help="Keep only sparse points inside the object mask in at least this many views (0 = off)")
+    parser.add_argument("--dense_resolution", type=int, default=0,
+                       help="Add voxel-carved surface points at this grid resolution for Brush init (0 = off)")
     
     args = parser.parse_args()
     
@@ -99,7 +262,8 @@ def main():
                      colmap_dir=paths.colmap)
     
     # Run COLMAP pipeline
-    success = run_colmap_pipeline(paths, args.matching_type)
+    success = run_colmap_pipeline(paths, args.matching_type, args.undistort,
+                                  args.carve_min_views, args.dense_resolution)
     
     if success:
         patch_status(args.fastapi_url, args.fastapi_token, args.job_id, "colmap_done")
@@ -23,6 +23,20 @@ def main():
     parser.add_argument("--bucket", required=True, help="S3 bucket name")
     parser.add_argument("--fastapi_url", required=True, help="FastAPI URL")
     parser.add_argument("--fastapi_token", required=True, help="FastAPI auth token")
+    parser.add_argument("--feather_radius", type=int, default=0,
+                        help="Soft alpha band around the mask edge in pixels (0 = hard alpha)")
+    parser.add_argument("--background", default="keep", choices=["keep", "zero", "bleed"],
+                        help="RGB stored under transparent pixels (zero/bleed shrink PNGs and hide background from COLMAP)")
+    parser.add_argument("--crop", action="store_true",
+                        help="Write only the padded mask bounding box of each frame (offsets in rgba_crops.json)")
+    parser.add_argument("--crop_snap", action="store_true",
+                        help="Use one crop size for the whole sequence")
+    parser.add_argument("--native_features", action="store_true",
+                        help="Extract masked SIFT into colmap/database.db during RGBA compositing")
+    parser.add_argument("--retrieval_pairs", action="store_true",
+                        help="Write colmap/match_list.txt from global-descriptor k-NN (use with --matching_type Retrieval)")
+    parser.add_argument("--photometric_normalize", action="store_true",
+                        help="Correct exposure / white-balance drift across frames before writing RGBA")
     
     args = parser.parse_args()
 
@@ -64,6 +78,14 @@ def main():
         upload_to_s3=True,
         s3_bucket=bucket,
         s3_prefix=f"{job_id}/rgba",
+        feather_radius=args.feather_radius,
+        background=args.background,
+        crop=args.crop,
+        crop_snap=args.crop_snap,
+        colmap_mask_dir=paths.colmap_masks,
+        feature_db_path=os.path.join(paths.colmap, "database.db") if args.native_features else None,
+        match_list_path=os.path.join(paths.colmap, "match_list.txt") if args.retrieval_pairs else None,
+        photometric_normalize=args.photometric_normalize,
     )
     
     print(f"RGBA processing complete: {results['processed']} images, {results['uploaded']} uploaded")
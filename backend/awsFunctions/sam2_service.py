@@ -1,4 +1,5 @@
 import os
+import json
 import cv2
 import numpy as np
 import boto3
@@ -17,6 +18,34 @@ except ImportError as e:
     CPP_AVAILABLE = False
     print(f"c++ optimization not available, using python fallback: {e}")
 
+def file_identity(path: str):
+    """
+    (size, mtime_ns) of a file, or None: what an upload ledger entry is checked against.
+    """
+    try:
+        st = os.stat(path)
+    except OSError:
+        return None
+    return [st.st_size, st.st_mtime_ns]
+
+def load_upload_ledger(path: str) -> dict:
+    """
+    output path -> {"s3_uri", "identity"} for every upload S3 confirmed; missing or
+    unreadable means nothing is known to be uploaded.
+    """
+    try:
+        with open(path) as f:
+            ledger = json.load(f)
+        return ledger if isinstance(ledger, dict) else {}
+    except (OSError, ValueError):
+        return {}
+
+def save_upload_ledger(path: str, ledger: dict):
+    tmp_path = path + ".tmp"
+    with open(tmp_path, "w") as f:
+        json.dump(ledger, f)
+    os.replace(tmp_path, path)
+
 class Sam2Service:
     
     def __init__(self):
@@ -209,11 +238,42 @@ class Sam2Service:
         
         return output_path
     
-    def batch_create_rgba_masks_optimized(self, job_id: str, upload_to_s3: bool = True, s3_bucket: str = None, s3_prefix: str = None):
+    def upload_with_checksum(self, local_path: str, bucket: str, key: str, crc32c: str = None):
+        """
+        Upload with the CRC32C (base64) computed when the file was encoded: S3 checks
+        the body against it and rejects a corrupted or truncated upload (BadDigest)
+        instead of storing it, and the object keeps the checksum for later checks.
+        Without a checksum this is a plain upload_file.
+        """
+        if not crc32c:
+            self.s3.upload_file(local_path, bucket, key)
+            return
+        with open(local_path, "rb") as body:
+            self.s3.put_object(Bucket=bucket, Key=key, Body=body, ChecksumCRC32C=crc32c)
+    
+    def batch_create_rgba_masks_optimized(self, job_id: str, upload_to_s3: bool = True, s3_bucket: str = None, s3_prefix: str = None,
+                                          feather_radius: int = 0, background: str = "keep",
+                                          crop: bool = False, crop_snap: bool = False,
+                                          colmap_mask_dir: str = None, feature_db_path: str = None,
+                                          match_list_path: str = None, photometric_normalize: bool = False):
         """
         high-performance batch rgba processing using c++ optimization when available.
         falls back to python implementation if c++ module not compiled.
         
+        feather_radius > 0 writes a graded alpha band around the silhouette, and
+        background ("keep", "zero", "bleed") controls the rgb stored under alpha == 0.
+        crop writes only the padded mask bbox per frame (crop_snap = one size for the
+        whole sequence) and records offsets in rgba_crops.json for intrinsics fix-ups.
+        colmap_mask_dir gets one <image>.png binary mask per frame for colmap's
+        --ImageReader.mask_path, written from the already-loaded masks.
+        feature_db_path gets a colmap database.db with masked sift extracted from the
+        decoded frames, so run_colmap can skip feature_extractor.
+        match_list_path gets a colmap match list from global-descriptor k-nn over all
+        frames (sequential neighbours + loop closures) for matches_importer.
+        photometric_normalize matches every frame's masked colour stats to the sequence
+        (smoothed per-frame gain/offset) before encoding; frames are held in memory.
+        all of these are c++ only, the python fallback always writes full hard-alpha frames.
+        
         returns same format as original batch_create_rgba_masks for compatibility.
         """
         
@@ -264,22 +324,64 @@ class Sam2Service:
         output_paths = [os.path.join(output_dir, f"{os.path.splitext(img_file)[0]}.png") 
                        for img_file in image_files]
         
+        # native compose options
+        options = torque_cpp.RGBAOptions()
+        options.feather_radius = feather_radius
+        options.background = background
+        options.crop = crop
+        options.crop_snap = crop_snap
+        if crop:
+            options.crop_json_path = os.path.expanduser(f"~/torque/jobs/{job_id}/rgba_crops.json")
+        if colmap_mask_dir:
+            os.makedirs(colmap_mask_dir, exist_ok=True)
+            options.mask_dir = colmap_mask_dir
+        if feature_db_path:
+            os.makedirs(os.path.dirname(feature_db_path), exist_ok=True)
+            options.feature_db_path = feature_db_path
+        if match_list_path:
+            os.makedirs(os.path.dirname(match_list_path), exist_ok=True)
+            options.match_list_path = match_list_path
+        options.photometric_normalize = photometric_normalize
+        # reruns after a mask refinement only recompose the frames whose image or mask changed
+        options.cache_manifest_path = os.path.expanduser(f"~/torque/jobs/{job_id}/rgba_manifest.txt")
+        # crc32c of each png from the encode buffer, s3 verifies the upload against it
+        options.checksum_crc32c = upload_to_s3
+        
         try:
             # call c++ optimized batch processing
-            cpp_results = torque_cpp.batch_rgba(image_paths, video_masks, output_paths)
+            cpp_results = torque_cpp.batch_rgba(image_paths, video_masks, output_paths, options)
             
             # handle s3 uploads (same as original python method)
             uploaded_count = 0
             if upload_to_s3:
+                # a reused frame is skipped only if an earlier run's upload of this
+                # exact file to this key was confirmed; failed uploads are retried
+                ledger_path = os.path.expanduser(f"~/torque/jobs/{job_id}/rgba_uploads.json")
+                ledger = load_upload_ledger(ledger_path)
+                reused_files = set(cpp_results.get('reused_files', []))
+                checksums = cpp_results.get('checksums', {})
                 for output_file in cpp_results['output_files']:
+                    filename = os.path.basename(output_file)
+                    s3_key = f"{s3_prefix}/{filename}" if s3_prefix else filename
+                    s3_uri = f"s3://{s3_bucket}/{s3_key}"
+                    identity = file_identity(output_file)
+                    entry = ledger.get(output_file)
+                    if (output_file in reused_files and entry and identity
+                            and entry.get('s3_uri') == s3_uri and entry.get('identity') == identity):
+                        continue
+                    ledger.pop(output_file, None)
                     try:
-                        filename = os.path.basename(output_file)
-                        s3_key = f"{s3_prefix}/{filename}" if s3_prefix else filename
-                        self.s3.upload_file(output_file, s3_bucket, s3_key)
+                        self.upload_with_checksum(output_file, s3_bucket, s3_key,
+                                                  checksums.get(output_file, {}).get('crc32c'))
+                        ledger[output_file] = {'s3_uri': s3_uri, 'identity': identity}
                         uploaded_count += 1
-                        print(f"uploaded: s3://{s3_bucket}/{s3_key}")
+                        print(f"uploaded: {s3_uri}")
                     except Exception as e:
                         print(f"s3 upload failed for {filename}: {e}")
+                try:
+                    save_upload_ledger(ledger_path, ledger)
+                except OSError as e:
+                    print(f"WARNING: could not save upload ledger, reused frames will upload again: {e}")
             
             # format results to match original python method
             results = {
@@ -287,15 +389,29 @@ class Sam2Service:
                 'errors': cpp_results['errors'], 
                 'uploaded': uploaded_count,
                 'output_files': cpp_results['output_files'],
+                'reused': cpp_results.get('reused', 0),
                 # additional c++ performance metrics
                 'processing_time_ms': cpp_results.get('processing_time_ms', 0),
                 'throughput_mpix_per_sec': cpp_results.get('throughput_mpix_per_sec', 0),
                 'optimization_used': 'cpp'
             }
+            if colmap_mask_dir:
+                results['mask_files'] = cpp_results['mask_files']
+            if feature_db_path:
+                results['feature_images'] = cpp_results['feature_images']
+                results['feature_count'] = cpp_results['feature_count']
+            if match_list_path:
+                results['num_pairs'] = cpp_results['num_pairs']
+            if photometric_normalize:
+                results['photometric_gains'] = cpp_results['photometric_gains'].tolist()
+            if crop:
+                results['crops'] = cpp_results['crops']
+                results['crop_json'] = cpp_results.get('crop_json')
             
             print(f"c++ batch processing complete:")
             print(f"   processed: {results['processed']}/{len(image_files)}")
             print(f"   errors: {results['errors']}")
+            print(f"   reused: {results['reused']}")
             print(f"   uploaded: {results['uploaded']}")
             print(f"   time: {results['processing_time_ms']:.1f}ms")
             print(f"   throughput: {results['throughput_mpix_per_sec']:.1f} mpix/s")
@@ -210,7 +210,9 @@ class SmartWorker:
             
             # step 6: cleanup_job
             print(f"step 6/6: cleanup_job for {job_id}")
-            if not self._run_pipeline_step("cleanup_job", job_id):
+            mesh_format = (job.get('processing_options') or {}).get('mesh_format')
+            cleanup_args = ['--mesh_format', mesh_format] if mesh_format in ("glb", "obj") else []
+            if not self._run_pipeline_step("cleanup_job", job_id, extra_args=cleanup_args):
                 print("warning: cleanup_job failed, but job completed")
             
             # mark job as completed
@@ -241,7 +243,7 @@ class SmartWorker:
             # don't acknowledge - let job retry or go to dlq
             return False
     
-    def _run_pipeline_step(self, step_name: str, job_id: str, video_url: str = None) -> bool:
+    def _run_pipeline_step(self, step_name: str, job_id: str, video_url: str = None, extra_args: list = None) -> bool:
         """run a specific pipeline step script"""
         try:
             # construct command based on step
@@ -282,10 +284,13 @@ class SmartWorker:
                 cmd = [
                     'python3', 'cleanup_job.py',
                     '--job_id', job_id,
-                    '--bucket', self.bucket
+                    '--bucket', self.bucket,
+                    '--fastapi_url', self.fastapi_url,
+                    '--fastapi_token', self.fastapi_token
                 ]
             else:
                 raise ValueError(f"unknown pipeline step: {step_name}")
+            cmd += extra_args or []
             
             # run the command
             print(f"running: {' '.join(cmd)}")